@@ -0,0 +1,252 @@
+/*
+ CircularBuffer.h - Circular buffer library for Arduino.
+ Copyright (c) 2017 Roberto Lo Giacco.
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as 
+ published by the Free Software Foundation, either version 3 of the 
+ License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+ Project fork of CircularBuffer 1.3.3: index based storage with mask indexing
+ for power of two capacities, two-segment span views, STL compatible iterators
+ and bulk push_n/pop_n/shift_n operations.
+ */
+#ifndef CIRCULAR_BUFFER_H_
+#define CIRCULAR_BUFFER_H_
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <iterator>
+
+#ifdef CIRCULAR_BUFFER_DEBUG
+#include <Print.h>
+#endif
+
+namespace Helper {
+	template<bool FITS8, bool FITS16> struct Index {
+		using Type = uint32_t;
+	};
+
+	template<> struct Index<false, true> {
+		using Type = uint16_t;
+	};
+
+	template<> struct Index<true, true> {
+		using Type = uint8_t;
+	};
+}
+
+template<typename T, size_t S, typename IT = typename Helper::Index<(S <= UINT8_MAX), (S <= UINT16_MAX)>::Type> class CircularBuffer {
+public:
+	/**
+	 * The buffer capacity: read only as it cannot ever change.
+	 */
+	static constexpr IT capacity = static_cast<IT>(S);
+
+	/**
+	 * Aliases the index type, can be used to obtain the right index type with `decltype(buffer)::index_t`.
+	 */
+	using index_t = IT;
+
+	/**
+	 * A contiguous run of stored elements: the buffer content is always made of at most two of them.
+	 */
+	template<typename P> struct Segment {
+		P *data;
+		IT size;
+	};
+	using span = Segment<T>;
+	using const_span = Segment<const T>;
+
+	/**
+	 * Random access iterator over the stored elements, from the beginning to the end of the buffer.
+	 */
+	template<typename B, typename R> class Iterator {
+	public:
+		using iterator_category = std::random_access_iterator_tag;
+		using value_type = T;
+		using difference_type = ptrdiff_t;
+		using pointer = R*;
+		using reference = R&;
+
+		Iterator() : owner(nullptr), index(0) {}
+		Iterator(B *owner, size_t index) : owner(owner), index(index) {}
+
+		reference operator*() const { return owner->at(index); }
+		pointer operator->() const { return &owner->at(index); }
+		reference operator[](difference_type n) const { return owner->at(index + n); }
+
+		Iterator& operator++() { ++index; return *this; }
+		Iterator operator++(int) { Iterator it = *this; ++index; return it; }
+		Iterator& operator--() { --index; return *this; }
+		Iterator operator--(int) { Iterator it = *this; --index; return it; }
+		Iterator& operator+=(difference_type n) { index += n; return *this; }
+		Iterator& operator-=(difference_type n) { index -= n; return *this; }
+		Iterator operator+(difference_type n) const { return Iterator(owner, index + n); }
+		Iterator operator-(difference_type n) const { return Iterator(owner, index - n); }
+		friend Iterator operator+(difference_type n, const Iterator &it) { return it + n; }
+		difference_type operator-(const Iterator &other) const { return static_cast<difference_type>(index) - static_cast<difference_type>(other.index); }
+
+		bool operator==(const Iterator &other) const { return index == other.index; }
+		bool operator!=(const Iterator &other) const { return index != other.index; }
+		bool operator<(const Iterator &other) const { return index < other.index; }
+		bool operator>(const Iterator &other) const { return index > other.index; }
+		bool operator<=(const Iterator &other) const { return index <= other.index; }
+		bool operator>=(const Iterator &other) const { return index >= other.index; }
+
+	private:
+		B *owner;
+		size_t index;
+	};
+	using iterator = Iterator<CircularBuffer, T>;
+	using const_iterator = Iterator<const CircularBuffer, const T>;
+
+	constexpr CircularBuffer();
+
+	/**
+	 * Disables copy constructor
+	 */
+	CircularBuffer(const CircularBuffer&) = delete;
+	CircularBuffer(CircularBuffer&&) = delete;
+
+	/**
+	 * Disables assignment operator
+	 */
+	CircularBuffer& operator=(const CircularBuffer&) = delete;
+	CircularBuffer& operator=(CircularBuffer&&) = delete;
+
+	/**
+	 * Adds an element to the beginning of buffer: the operation returns `false` if the addition caused overwriting an existing element.
+	 */
+	bool unshift(T value);
+
+	/**
+	 * Adds an element to the end of buffer: the operation returns `false` if the addition caused overwriting an existing element.
+	 */
+	bool push(T value);
+
+	/**
+	 * Adds `n` elements to the end of buffer with at most two `memcpy` calls, `T` must be trivially copyable.
+	 * The operation returns `false` if the addition caused overwriting existing elements.
+	 */
+	bool push_n(const T *values, size_t n);
+
+	/**
+	 * Removes an element from the beginning of the buffer.
+	 * *WARNING* Calling this operation on an empty buffer has an unpredictable behaviour.
+	 */
+	T shift();
+
+	/**
+	 * Removes an element from the end of the buffer.
+	 * *WARNING* Calling this operation on an empty buffer has an unpredictable behaviour.
+	 */
+	T pop();
+
+	/**
+	 * Removes up to `n` elements from the beginning of the buffer copying them, in order, to `dest` with at most two `memcpy` calls.
+	 * Returns the number of removed elements.
+	 */
+	IT shift_n(T *dest, size_t n);
+
+	/**
+	 * Removes up to `n` elements from the end of the buffer copying them, in buffer order, to `dest` with at most two `memcpy` calls.
+	 * Returns the number of removed elements.
+	 */
+	IT pop_n(T *dest, size_t n);
+
+	/**
+	 * Returns the element at the beginning of the buffer.
+	 */
+	T inline first() const;
+
+	/**
+	 * Returns the element at the end of the buffer.
+	 */
+	T inline last() const;
+
+	/**
+	 * Array-like access to buffer.
+	 * Calling this operation using and index value greater than `size - 1` returns the tail element.
+	 * *WARNING* Calling this operation on an empty buffer has an unpredictable behaviour.
+	 */
+	T operator [] (IT index) const;
+
+	/**
+	 * Unchecked access by reference, without copying the element.
+	 */
+	T inline &at(size_t index);
+	const T inline &at(size_t index) const;
+
+	/**
+	 * Zero-copy views: the elements from the beginning of the buffer up to the end of the storage,
+	 * followed by the wrapped around remainder (possibly empty).
+	 */
+	span inline firstSpan();
+	span inline secondSpan();
+	const_span inline firstSpan() const;
+	const_span inline secondSpan() const;
+
+	iterator inline begin();
+	iterator inline end();
+	const_iterator inline begin() const;
+	const_iterator inline end() const;
+
+	/**
+	 * Returns how many elements are actually stored in the buffer.
+	 */
+	IT inline size() const;
+
+	/**
+	 * Returns how many elements can be safely pushed into the buffer.
+	 */
+	IT inline available() const;
+
+	/**
+	 * Returns `true` if no elements can be removed from the buffer.
+	 */
+	bool inline isEmpty() const;
+
+	/**
+	 * Returns `true` if no elements can be added to the buffer without overwriting existing elements.
+	 */
+	bool inline isFull() const;
+
+	/**
+	 * Resets the buffer to a clean status, making all buffer positions available.
+	 */
+	void inline clear();
+
+	#ifdef CIRCULAR_BUFFER_DEBUG
+	void inline debug(Print* out);
+	void inline debugFn(Print* out, void (*printFunction)(Print*, T));
+	#endif
+
+private:
+	/**
+	 * Maps a position relative to the storage start, power of two capacities use a mask instead of a modulo.
+	 */
+	static inline size_t wrap(size_t index) {
+		return ((S & (S - 1)) == 0) ? (index & (S - 1)) : (index % S);
+	}
+
+	T buffer[S];
+	IT head;
+#ifndef CIRCULAR_BUFFER_INT_SAFE
+	IT count;
+#else
+	volatile IT count;
+#endif
+};
+
+#include <CircularBuffer.tpp>
+#endif
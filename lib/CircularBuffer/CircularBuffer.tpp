@@ -0,0 +1,235 @@
+/*
+ CircularBuffer.tpp - Circular buffer library for Arduino.
+ Copyright (c) 2017 Roberto Lo Giacco.
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as 
+ published by the Free Software Foundation, either version 3 of the 
+ License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+template<typename T, size_t S, typename IT>
+constexpr CircularBuffer<T,S,IT>::CircularBuffer() :
+		head(0), count(0) {
+}
+
+template<typename T, size_t S, typename IT>
+bool CircularBuffer<T,S,IT>::unshift(T value) {
+	head = static_cast<IT>(wrap(head + capacity - 1));
+	buffer[head] = value;
+	if (count == capacity) {
+		return false;
+	} else {
+		count++;
+		return true;
+	}
+}
+
+template<typename T, size_t S, typename IT>
+bool CircularBuffer<T,S,IT>::push(T value) {
+	buffer[wrap(head + count)] = value;
+	if (count == capacity) {
+		head = static_cast<IT>(wrap(head + 1));
+		return false;
+	} else {
+		count++;
+		return true;
+	}
+}
+
+template<typename T, size_t S, typename IT>
+bool CircularBuffer<T,S,IT>::push_n(const T *values, size_t n) {
+	bool overwritten = (n > available());
+	if (n > capacity) {
+		values += n - capacity;
+		n = capacity;
+	}
+	size_t start = wrap(head + count);
+	size_t first = (n < S - start) ? n : S - start;
+	memcpy(buffer + start, values, first * sizeof(T));
+	memcpy(buffer, values + first, (n - first) * sizeof(T));
+	if (overwritten) {
+		head = static_cast<IT>(wrap(head + count + n - capacity));
+		count = capacity;
+	} else {
+		count += n;
+	}
+	return !overwritten;
+}
+
+template<typename T, size_t S, typename IT>
+T CircularBuffer<T,S,IT>::shift() {
+	if (count == 0) return buffer[head];
+	T result = buffer[head];
+	head = static_cast<IT>(wrap(head + 1));
+	count--;
+	return result;
+}
+
+template<typename T, size_t S, typename IT>
+T CircularBuffer<T,S,IT>::pop() {
+	if (count == 0) return buffer[head];
+	count--;
+	return buffer[wrap(head + count)];
+}
+
+template<typename T, size_t S, typename IT>
+IT CircularBuffer<T,S,IT>::shift_n(T *dest, size_t n) {
+	if (n > count) n = count;
+	size_t first = (n < S - head) ? n : S - head;
+	memcpy(dest, buffer + head, first * sizeof(T));
+	memcpy(dest + first, buffer, (n - first) * sizeof(T));
+	head = static_cast<IT>(wrap(head + n));
+	count -= n;
+	return static_cast<IT>(n);
+}
+
+template<typename T, size_t S, typename IT>
+IT CircularBuffer<T,S,IT>::pop_n(T *dest, size_t n) {
+	if (n > count) n = count;
+	size_t start = wrap(head + count - n);
+	size_t first = (n < S - start) ? n : S - start;
+	memcpy(dest, buffer + start, first * sizeof(T));
+	memcpy(dest + first, buffer, (n - first) * sizeof(T));
+	count -= n;
+	return static_cast<IT>(n);
+}
+
+template<typename T, size_t S, typename IT>
+T inline CircularBuffer<T,S,IT>::first() const {
+	return buffer[head];
+}
+
+template<typename T, size_t S, typename IT>
+T inline CircularBuffer<T,S,IT>::last() const {
+	return buffer[wrap(head + count + capacity - 1)];
+}
+
+template<typename T, size_t S, typename IT>
+T CircularBuffer<T,S,IT>::operator [](IT index) const {
+	if (index >= count) return last();
+	return buffer[wrap(head + index)];
+}
+
+template<typename T, size_t S, typename IT>
+T inline &CircularBuffer<T,S,IT>::at(size_t index) {
+	return buffer[wrap(head + index)];
+}
+
+template<typename T, size_t S, typename IT>
+const T inline &CircularBuffer<T,S,IT>::at(size_t index) const {
+	return buffer[wrap(head + index)];
+}
+
+template<typename T, size_t S, typename IT>
+typename CircularBuffer<T,S,IT>::span inline CircularBuffer<T,S,IT>::firstSpan() {
+	return span{buffer + head, static_cast<IT>((count < S - head) ? count : S - head)};
+}
+
+template<typename T, size_t S, typename IT>
+typename CircularBuffer<T,S,IT>::span inline CircularBuffer<T,S,IT>::secondSpan() {
+	return span{buffer, static_cast<IT>(count - firstSpan().size)};
+}
+
+template<typename T, size_t S, typename IT>
+typename CircularBuffer<T,S,IT>::const_span inline CircularBuffer<T,S,IT>::firstSpan() const {
+	return const_span{buffer + head, static_cast<IT>((count < S - head) ? count : S - head)};
+}
+
+template<typename T, size_t S, typename IT>
+typename CircularBuffer<T,S,IT>::const_span inline CircularBuffer<T,S,IT>::secondSpan() const {
+	return const_span{buffer, static_cast<IT>(count - firstSpan().size)};
+}
+
+template<typename T, size_t S, typename IT>
+typename CircularBuffer<T,S,IT>::iterator inline CircularBuffer<T,S,IT>::begin() {
+	return iterator(this, 0);
+}
+
+template<typename T, size_t S, typename IT>
+typename CircularBuffer<T,S,IT>::iterator inline CircularBuffer<T,S,IT>::end() {
+	return iterator(this, count);
+}
+
+template<typename T, size_t S, typename IT>
+typename CircularBuffer<T,S,IT>::const_iterator inline CircularBuffer<T,S,IT>::begin() const {
+	return const_iterator(this, 0);
+}
+
+template<typename T, size_t S, typename IT>
+typename CircularBuffer<T,S,IT>::const_iterator inline CircularBuffer<T,S,IT>::end() const {
+	return const_iterator(this, count);
+}
+
+template<typename T, size_t S, typename IT>
+IT inline CircularBuffer<T,S,IT>::size() const {
+	return count;
+}
+
+template<typename T, size_t S, typename IT>
+IT inline CircularBuffer<T,S,IT>::available() const {
+	return capacity - count;
+}
+
+template<typename T, size_t S, typename IT>
+bool inline CircularBuffer<T,S,IT>::isEmpty() const {
+	return count == 0;
+}
+
+template<typename T, size_t S, typename IT>
+bool inline CircularBuffer<T,S,IT>::isFull() const {
+	return count == capacity;
+}
+
+template<typename T, size_t S, typename IT>
+void inline CircularBuffer<T,S,IT>::clear() {
+	head = 0;
+	count = 0;
+}
+
+#ifdef CIRCULAR_BUFFER_DEBUG
+#include <string.h>
+template<typename T, size_t S, typename IT>
+void inline CircularBuffer<T,S,IT>::debug(Print* out) {
+	for (IT i = 0; i < capacity; i++) {
+		int hex = (int)buffer + i;
+		out->print("[");
+		out->print(hex, HEX);
+		out->print("] ");
+		out->print(*(buffer + i));
+		if (count > 0 && head == i) {
+			out->print("<-head");
+		} 
+		if (count > 0 && wrap(head + count - 1) == i) {
+			out->print("<-tail");
+		}
+		out->println();
+	}
+}
+
+template<typename T, size_t S, typename IT>
+void inline CircularBuffer<T,S,IT>::debugFn(Print* out, void (*printFunction)(Print*, T)) {
+	for (IT i = 0; i < capacity; i++) {
+		int hex = (int)buffer + i;
+		out->print("[");
+		out->print(hex, HEX);
+		out->print("] ");
+		printFunction(out, *(buffer + i));
+		if (count > 0 && head == i) {
+			out->print("<-head");
+		} 
+		if (count > 0 && wrap(head + count - 1) == i) {
+			out->print("<-tail");
+		}
+		out->println();
+	}
+}
+#endif
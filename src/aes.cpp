@@ -1,13 +1,15 @@
+#include <string.h>
 #include "aes.h"
 
-void aes128_endecrypt(char *destination, char *sourcetext, uint32_t *aes_key, bool decrypt) {
-  char text[17] = { '\0' };
+#ifdef ARDUINO
 
-  strncpy(text, sourcetext, 16);
-  uint32_t text0 = ((uint32_t *)text)[0];
-  uint32_t text1 = ((uint32_t *)text)[1];
-  uint32_t text2 = ((uint32_t *)text)[2];
-  uint32_t text3 = ((uint32_t *)text)[3];
+void aes128_endecrypt_block(uint8_t *destination, const uint8_t *source, uint32_t *aes_key, bool decrypt) {
+  uint32_t text0, text1, text2, text3;
+
+  memcpy(&text0, &source[0], sizeof(uint32_t));
+  memcpy(&text1, &source[4], sizeof(uint32_t));
+  memcpy(&text2, &source[8], sizeof(uint32_t));
+  memcpy(&text3, &source[12], sizeof(uint32_t));
 
   // Zapnuti perifernich hodin AES
   volatile uint32_t *dport_peri_clk_en_reg = (volatile uint32_t *)(DPORT_PERI_CLK_EN_REG);
@@ -78,10 +80,161 @@ void aes128_endecrypt(char *destination, char *sourcetext, uint32_t *aes_key, bo
   memcpy((void *)&destination[12], &text3, sizeof(uint32_t));
 }
 
+#else
+
+// softwarova AES-128 pro preklad mimo Arduino (testovani na PC) - klic i text se
+// berou po bajtech v poradi, v jakem lezi v pameti
+static const uint8_t sbox[256] = {
+  0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
+  0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
+  0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+  0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
+  0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
+  0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+  0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
+  0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
+  0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+  0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
+  0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
+  0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+  0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
+  0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
+  0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+  0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16
+};
+
+// nasobeni v GF(2^8) modulo x^8 + x^4 + x^3 + x + 1
+static uint8_t multiply(uint8_t a, uint8_t b) {
+  uint8_t product = 0;
+
+  while (b != 0) {
+    if (b & 1) {
+      product ^= a;
+    }
+    a = (a << 1) ^ ((a & 0x80) ? 0x1b : 0);
+    b >>= 1;
+  }
+  return product;
+}
+
+// rozvinuti klice do 11 klicu kol po 16 bajtech
+static void expandKey(const uint8_t *key, uint8_t *roundKeys) {
+  uint8_t rcon = 1;
+
+  memcpy(roundKeys, key, 16);
+  for (int i = 16; i < 176; i += 4) {
+    uint8_t word[4];
+    memcpy(word, &roundKeys[i - 4], 4);
+    if (i % 16 == 0) {
+      uint8_t first = word[0];
+      word[0] = sbox[word[1]] ^ rcon;
+      word[1] = sbox[word[2]];
+      word[2] = sbox[word[3]];
+      word[3] = sbox[first];
+      rcon = multiply(rcon, 2);
+    }
+    for (int j = 0; j < 4; ++j) {
+      roundKeys[i + j] = roundKeys[i - 16 + j] ^ word[j];
+    }
+  }
+}
+
+// stav je po sloupcich - bajt radku r ve sloupci c lezi na indexu 4 * c + r
+static void substitute(uint8_t *state, const uint8_t *table) {
+  for (int i = 0; i < 16; ++i) {
+    state[i] = table[state[i]];
+  }
+}
+
+static void shiftRows(uint8_t *state, bool inverse) {
+  uint8_t shifted[16];
+
+  for (int c = 0; c < 4; ++c) {
+    for (int r = 0; r < 4; ++r) {
+      int from = inverse ? (c + 4 - r) % 4 : (c + r) % 4;
+      shifted[4 * c + r] = state[4 * from + r];
+    }
+  }
+  memcpy(state, shifted, 16);
+}
+
+static void mixColumns(uint8_t *state, bool inverse) {
+  static const uint8_t forward[4] = {2, 3, 1, 1};
+  static const uint8_t backward[4] = {14, 11, 13, 9};
+  const uint8_t *row = inverse ? backward : forward;
+
+  for (int c = 0; c < 4; ++c) {
+    uint8_t column[4];
+    memcpy(column, &state[4 * c], 4);
+    for (int r = 0; r < 4; ++r) {
+      state[4 * c + r] = 0;
+      for (int k = 0; k < 4; ++k) {
+        state[4 * c + r] ^= multiply(column[k], row[(k + 4 - r) % 4]);
+      }
+    }
+  }
+}
+
+static void addRoundKey(uint8_t *state, const uint8_t *roundKey) {
+  for (int i = 0; i < 16; ++i) {
+    state[i] ^= roundKey[i];
+  }
+}
+
+void aes128_endecrypt_block(uint8_t *destination, const uint8_t *source, uint32_t *aes_key, bool decrypt) {
+  uint8_t roundKeys[176];
+  uint8_t inverse[256];
+  uint8_t state[16];
+
+  expandKey((const uint8_t *)aes_key, roundKeys);
+  memcpy(state, source, 16);
+
+  if (!decrypt) {
+    addRoundKey(state, roundKeys);
+    for (int round = 1; round <= 10; ++round) {
+      substitute(state, sbox);
+      shiftRows(state, false);
+      if (round < 10) {
+        mixColumns(state, false);
+      }
+      addRoundKey(state, &roundKeys[16 * round]);
+    }
+  }
+  else {
+    for (int i = 0; i < 256; ++i) {
+      inverse[sbox[i]] = (uint8_t)i;
+    }
+    addRoundKey(state, &roundKeys[160]);
+    for (int round = 9; round >= 0; --round) {
+      shiftRows(state, true);
+      substitute(state, inverse);
+      addRoundKey(state, &roundKeys[16 * round]);
+      if (round > 0) {
+        mixColumns(state, true);
+      }
+    }
+  }
+  memcpy(destination, state, 16);
+}
+
+#endif
+
+// textova varianta - zdrojovy text konci prvnim nulovym znakem, zbytek bloku se doplni nulami
+void aes128_endecrypt(char *destination, char *sourcetext, uint32_t *aes_key, bool decrypt) {
+  char text[17] = { '\0' };
+
+  strncpy(text, sourcetext, 16);
+  aes128_endecrypt_block((uint8_t *)destination, (uint8_t *)text, aes_key, decrypt);
+}
+
 void aes128_encrypt(char *dest, char *src, uint32_t *key) {
     aes128_endecrypt(dest, src, key, 0);
 }
 
 void aes128_decrypt(char *dest, char *src, uint32_t *key) {
     aes128_endecrypt(dest, src, key, 1);
+}
+
+void aes128_encrypt_block(uint8_t *dest, const uint8_t *src, uint32_t *key) {
+    aes128_endecrypt_block(dest, src, key, 0);
 }
\ No newline at end of file
@@ -1,7 +1,7 @@
 #ifndef AES_H
 #define AES_H
 
-#include <Arduino.h>
+#include <stdint.h>
 #include "tools.h"
 
 /* ADRESY REGISTRU */
@@ -32,4 +32,6 @@ void aes128_encrypt(char *dest, char *src, uint32_t *key);
 
 void aes128_decrypt(char *dest, char *src, uint32_t *key);
 
+void aes128_encrypt_block(uint8_t *dest, const uint8_t *src, uint32_t *key);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,170 @@
+#include "agp.h"
+
+static const uint8_t percentiles[AGP_PERCENTILES] = AGP_PERCENTILE_VALUES;
+
+// casy mereni jsou cele sekundy a rostou - trida useku za okno nepretece, pokud se
+// mereni odecitaji; pri chybe zdroje se cetnost tridy zastavi na maximu
+static_assert(AGP_WINDOW_DAYS * AGP_BUCKET_WIDTH <= UINT16_MAX, "cetnost tridy musi byt uint16");
+
+// histogram hodnot pro kazdy usek dne, pamet nezavisi na delce zaznamu
+static uint16_t bins[AGP_BUCKETS][AGP_BINS];
+static uint32_t counts[AGP_BUCKETS] = { 0 };
+
+static AgpSource source = NULL;
+static int32_t origin = 0;
+
+// profil zahrnuje mereni novejsi nez expired
+static int32_t expired = INT32_MIN;
+
+static uint8_t bucketOf(int32_t time) {
+  int32_t timeOfDay = (int32_t)(((int64_t)time + origin) % AGP_DAY);
+  if (timeOfDay < 0) {
+    timeOfDay += AGP_DAY;
+  }
+  return (uint8_t)(timeOfDay / AGP_BUCKET_WIDTH);
+}
+
+static uint8_t binOf(int32_t value) {
+  if (value < AGP_MIN_VALUE) {
+    return 0;
+  }
+  int32_t bin = (value - AGP_MIN_VALUE) / AGP_BIN_WIDTH;
+  return (bin < AGP_BINS) ? (uint8_t)bin : AGP_BINS - 1;
+}
+
+static void addMeasurement(CGMeasurement measurement) {
+  uint8_t bucket = bucketOf(measurement.timeOffset);
+  uint8_t bin = binOf(measurement.glucoseValue);
+  if (bins[bucket][bin] < UINT16_MAX) {
+    bins[bucket][bin]++;
+    counts[bucket]++;
+  }
+}
+
+static void removeMeasurement(CGMeasurement measurement) {
+  uint8_t bucket = bucketOf(measurement.timeOffset);
+  uint8_t bin = binOf(measurement.glucoseValue);
+  if (bins[bucket][bin] > 0) {
+    bins[bucket][bin]--;
+    counts[bucket]--;
+  }
+}
+
+/**
+ * @brief nastavi zdroj mereni a pocatek dne a vyprazdni profil
+ * 
+ * @param measurementSource funkce vracejici prvni mereni novejsi nez zadany cas
+ * @param timeOfDay cas dne zacatku relace v sekundach od pulnoci
+ */
+void agp_init(AgpSource measurementSource, int32_t timeOfDay) {
+  source = measurementSource;
+  origin = timeOfDay;
+  expired = INT32_MIN;
+  for (uint8_t bucket = 0; bucket < AGP_BUCKETS; ++bucket) {
+    for (uint8_t bin = 0; bin < AGP_BINS; ++bin) {
+      bins[bucket][bin] = 0;
+    }
+    counts[bucket] = 0;
+  }
+}
+
+/**
+ * @brief sestavi profil znovu ze zdroje - mereni okna konciciho poslednim merenim,
+ * napr. po restartu nebo zmene pocatku dne
+ * 
+ * @param last cas posledniho mereni
+ */
+void agp_rebuild(int32_t last) {
+  CGMeasurement measurement;
+
+  agp_init(source, origin);
+  expired = (last > INT32_MIN + AGP_WINDOW) ? last - AGP_WINDOW : INT32_MIN;
+  for (int32_t time = expired; source != NULL && source(time, &measurement) && measurement.timeOffset <= last; time = measurement.timeOffset) {
+    addMeasurement(measurement);
+  }
+}
+
+/**
+ * @brief zapocita mereni do histogramu jeho useku dne a odecte mereni, ktera opustila
+ * okno, cena O(1) cteni zdroje na mereni
+ * 
+ * @param measurement nove mereni
+ */
+void agp_push(CGMeasurement measurement) {
+  CGMeasurement old;
+
+  addMeasurement(measurement);
+  while (source != NULL && source(expired, &old) && (int64_t)old.timeOffset <= (int64_t)measurement.timeOffset - AGP_WINDOW) {
+    removeMeasurement(old);
+    expired = old.timeOffset;
+  }
+}
+
+/**
+ * @brief odecte mereni, ktere zdroj ztratil (log jej prepsal) drive, nez opustilo okno;
+ * mereni se predavaji od nejstarsiho
+ * 
+ * @param measurement mereni odstranene ze zdroje
+ */
+void agp_drop(CGMeasurement measurement) {
+  if (measurement.timeOffset > expired) {
+    removeMeasurement(measurement);
+    expired = measurement.timeOffset;
+  }
+}
+
+uint32_t agp_count(uint8_t bucket) {
+  return (bucket < AGP_BUCKETS) ? counts[bucket] : 0;
+}
+
+/**
+ * @brief odhadne percentily useku linearni interpolaci uvnitr tridy histogramu
+ * 
+ * @param bucket usek dne
+ * @param values pole AGP_PERCENTILES odhadu (mmol/l * 100)
+ * @return false usek neobsahuje zadne mereni
+ */
+bool agp_percentiles(uint8_t bucket, int32_t *values) {
+  if (bucket >= AGP_BUCKETS || counts[bucket] == 0) {
+    return false;
+  }
+
+  uint32_t cumulative = 0;
+  uint8_t bin = 0;
+  for (uint8_t i = 0; i < AGP_PERCENTILES; ++i) {
+    // poradi hledane hodnoty v nasobcich 1/100 mereni
+    uint32_t rank = percentiles[i] * counts[bucket];
+    while (bin < AGP_BINS - 1 && (cumulative + bins[bucket][bin]) * 100 <= rank) {
+      cumulative += bins[bucket][bin++];
+    }
+    uint32_t inBin = bins[bucket][bin];
+    uint32_t offset = (inBin > 0) ? (rank - cumulative * 100) * AGP_BIN_WIDTH / (inBin * 100) : 0;
+    values[i] = AGP_MIN_VALUE + bin * AGP_BIN_WIDTH + offset;
+  }
+  return true;
+}
+
+/**
+ * @brief zakoduje profil pro prenos - pocet percentilu, pocet useku a pro kazdy
+ * usek percentily po jednom bajtu v 0.1 mmol/l (0 pro usek bez mereni)
+ * 
+ * @return delka zakodovanych dat
+ */
+size_t agp_pack(uint8_t *dest, size_t len) {
+  int32_t values[AGP_PERCENTILES];
+
+  if (len < AGP_PACKED_SIZE) {
+    return 0;
+  }
+
+  dest[0] = AGP_PERCENTILES;
+  dest[1] = AGP_BUCKETS;
+  for (uint8_t bucket = 0; bucket < AGP_BUCKETS; ++bucket) {
+    uint8_t *packed = dest + 2 + bucket * AGP_PERCENTILES;
+    bool found = agp_percentiles(bucket, values);
+    for (uint8_t i = 0; i < AGP_PERCENTILES; ++i) {
+      packed[i] = found ? (uint8_t)((values[i] + 5) / 10) : 0;
+    }
+  }
+  return AGP_PACKED_SIZE;
+}
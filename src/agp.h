@@ -0,0 +1,54 @@
+#ifndef AGP_H
+#define AGP_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "measurement.h"
+
+/* AMBULANTNI GLYKEMICKY PROFIL */
+
+// useky dne po 15 minutach - cas dne mereni je (timeOffset + pocatek) mod den, pocatek
+// je cas dne zacatku relace (timeOffset 0) v sekundach od pulnoci, zapise jej klient
+#define AGP_BUCKETS 96
+#define AGP_BUCKET_WIDTH 900
+#define AGP_DAY (AGP_BUCKETS * AGP_BUCKET_WIDTH)
+
+// profil zahrnuje mereni poslednich 14 dni, starsi mereni se z histogramu odectou
+#define AGP_WINDOW_DAYS 14
+#define AGP_WINDOW (AGP_WINDOW_DAYS * AGP_DAY)
+
+// histogram useku pokryva 40 - 400 mg/dl (2.22 - 22.06 mmol/l) po 0.31 mmol/l,
+// hodnoty mimo rozsah se zapocitaji do krajnich trid
+#define AGP_BINS 64
+#define AGP_MIN_VALUE 222
+#define AGP_BIN_WIDTH 31
+
+#define AGP_PERCENTILES 5
+#define AGP_PERCENTILE_VALUES { 5, 25, 50, 75, 95 }
+
+// velikost profilu pri prenosu pres BLE - pocet percentilu, pocet useku a hodnoty
+#define AGP_PACKED_SIZE (2 + AGP_BUCKETS * AGP_PERCENTILES)
+
+// zdroj mereni pro odecteni mereni opoustejicich okno a pro prepocet - prvni mereni
+// novejsi nez time (log relace); mereni, ktera zdroj ztrati drive, nez opusti okno,
+// se odectou pres agp_drop
+typedef bool (*AgpSource)(int32_t time, CGMeasurement *measurement);
+
+
+/* FUNKCE PROFILU */
+
+void agp_init(AgpSource source, int32_t origin);
+
+void agp_rebuild(int32_t last);
+
+void agp_push(CGMeasurement measurement);
+
+void agp_drop(CGMeasurement measurement);
+
+uint32_t agp_count(uint8_t bucket);
+
+bool agp_percentiles(uint8_t bucket, int32_t *values);
+
+size_t agp_pack(uint8_t *dest, size_t len);
+
+#endif
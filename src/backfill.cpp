@@ -0,0 +1,175 @@
+#include "backfill.h"
+#include "bytes.h"
+#include "simple8b.h"
+
+BackfillSource backfillSource = NULL;
+
+// mereni prectena dopredu a rozdily pro komprimovany paket
+static CGMeasurement window[BACKFILL_COMPRESSED_MAX_RECORDS];
+static uint64_t deltas[2 * BACKFILL_COMPRESSED_MAX_RECORDS];
+
+static void getRecord(const uint8_t *record, CGMeasurement *measurement) {
+  measurement->timeOffset = (int32_t)getLE(record, 4);
+  measurement->glucoseValue = (int32_t)getLE(record + 4, 2);
+}
+
+/**
+ * @brief naplni rozdily prvnich count zaznamu okna
+ * 
+ * @return pocet rozdilu
+ */
+static size_t fillDeltas(size_t count) {
+  int64_t previousDelta = 0;
+
+  for (size_t i = 1; i < count; ++i) {
+    int64_t delta = (int64_t)window[i].timeOffset - window[i - 1].timeOffset;
+    deltas[i - 1] = zigzag(delta - previousDelta);
+    deltas[count - 1 + i - 1] = zigzag((int64_t)window[i].glucoseValue - window[i - 1].glucoseValue);
+    previousDelta = delta;
+  }
+  return (count > 0) ? 2 * (count - 1) : 0;
+}
+
+/**
+ * @brief nastavi zdroj mereni pro skladani paketu
+ * 
+ * @param source funkce vracejici prvni mereni novejsi nez zadany cas
+ */
+void backfill_init(BackfillSource source) {
+  backfillSource = source;
+}
+
+/**
+ * @brief zapise jeden zaznam ve formatu hromadneho prenosu
+ * 
+ * @param measurement mereni
+ * @param dest cil o velikosti alespon BACKFILL_RECORD_SIZE
+ * @return BACKFILL_RECORD_SIZE
+ */
+size_t backfill_put(CGMeasurement measurement, uint8_t *dest) {
+  putLE(dest, (uint32_t)measurement.timeOffset, 4);
+  putLE(dest + 4, (uint16_t)measurement.glucoseValue, 2);
+  return BACKFILL_RECORD_SIZE;
+}
+
+/**
+ * @brief slozi jeden paket hromadneho prenosu - pocet zaznamu a tolik zaznamu nasledujicich
+ * po zadanem case, kolik se vejde do kapacity; nezavisi na BLE, kapacitu urcuje volajici z MTU
+ * 
+ * @param time cas posledniho odeslaneho mereni, posune se na posledni zabalene mereni
+ * @param dest cilovy buffer
+ * @param capacity velikost ciloveho bufferu, alespon BACKFILL_HEADER_SIZE
+ * @return delka paketu
+ */
+size_t backfill_pack(int32_t *time, uint8_t *dest, size_t capacity) {
+  CGMeasurement measurement;
+  size_t len = BACKFILL_HEADER_SIZE;
+  uint8_t count = 0;
+
+  while (count < UINT8_MAX && len + BACKFILL_RECORD_SIZE <= capacity && backfillSource(*time, &measurement)) {
+    len += backfill_put(measurement, dest + len);
+    ++count;
+    *time = measurement.timeOffset;
+  }
+  dest[0] = count;
+  return len;
+}
+
+/**
+ * @brief rozbali paket hromadneho prenosu - protejsek backfill_pack pro klienta
+ * 
+ * @param src paket
+ * @param len delka paketu
+ * @param dest cilove pole mereni
+ * @param max velikost ciloveho pole
+ * @return pocet rozbalenych mereni, 0 u koncoveho nebo poskozeneho paketu
+ */
+size_t backfill_unpack(const uint8_t *src, size_t len, CGMeasurement *dest, size_t max) {
+  if (len < BACKFILL_HEADER_SIZE || src[0] > max || len < BACKFILL_HEADER_SIZE + (size_t)src[0] * BACKFILL_RECORD_SIZE) {
+    return 0;
+  }
+  const uint8_t *record = src + BACKFILL_HEADER_SIZE;
+  for (uint8_t i = 0; i < src[0]; ++i, record += BACKFILL_RECORD_SIZE) {
+    getRecord(record, &dest[i]);
+  }
+  return src[0];
+}
+
+/**
+ * @brief slozi komprimovany paket - co nejvice zaznamu nasledujicich po zadanem case,
+ * jejichz slova Simple8b se vejdou do kapacity (puleni poctu zaznamu)
+ * 
+ * @param time cas posledniho odeslaneho mereni, posune se na posledni zabalene mereni
+ * @param dest cilovy buffer
+ * @param capacity velikost ciloveho bufferu, alespon BACKFILL_COMPRESSED_HEADER_SIZE
+ * @return delka paketu, koncovy paket bez zaznamu ma BACKFILL_HEADER_SIZE
+ */
+size_t backfill_pack_compressed(int32_t *time, uint8_t *dest, size_t capacity) {
+  size_t limit = 1 + (capacity - BACKFILL_COMPRESSED_HEADER_SIZE) / SIMPLE8B_WORD_SIZE * BACKFILL_COMPRESSED_RECORDS_PER_WORD;
+  size_t available = 0;
+  int32_t cursor = *time;
+
+  if (limit > BACKFILL_COMPRESSED_MAX_RECORDS) {
+    limit = BACKFILL_COMPRESSED_MAX_RECORDS;
+  }
+  while (available < limit && backfillSource(cursor, &window[available])) {
+    cursor = window[available++].timeOffset;
+  }
+  if (available == 0) {
+    dest[0] = 0;
+    return BACKFILL_HEADER_SIZE;
+  }
+
+  // nejvyssi pocet zaznamu, ktery se vejde - jeden zaznam se vejde vzdy
+  size_t low = 1;
+  size_t high = available;
+  while (low < high) {
+    size_t mid = (low + high + 1) / 2;
+    size_t count = fillDeltas(mid);
+    size_t words = simple8b_words(deltas, count);
+    if ((words > 0 || count == 0) && BACKFILL_COMPRESSED_HEADER_SIZE + words * SIMPLE8B_WORD_SIZE <= capacity) {
+      low = mid;
+    }
+    else {
+      high = mid - 1;
+    }
+  }
+
+  size_t len = simple8b_encode(deltas, fillDeltas(low), dest + BACKFILL_COMPRESSED_HEADER_SIZE, capacity - BACKFILL_COMPRESSED_HEADER_SIZE);
+  backfill_put(window[0], dest + 2);
+  dest[0] = (uint8_t)low;
+  dest[1] = BACKFILL_ENCODING_SIMPLE8B;
+  *time = window[low - 1].timeOffset;
+  return BACKFILL_COMPRESSED_HEADER_SIZE + len;
+}
+
+/**
+ * @brief rozbali komprimovany paket - referencni dekoder pro klienta
+ * 
+ * @param src paket
+ * @param len delka paketu
+ * @param dest cilove pole mereni
+ * @param max velikost ciloveho pole
+ * @return pocet rozbalenych mereni, 0 u koncoveho nebo poskozeneho paketu
+ */
+size_t backfill_unpack_compressed(const uint8_t *src, size_t len, CGMeasurement *dest, size_t max) {
+  uint64_t values[2 * BACKFILL_COMPRESSED_MAX_RECORDS];
+  size_t count = (len > 0) ? src[0] : 0;
+
+  if (count == 0 || count > max || len < BACKFILL_COMPRESSED_HEADER_SIZE || src[1] != BACKFILL_ENCODING_SIMPLE8B) {
+    return 0;
+  }
+  getRecord(src + 2, &dest[0]);
+  size_t deltaCount = 2 * (count - 1);
+  if (simple8b_decode(src + BACKFILL_COMPRESSED_HEADER_SIZE, len - BACKFILL_COMPRESSED_HEADER_SIZE, values, deltaCount) != deltaCount) {
+    return 0;
+  }
+
+  int64_t delta = 0;
+  for (size_t i = 1; i < count; ++i) {
+    delta += unzigzag(values[i - 1]);
+    dest[i].timeOffset = (int32_t)(dest[i - 1].timeOffset + delta);
+    dest[i].glucoseValue = (int32_t)(dest[i - 1].glucoseValue + unzigzag(values[count - 1 + i - 1]));
+  }
+  return count;
+}
@@ -0,0 +1,48 @@
+#ifndef BACKFILL_H
+#define BACKFILL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "measurement.h"
+
+/* PARAMETRY HROMADNEHO PRENOSU */
+
+// zaznam hromadneho prenosu - cas int32 a hodnota uint16, little-endian
+#define BACKFILL_RECORD_SIZE 6
+
+// paket zacina poctem zaznamu, paket bez zaznamu prenos ukoncuje
+#define BACKFILL_HEADER_SIZE 1
+
+/**
+ * Komprimovany paket: pocet zaznamu (uint8), kodovani (uint8), cas (int32) a hodnota
+ * (uint16) prvniho zaznamu a slova Simple8b - nejdrive zigzag druhych diferenci casu
+ * (prvni rozdil se bere vuci nule), pak zigzag rozdilu hodnot. Kazdy paket je
+ * samostatne dekodovatelny, hlavicka ma velikost slova.
+ */
+#define BACKFILL_ENCODING_RAW 0
+#define BACKFILL_ENCODING_SIMPLE8B 1
+#define BACKFILL_COMPRESSED_HEADER_SIZE 8
+#define BACKFILL_COMPRESSED_MAX_RECORDS 255
+
+// odhad nejvyssiho poctu zaznamu na slovo pri cteni dopredu ze zdroje
+#define BACKFILL_COMPRESSED_RECORDS_PER_WORD 30
+
+// zdroj mereni pro prenos - prvni mereni novejsi nez time
+typedef bool (*BackfillSource)(int32_t time, CGMeasurement *measurement);
+
+
+/* FUNKCE HROMADNEHO PRENOSU */
+
+void backfill_init(BackfillSource source);
+
+size_t backfill_put(CGMeasurement measurement, uint8_t *dest);
+
+size_t backfill_pack(int32_t *time, uint8_t *dest, size_t capacity);
+
+size_t backfill_unpack(const uint8_t *src, size_t len, CGMeasurement *dest, size_t max);
+
+size_t backfill_pack_compressed(int32_t *time, uint8_t *dest, size_t capacity);
+
+size_t backfill_unpack_compressed(const uint8_t *src, size_t len, CGMeasurement *dest, size_t max);
+
+#endif
@@ -0,0 +1,130 @@
+#include <string.h>
+#include "aes.h"
+#include "beacon.h"
+#include "bytes.h"
+
+// navesti pro odvozeni klicu a doplneni bloku s citacem
+static const uint8_t BEACON_ENCRYPTION_LABEL[16] = {'C', 'G', 'M', '-', 'B', 'E', 'A', 'C', 'O', 'N', '-', 'E', 'N', 'C', 0, 0};
+static const uint8_t BEACON_AUTHENTICATION_LABEL[16] = {'C', 'G', 'M', '-', 'B', 'E', 'A', 'C', 'O', 'N', '-', 'M', 'A', 'C', 0, 0};
+
+/**
+ * @brief zasifruje navesti klicem relace, vysledny blok je odvozeny klic
+ * 
+ */
+static void deriveKey(uint32_t *sessionKey, const uint8_t *label, uint32_t *key) {
+  uint8_t block[16];
+
+  aes128_encrypt_block(block, label, sessionKey);
+  memcpy(key, block, sizeof(block));
+}
+
+/**
+ * @brief spocita proud klice pro sifrovany blok pro danou hodnotu citace
+ * 
+ */
+static void keystream(const BeaconKeys *keys, const uint8_t *counter, uint8_t *stream) {
+  uint8_t block[16] = { 0 };
+
+  memcpy(block, counter, 4);
+  aes128_encrypt_block(stream, block, (uint32_t *)keys->encryption);
+}
+
+static void tag(const BeaconKeys *keys, const uint8_t *counterAndData, uint8_t *out) {
+  uint8_t block[16] = { 0 };
+
+  memcpy(block, counterAndData, 4 + BEACON_DATA_SIZE);
+  aes128_encrypt_block(out, block, (uint32_t *)keys->authentication);
+}
+
+/**
+ * @brief odvodi klice vysilani ze sdileneho klice relace (klic AES relace je sdileny klic 4x)
+ * 
+ * @param sharedKey sdileny klic z parovani
+ * @param keys odvozene klice
+ */
+void beacon_derive(uint32_t sharedKey, BeaconKeys *keys) {
+  uint32_t sessionKey[4] = {sharedKey, sharedKey, sharedKey, sharedKey};
+
+  deriveKey(sessionKey, BEACON_ENCRYPTION_LABEL, keys->encryption);
+  deriveKey(sessionKey, BEACON_AUTHENTICATION_LABEL, keys->authentication);
+}
+
+/**
+ * @brief slozi data vyrobce s poslednim merenim - dve operace AES na jedno mereni
+ * 
+ * @param keys klice vysilani
+ * @param counter hodnota citace vysilani, pod stejnym klicem se nesmi opakovat
+ * @param measurement posledni mereni
+ * @param previous predchozi mereni pro trend, muze byt NULL
+ * @param dest buffer o velikosti BEACON_PAYLOAD_SIZE
+ * @return delka dat vyrobce
+ */
+size_t beacon_seal(const BeaconKeys *keys, uint32_t counter, CGMeasurement measurement, const CGMeasurement *previous, uint8_t *dest) {
+  uint8_t stream[16];
+  uint8_t mac[16];
+  int32_t trend = 0;
+  uint8_t flags = 0;
+
+  if (previous != NULL && measurement.timeOffset > previous->timeOffset) {
+    trend = (measurement.glucoseValue - previous->glucoseValue) * 60 / (measurement.timeOffset - previous->timeOffset);
+    trend = (trend > INT8_MAX) ? INT8_MAX : ((trend < INT8_MIN) ? INT8_MIN : trend);
+    flags |= BEACON_FLAG_TREND;
+  }
+
+  putLE(dest, BEACON_COMPANY_ID, 2);
+  putLE(dest + BEACON_COUNTER_OFFSET, counter, 4);
+  putLE(dest + BEACON_DATA_OFFSET, (uint32_t)measurement.timeOffset, 4);
+  putLE(dest + BEACON_DATA_OFFSET + 4, (uint16_t)measurement.glucoseValue, 2);
+  dest[BEACON_DATA_OFFSET + 6] = (uint8_t)(int8_t)trend;
+  dest[BEACON_DATA_OFFSET + 7] = flags;
+
+  keystream(keys, dest + BEACON_COUNTER_OFFSET, stream);
+  for (uint8_t i = 0; i < BEACON_DATA_SIZE; ++i) {
+    dest[BEACON_DATA_OFFSET + i] ^= stream[i];
+  }
+  tag(keys, dest + BEACON_COUNTER_OFFSET, mac);
+  memcpy(dest + BEACON_TAG_OFFSET, mac, BEACON_TAG_SIZE);
+  return BEACON_PAYLOAD_SIZE;
+}
+
+/**
+ * @brief overi a rozsifruje data vyrobce - referencni protejsek beacon_seal pro prijemce
+ * 
+ * @param keys klice vysilani odvozene ze stejneho sdileneho klice
+ * @param src data vyrobce
+ * @param len delka dat vyrobce
+ * @param lastCounter posledni prijata hodnota citace (UINT32_MAX pokud zadna), starsi a stejne se odmitaji
+ * @param measurement rozsifrovane mereni
+ * @param trend trend v mmol/l * 100 za minutu, 0 pokud neni k dispozici
+ * @return true data jsou autenticka a nova
+ */
+bool beacon_open(const BeaconKeys *keys, const uint8_t *src, size_t len, uint32_t lastCounter, CGMeasurement *measurement, int8_t *trend) {
+  uint8_t stream[16];
+  uint8_t mac[16];
+  uint8_t data[BEACON_DATA_SIZE];
+
+  if (len != BEACON_PAYLOAD_SIZE || getLE(src, 2) != BEACON_COMPANY_ID) {
+    return false;
+  }
+  uint32_t counter = getLE(src + BEACON_COUNTER_OFFSET, 4);
+  if (counter <= lastCounter && lastCounter != UINT32_MAX) {
+    return false;
+  }
+  tag(keys, src + BEACON_COUNTER_OFFSET, mac);
+  uint8_t diff = 0;
+  for (uint8_t i = 0; i < BEACON_TAG_SIZE; ++i) {
+    diff |= mac[i] ^ src[BEACON_TAG_OFFSET + i];
+  }
+  if (diff != 0) {
+    return false;
+  }
+
+  keystream(keys, src + BEACON_COUNTER_OFFSET, stream);
+  for (uint8_t i = 0; i < BEACON_DATA_SIZE; ++i) {
+    data[i] = src[BEACON_DATA_OFFSET + i] ^ stream[i];
+  }
+  measurement->timeOffset = (int32_t)getLE(data, 4);
+  measurement->glucoseValue = (int32_t)getLE(data + 4, 2);
+  *trend = (data[7] & BEACON_FLAG_TREND) ? (int8_t)data[6] : 0;
+  return true;
+}
@@ -0,0 +1,48 @@
+#ifndef BEACON_H
+#define BEACON_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "measurement.h"
+
+/* PARAMETRY VYSILANI MERENI V ADVERTISINGU */
+
+/**
+ * Data vyrobce v scan response: identifikator vyrobce (uint16), citac vysilani
+ * (uint32), sifrovany blok (casovy posun int32, glukoza uint16, trend int8,
+ * priznaky uint8) a zkracena autentizacni znacka. Vse little-endian.
+ * Sifrovany blok je XOR s AES(klic, citac), znacka je AES druhym klicem nad citacem
+ * a sifrovanym blokem. Oba klice se odvozuji ze sdileneho klice relace, prijemce
+ * odmita hodnoty citace, ktere uz videl.
+ * Citac je nonce proudu klice - nezavisi na casu mereni (ten se s novou relaci vraci)
+ * a nesmi se pod stejnym klicem nikdy opakovat, proto se uklada do flash.
+ */
+#define BEACON_COMPANY_ID 0xFFFF
+#define BEACON_PAYLOAD_SIZE 18
+#define BEACON_COUNTER_OFFSET 2
+#define BEACON_DATA_OFFSET 6
+#define BEACON_DATA_SIZE 8
+#define BEACON_TAG_OFFSET 14
+#define BEACON_TAG_SIZE 4
+
+// citac se uklada po blocich, po restartu se pokracuje za celym rezervovanym blokem
+#define BEACON_COUNTER_BLOCK 256
+
+// trend v mmol/l * 100 za minutu je platny
+#define BEACON_FLAG_TREND 0x01
+
+struct BeaconKeys {
+  uint32_t encryption[4];
+  uint32_t authentication[4];
+};
+
+
+/* FUNKCE VYSILANI MERENI */
+
+void beacon_derive(uint32_t sharedKey, BeaconKeys *keys);
+
+size_t beacon_seal(const BeaconKeys *keys, uint32_t counter, CGMeasurement measurement, const CGMeasurement *previous, uint8_t *dest);
+
+bool beacon_open(const BeaconKeys *keys, const uint8_t *src, size_t len, uint32_t lastCounter, CGMeasurement *measurement, int8_t *trend);
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef BYTES_H
+#define BYTES_H
+
+#include <stdint.h>
+
+/* KODOVANI BAJTU SPOLECNE PRO FORMATY PRENOSU */
+
+/**
+ * @brief zapise nejnizsich len bajtu hodnoty v poradi little-endian
+ * 
+ */
+static inline void putLE(uint8_t *dest, uint32_t value, uint8_t len) {
+  for (uint8_t i = 0; i < len; ++i) {
+    dest[i] = (uint8_t)(value >> (8 * i));
+  }
+}
+
+/**
+ * @brief precte len bajtu hodnoty v poradi little-endian
+ * 
+ */
+static inline uint32_t getLE(const uint8_t *src, uint8_t len) {
+  uint32_t value = 0;
+  for (uint8_t i = 0; i < len; ++i) {
+    value |= (uint32_t)src[i] << (8 * i);
+  }
+  return value;
+}
+
+/**
+ * @brief zigzag - cisla se znamenkem blizka nule na mala cisla bez znamenka
+ * 
+ */
+static inline uint64_t zigzag(int64_t n) {
+  return ((uint64_t)n << 1) ^ (uint64_t)(n >> 63);
+}
+
+static inline int64_t unzigzag(uint64_t n) {
+  return (int64_t)(n >> 1) ^ -(int64_t)(n & 1);
+}
+
+#endif
@@ -0,0 +1,61 @@
+#include <string.h>
+
+#include "client.h"
+
+// tabulka relaci, volne misto ma active == false
+static Client clients[CLIENT_MAX_CONNECTIONS];
+
+/**
+ * @brief zalozi relaci noveho spojeni, existujici relaci spojeni vrati beze zmeny
+ * 
+ * @param connId identifikator spojeni
+ * @return relace, NULL pokud je tabulka plna
+ */
+Client *client_open(uint16_t connId) {
+  Client *client = client_find(connId);
+  if (client != NULL) {
+    return client;
+  }
+  for (uint8_t i = 0; i < CLIENT_MAX_CONNECTIONS; ++i) {
+    if (!clients[i].active) {
+      memset(&clients[i], 0, sizeof(Client));
+      clients[i].active = true;
+      clients[i].connId = connId;
+      return &clients[i];
+    }
+  }
+  return NULL;
+}
+
+Client *client_find(uint16_t connId) {
+  for (uint8_t i = 0; i < CLIENT_MAX_CONNECTIONS; ++i) {
+    if (clients[i].active && clients[i].connId == connId) {
+      return &clients[i];
+    }
+  }
+  return NULL;
+}
+
+void client_close(uint16_t connId) {
+  Client *client = client_find(connId);
+  if (client != NULL) {
+    client->active = false;
+  }
+}
+
+/**
+ * @brief relace na dane pozici tabulky
+ * 
+ * @return relace, NULL pokud pozice neni obsazena
+ */
+Client *client_at(uint8_t index) {
+  return (index < CLIENT_MAX_CONNECTIONS && clients[index].active) ? &clients[index] : NULL;
+}
+
+uint8_t client_count() {
+  uint8_t count = 0;
+  for (uint8_t i = 0; i < CLIENT_MAX_CONNECTIONS; ++i) {
+    count += clients[i].active ? 1 : 0;
+  }
+  return count;
+}
@@ -0,0 +1,72 @@
+#ifndef CLIENT_H
+#define CLIENT_H
+
+#include <stdint.h>
+#include "format.h"
+#include "lttb.h"
+#include "racp.h"
+#include "link.h"
+
+/* PARAMETRY KLIENTU */
+
+// nejvetsi pocet soucasne pripojenych klientu (CONFIG_BT_ACL_CONNECTIONS)
+#define CLIENT_MAX_CONNECTIONS 4
+
+// odebirane notifikace klienta (zapis do deskriptoru BLE2902 daneho spojeni)
+#define CLIENT_SUBSCRIBED_MEASUREMENT 0x01
+#define CLIENT_SUBSCRIBED_BACKFILL 0x02
+#define CLIENT_SUBSCRIBED_RACP 0x04
+#define CLIENT_SUBSCRIBED_CHART 0x08
+#define CLIENT_SUBSCRIBED_ROLLUP 0x10
+
+// stavy relace a podstavy pro sluzbu zabezpeceni
+enum State {INIT, SECURITY, READ, NOTIFY, STREAM};
+enum SecurityState {PAIR_0, PAIR_1, AUTH_0, AUTH_1, READY};
+
+// relace jednoho pripojeneho klienta - stav handshaku, klice a kurzory doruceni
+struct Client {
+  bool active;
+  uint16_t connId;
+  Link link;
+  State state;
+  SecurityState securityState;
+  uint32_t sharedKey;
+  uint32_t aesKey[4];
+  uint32_t challenge;
+  uint32_t checkNum;
+  int32_t securityValue;
+  int32_t lastTime;
+  int32_t delivered;
+  MeasurementFormat format;
+  uint8_t subscriptions;
+  bool streamBacklog;
+  bool congested;
+  bool backfillActive;
+  int32_t backfillTime;
+  uint8_t backfillEncoding;
+  bool racpActive;
+  uint8_t racpResponse[RACP_RESPONSE_SIZE];
+  uint8_t racpResponseLen;
+  int32_t racpTime;
+  int32_t racpTo;
+  bool chartActive;
+  LttbQuery chart;
+  bool rollupActive;
+  uint8_t rollupLevel;
+  int32_t rollupFrom;
+};
+
+
+/* FUNKCE KLIENTU */
+
+Client *client_open(uint16_t connId);
+
+Client *client_find(uint16_t connId);
+
+void client_close(uint16_t connId);
+
+Client *client_at(uint8_t index);
+
+uint8_t client_count();
+
+#endif
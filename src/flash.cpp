@@ -0,0 +1,129 @@
+#include "flash.h"
+
+#ifdef ARDUINO
+
+#include <esp_partition.h>
+
+static const esp_partition_t *partition = NULL;
+
+bool flash_init() {
+  partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, FLASH_PARTITION_LABEL);
+  return partition != NULL;
+}
+
+uint32_t flash_size() {
+  return (partition != NULL) ? partition->size : 0;
+}
+
+bool flash_read(uint32_t offset, void *dest, size_t len) {
+  return esp_partition_read(partition, offset, dest, len) == ESP_OK;
+}
+
+bool flash_write(uint32_t offset, const void *src, size_t len) {
+  return esp_partition_write(partition, offset, src, len) == ESP_OK;
+}
+
+bool flash_erase_sector(uint32_t sector) {
+  return esp_partition_erase_range(partition, sector * FLASH_SECTOR_SIZE, FLASH_SECTOR_SIZE) == ESP_OK;
+}
+
+#else
+
+#include <stdio.h>
+#include <string.h>
+
+// soubor emulujici NOR flash - mazani nastavuje bajty na 0xFF, zapis muze bity pouze nulovat
+static FILE *file = NULL;
+
+// pocet bajtu, ktere se jeste zapisou pred simulovanym vypadkem napajeni (-1 bez omezeni)
+static int32_t writeBudget = -1;
+
+/**
+ * @brief vstrikovani chyb - po zapsani zadaneho poctu bajtu se probihajici zapis
+ * prerusi uprostred a vsechny dalsi zapisy a mazani selhavaji (vypadek napajeni)
+ * 
+ * @param bytes pocet bajtu do vypadku, zaporna hodnota chyby vypne
+ */
+void flash_emulator_fail_after(int32_t bytes) {
+  writeBudget = bytes;
+}
+
+bool flash_init() {
+  if (file != NULL) {
+    return true;
+  }
+  file = fopen(FLASH_EMULATOR_FILE, "r+b");
+  if (file == NULL) {
+    file = fopen(FLASH_EMULATOR_FILE, "w+b");
+    if (file == NULL) {
+      return false;
+    }
+    uint8_t erased[FLASH_SECTOR_SIZE];
+    memset(erased, 0xFF, sizeof(erased));
+    for (uint32_t i = 0; i < FLASH_EMULATOR_SIZE / FLASH_SECTOR_SIZE; ++i) {
+      fwrite(erased, 1, sizeof(erased), file);
+    }
+    fflush(file);
+  }
+  return true;
+}
+
+uint32_t flash_size() {
+  return (file != NULL) ? FLASH_EMULATOR_SIZE : 0;
+}
+
+bool flash_read(uint32_t offset, void *dest, size_t len) {
+  if (offset + len > FLASH_EMULATOR_SIZE) {
+    return false;
+  }
+  fseek(file, offset, SEEK_SET);
+  return fread(dest, 1, len, file) == len;
+}
+
+bool flash_write(uint32_t offset, const void *src, size_t len) {
+  uint8_t current[FLASH_PAGE_SIZE];
+  const uint8_t *data = (const uint8_t *)src;
+
+  while (len > 0) {
+    size_t chunk = (len < sizeof(current)) ? len : sizeof(current);
+    bool cut = writeBudget >= 0 && (size_t)writeBudget < chunk;
+    if (cut) {
+      chunk = writeBudget;
+    }
+    if (!flash_read(offset, current, chunk)) {
+      return false;
+    }
+    for (size_t i = 0; i < chunk; ++i) {
+      current[i] &= data[i];
+    }
+    fseek(file, offset, SEEK_SET);
+    fwrite(current, 1, chunk, file);
+    if (writeBudget >= 0) {
+      writeBudget -= chunk;
+    }
+    if (cut) {
+      fflush(file);
+      return false;
+    }
+    offset += chunk;
+    data += chunk;
+    len -= chunk;
+  }
+  fflush(file);
+  return true;
+}
+
+bool flash_erase_sector(uint32_t sector) {
+  uint8_t erased[FLASH_SECTOR_SIZE];
+
+  if ((sector + 1) * FLASH_SECTOR_SIZE > FLASH_EMULATOR_SIZE || writeBudget == 0) {
+    return false;
+  }
+  memset(erased, 0xFF, sizeof(erased));
+  fseek(file, sector * FLASH_SECTOR_SIZE, SEEK_SET);
+  fwrite(erased, 1, sizeof(erased), file);
+  fflush(file);
+  return true;
+}
+
+#endif
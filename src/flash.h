@@ -0,0 +1,36 @@
+#ifndef FLASH_H
+#define FLASH_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* PARAMETRY FLASH */
+
+#define FLASH_SECTOR_SIZE 4096
+#define FLASH_PAGE_SIZE 256
+
+// oddil flash vyhrazeny pro log mereni (viz partitions.csv)
+#define FLASH_PARTITION_LABEL "cgmlog"
+
+// emulace flash souborem pri prekladu mimo Arduino (testovani na PC)
+#define FLASH_EMULATOR_FILE "cgmlog.bin"
+#define FLASH_EMULATOR_SIZE 0x170000
+
+
+/* FUNKCE FLASH */
+
+bool flash_init();
+
+uint32_t flash_size();
+
+bool flash_read(uint32_t offset, void *dest, size_t len);
+
+bool flash_write(uint32_t offset, const void *src, size_t len);
+
+bool flash_erase_sector(uint32_t sector);
+
+#ifndef ARDUINO
+void flash_emulator_fail_after(int32_t bytes);
+#endif
+
+#endif
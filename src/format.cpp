@@ -0,0 +1,75 @@
+#include <stdio.h>
+
+#include "bytes.h"
+#include "format.h"
+
+// rozsah 12bitove mantisy SFLOAT, krajni hodnoty jsou vyhrazene (NaN, +-INF, NRes)
+#define SFLOAT_MANTISSA_MAX 2045
+#define SFLOAT_MANTISSA_MIN -2045
+#define SFLOAT_EXPONENT_MAX 7
+
+// podil zaokrouhleny od nuly
+static int64_t divideRounded(int64_t dividend, int64_t divisor) {
+  return (dividend + ((dividend >= 0) ? divisor / 2 : -divisor / 2)) / divisor;
+}
+
+/**
+ * @brief zakoduje hodnotu mantissa * 10^exponent jako SFLOAT (IEEE 11073), pri
+ * preteceni mantisy snizi presnost o potrebny pocet radu (zaokrouhluje se jednou
+ * z puvodni hodnoty), hodnotu mimo rozsah zakoduje jako +-INF
+ * 
+ */
+uint16_t format_sfloat(int32_t mantissa, int8_t exponent) {
+  int64_t rounded = mantissa;
+  int64_t divisor = 1;
+
+  while ((rounded > SFLOAT_MANTISSA_MAX || rounded < SFLOAT_MANTISSA_MIN) && exponent < SFLOAT_EXPONENT_MAX) {
+    divisor *= 10;
+    exponent++;
+    rounded = divideRounded(mantissa, divisor);
+  }
+  if (rounded > SFLOAT_MANTISSA_MAX) {
+    return FORMAT_SFLOAT_POSITIVE_INFINITY;
+  }
+  if (rounded < SFLOAT_MANTISSA_MIN) {
+    return FORMAT_SFLOAT_NEGATIVE_INFINITY;
+  }
+  return (uint16_t)(((exponent & 0x0F) << 12) | (rounded & 0x0FFF));
+}
+
+// mmol/l * 100 na mg/dl * 10 se zaokrouhlenim
+static int32_t toTenthsMgDl(int32_t value) {
+  return (int32_t)divideRounded((int64_t)value * FORMAT_TENTHS_MG_DL_SCALE, FORMAT_TENTHS_MG_DL_DIVISOR);
+}
+
+size_t format_ascii(CGMeasurement measurement, char *dest) {
+  return sprintf(dest, "%10d|%4d", measurement.timeOffset, measurement.glucoseValue);
+}
+
+/**
+ * @brief zakoduje mereni jako binarni zaznam CGM Measurement
+ * 
+ * @param measurement mereni
+ * @param previous predchozi mereni pro vypocet trendu, NULL pokud neni k dispozici
+ * @param dest buffer o velikosti alespon FORMAT_BINARY_MAX_SIZE
+ * @return delka zaznamu
+ */
+size_t format_binary(CGMeasurement measurement, const CGMeasurement *previous, uint8_t *dest) {
+  size_t len = FORMAT_BINARY_SIZE;
+  uint8_t flags = 0;
+
+  putLE(dest + 2, format_sfloat(toTenthsMgDl(measurement.glucoseValue), -1), 2);
+  putLE(dest + 4, (uint32_t)measurement.timeOffset, 4);
+
+  if (previous != NULL && measurement.timeOffset > previous->timeOffset) {
+    // (mg/dl * 10) / min * 10 = setiny mg/dl za minutu
+    int32_t change = toTenthsMgDl(measurement.glucoseValue - previous->glucoseValue) * 600;
+    putLE(dest + len, format_sfloat((int32_t)divideRounded(change, measurement.timeOffset - previous->timeOffset), -2), 2);
+    len += 2;
+    flags |= FORMAT_FLAG_TREND;
+  }
+
+  dest[0] = (uint8_t)len;
+  dest[1] = flags;
+  return len;
+}
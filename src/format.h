@@ -0,0 +1,45 @@
+#ifndef FORMAT_H
+#define FORMAT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "measurement.h"
+
+/* FORMATY ZAZNAMU MERENI */
+
+enum MeasurementFormat {FORMAT_ASCII, FORMAT_BINARY};
+
+// textovy zaznam "%10d|%4d"
+#define FORMAT_ASCII_SIZE 15
+
+/**
+ * Binarni zaznam podle CGM Measurement (sluzba CGM, little-endian): velikost,
+ * priznaky, koncentrace glukozy (SFLOAT, mg/dl), casovy posun a volitelne trend
+ * (SFLOAT, mg/dl/min). Na rozdil od standardu (uint16 v minutach) je casovy posun
+ * uint32 v sekundach, aby odpovidal casu, ktery klient zapisuje k navazani.
+ */
+#define FORMAT_FLAG_TREND 0x01
+#define FORMAT_BINARY_SIZE 8
+#define FORMAT_BINARY_MAX_SIZE (FORMAT_BINARY_SIZE + 2)
+
+// vyhrazene hodnoty SFLOAT
+#define FORMAT_SFLOAT_NAN 0x07FF
+#define FORMAT_SFLOAT_NRES 0x0800
+#define FORMAT_SFLOAT_POSITIVE_INFINITY 0x07FE
+#define FORMAT_SFLOAT_NEGATIVE_INFINITY 0x0802
+#define FORMAT_SFLOAT_RESERVED 0x0801
+
+// prevod mmol/l * 100 na mg/dl * 10 - nasobek 1.8016 vyjadreny v desetitisicinach
+#define FORMAT_TENTHS_MG_DL_SCALE 18016
+#define FORMAT_TENTHS_MG_DL_DIVISOR 10000
+
+
+/* FUNKCE FORMATU */
+
+uint16_t format_sfloat(int32_t mantissa, int8_t exponent);
+
+size_t format_ascii(CGMeasurement measurement, char *dest);
+
+size_t format_binary(CGMeasurement measurement, const CGMeasurement *previous, uint8_t *dest);
+
+#endif
@@ -0,0 +1,194 @@
+#include <string.h>
+#include <algorithm>
+#include <CircularBuffer.h>
+
+#include "bytes.h"
+#include "history.h"
+
+static_assert(sizeof(HistoryBlock) == HISTORY_BLOCK_SIZE, "hlavicka bloku musi mit HISTORY_HEADER_SIZE bajtu");
+
+// kruhovy zasobnik bloku, nejstarsi blok se pri zaplneni prepisuje
+static CircularBuffer<HistoryBlock, HISTORY_BLOCKS> blocks;
+static uint32_t sampleCount = 0;
+
+// stav koderu otevreneho (posledniho) bloku
+static int32_t lastTime;
+static int32_t lastValue;
+static int32_t lastInterval;
+
+static HistoryBlock *blockAt(uint32_t position) {
+  return &blocks.at(position);
+}
+
+static uint8_t putVarint(uint8_t *dest, uint64_t n) {
+  uint8_t len = 0;
+  while (n >= 0x80) {
+    dest[len++] = (uint8_t)n | 0x80;
+    n >>= 7;
+  }
+  dest[len++] = (uint8_t)n;
+  return len;
+}
+
+static uint64_t getVarint(const uint8_t *src, uint8_t *position) {
+  uint64_t n = 0;
+  uint8_t shift = 0;
+  uint8_t byte;
+  do {
+    byte = src[(*position)++];
+    n |= (uint64_t)(byte & 0x7F) << shift;
+    shift += 7;
+  } while (byte & 0x80);
+  return n;
+}
+
+static void openBlock(CGMeasurement measurement) {
+  HistoryBlock block;
+
+  if (blocks.isFull()) {
+    sampleCount -= blocks.at(0).count;
+  }
+  block.baseTime = measurement.timeOffset;
+  block.baseValue = measurement.glucoseValue;
+  block.baseInterval = (int16_t)lastInterval;
+  block.count = 1;
+  block.used = 0;
+  blocks.push(block);
+}
+
+static void loadBlock(HistoryReader *reader, uint32_t position) {
+  HistoryBlock *block = blockAt(position);
+  reader->block = position;
+  reader->position = 0;
+  reader->remaining = block->count;
+  reader->time = block->baseTime;
+  reader->value = block->baseValue;
+  reader->interval = block->baseInterval;
+}
+
+/**
+ * @brief prida mereni na konec historie
+ * 
+ * @param measurement mereni s casem novejsim nez posledni mereni v historii
+ */
+void history_push(CGMeasurement measurement) {
+  uint8_t encoded[15];
+  uint8_t len = 0;
+
+  if (!blocks.isEmpty()) {
+    int64_t interval = (int64_t)measurement.timeOffset - lastTime;
+    int64_t change = interval - lastInterval;
+    uint64_t head = (zigzag((int64_t)measurement.glucoseValue - lastValue) << 1) | (change != 0);
+
+    len = putVarint(encoded, head);
+    if (change != 0) {
+      len += putVarint(encoded + len, zigzag(change));
+    }
+
+    HistoryBlock *block = blockAt(blocks.size() - 1);
+    if (block->used + len <= HISTORY_DATA_SIZE && block->count < UINT8_MAX) {
+      memcpy(block->data + block->used, encoded, len);
+      block->used += len;
+      block->count++;
+    }
+    else {
+      len = 0;
+    }
+    lastInterval = (int32_t)interval;
+  }
+
+  if (len == 0) {
+    if (lastInterval < INT16_MIN || lastInterval > INT16_MAX) {
+      lastInterval = 0;
+    }
+    openBlock(measurement);
+  }
+  lastTime = measurement.timeOffset;
+  lastValue = measurement.glucoseValue;
+  sampleCount++;
+}
+
+/**
+ * @brief vyprazdni historii, napr. pri zahajeni nove relace
+ * 
+ */
+void history_clear() {
+  blocks.clear();
+  sampleCount = 0;
+  lastInterval = 0;
+}
+
+/**
+ * @brief nastavi ctenar na prvni mereni novejsi nez zadany cas
+ * 
+ * Blok se najde pulenim podle casu v hlavickach, uvnitr bloku se dekoduje sekvencne.
+ */
+void history_reader_seek(HistoryReader *reader, int32_t time) {
+  uint32_t low = std::upper_bound(blocks.begin(), blocks.end(), time, [](int32_t time, const HistoryBlock &block) {
+    return time < block.baseTime;
+  }) - blocks.begin();
+
+  reader->block = (low > 0) ? low - 1 : 0;
+  reader->remaining = 0;
+  if (blocks.isEmpty()) {
+    return;
+  }
+  loadBlock(reader, reader->block);
+
+  // preskoceni mereni, ktera nejsou novejsi nez zadany cas
+  while (reader->remaining > 0 && reader->time <= time) {
+    CGMeasurement skipped;
+    history_reader_next(reader, &skipped);
+  }
+}
+
+/**
+ * @brief vrati mereni na pozici ctenare a posune ctenar na dalsi mereni
+ * 
+ * @return false ctenar je na konci historie
+ */
+bool history_reader_next(HistoryReader *reader, CGMeasurement *measurement) {
+  if (reader->remaining == 0) {
+    if (reader->block + 1 >= blocks.size()) {
+      return false;
+    }
+    loadBlock(reader, reader->block + 1);
+  }
+
+  *measurement = CGMeasurement{reader->time, reader->value};
+
+  // dekodovani nasledujiciho mereni v bloku
+  if (--reader->remaining > 0) {
+    const uint8_t *data = blockAt(reader->block)->data;
+    uint64_t head = getVarint(data, &reader->position);
+    if (head & 1) {
+      reader->interval += (int32_t)unzigzag(getVarint(data, &reader->position));
+    }
+    reader->time += reader->interval;
+    reader->value += (int32_t)unzigzag(head >> 1);
+  }
+  return true;
+}
+
+/**
+ * @brief najde v historii prvni mereni nasledujici po zadanem case
+ * 
+ * @param time cas posledniho mereni, ktere ma klient k dispozici
+ * @param measurement nalezene mereni
+ * @return true nasledujici mereni bylo nalezeno
+ * @return false zadne nasledujici mereni neni k dispozici
+ */
+bool history_find_after(int32_t time, CGMeasurement *measurement) {
+  HistoryReader reader;
+
+  history_reader_seek(&reader, time);
+  return history_reader_next(&reader, measurement);
+}
+
+int32_t history_first_time() {
+  return !blocks.isEmpty() ? blockAt(0)->baseTime : INT32_MAX;
+}
+
+uint32_t history_size() {
+  return sampleCount;
+}
@@ -0,0 +1,55 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <stdint.h>
+#include "measurement.h"
+
+/* PARAMETRY KOMPRIMOVANE HISTORIE */
+
+#define HISTORY_BLOCK_SIZE 64
+#define HISTORY_BLOCKS 64
+#define HISTORY_HEADER_SIZE 12
+#define HISTORY_DATA_SIZE (HISTORY_BLOCK_SIZE - HISTORY_HEADER_SIZE)
+
+/**
+ * Blok historie - prvni mereni je v hlavicce, dalsi mereni jsou zakodovana jako
+ * rozdily proti predchozimu mereni (zigzag + varint). Bit 0 prvniho varintu udava,
+ * zda se zmenil casovy krok; pokud ne, mereni zabira obvykle jediny bajt.
+ */
+struct HistoryBlock {
+  int32_t baseTime;
+  int32_t baseValue;
+  int16_t baseInterval;
+  uint8_t count;
+  uint8_t used;
+  uint8_t data[HISTORY_DATA_SIZE];
+};
+
+// stav sekvencniho dekodovani historie
+struct HistoryReader {
+  uint32_t block;
+  uint8_t position;
+  uint8_t remaining;
+  int32_t time;
+  int32_t value;
+  int32_t interval;
+};
+
+
+/* FUNKCE KOMPRIMOVANE HISTORIE */
+
+void history_push(CGMeasurement measurement);
+
+void history_clear();
+
+bool history_find_after(int32_t time, CGMeasurement *measurement);
+
+int32_t history_first_time();
+
+uint32_t history_size();
+
+void history_reader_seek(HistoryReader *reader, int32_t time);
+
+bool history_reader_next(HistoryReader *reader, CGMeasurement *measurement);
+
+#endif
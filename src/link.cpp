@@ -0,0 +1,168 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "link.h"
+
+#ifdef ARDUINO
+#include <esp_gap_ble_api.h>
+#endif
+
+static const LinkParams requested[LINK_PHASES] = { LINK_PARAMS_IDLE, LINK_PARAMS_PAIRING, LINK_PARAMS_TRANSFER };
+
+// metriky fazi secitane pres vsechna spojeni
+static LinkMetrics metrics[LINK_PHASES];
+
+static bool requestParams(const Link *link, const LinkParams &params) {
+#ifdef ARDUINO
+  esp_ble_conn_update_params_t update;
+  memcpy(update.bda, link->peer, sizeof(link->peer));
+  update.min_int = params.minInterval;
+  update.max_int = params.maxInterval;
+  update.latency = params.latency;
+  update.timeout = params.timeout;
+  return esp_ble_gap_update_conn_params(&update) == ESP_OK;
+#else
+  return true;
+#endif
+}
+
+// zapocita dobu ve fazi a odhad doby vysilani prazdnych udalosti spojeni; zbytek
+// neuplne udalosti (us) se prenasi do dalsiho zapocteni
+static void closePhase(Link *link, uint32_t now) {
+  uint32_t elapsed = now - link->phaseStart;
+  metrics[link->phase].duration += elapsed;
+  if (link->interval > 0) {
+    // periferie s vynechanim udalosti (latency) se probouzi jen v kazde (latency + 1). udalosti
+    uint64_t period = link->interval * 1250u * (link->latency + 1u);
+    uint64_t awake = (uint64_t)elapsed * 1000 + link->eventRemainder;
+    metrics[link->phase].airtime += awake / period * LINK_EVENT_AIRTIME;
+    link->eventRemainder = awake % period;
+  }
+  link->phaseStart = now;
+}
+
+void link_connect(Link *link, const uint8_t *address, uint32_t now) {
+  memcpy(link->peer, address, sizeof(link->peer));
+  link->connected = true;
+  link->phase = LINK_IDLE;
+  link->phaseStart = now;
+  link->interval = 0;
+  link->latency = 0;
+  link->timeout = 0;
+  link->eventRemainder = 0;
+}
+
+void link_disconnect(Link *link, uint32_t now) {
+  if (link->connected) {
+    closePhase(link, now);
+  }
+  link->connected = false;
+}
+
+/**
+ * @brief zjisti, zda udalost GAP s adresou protistrany patri k tomuto spojeni
+ * 
+ */
+bool link_matches(const Link *link, const uint8_t *address) {
+  return link->connected && memcmp(link->peer, address, sizeof(link->peer)) == 0;
+}
+
+/**
+ * @brief prepne fazi spojeni a pri zmene pozada o jeji parametry spojeni
+ * 
+ * @param link spojeni
+ * @param next nova faze
+ * @param now aktualni cas (ms)
+ * @return true pozadavek na zmenu parametru byl odeslan
+ */
+bool link_set_phase(Link *link, LinkPhase next, uint32_t now) {
+  if (!link->connected || next == link->phase) {
+    return false;
+  }
+  closePhase(link, now);
+  link->phase = next;
+  return requestParams(link, requested[next]);
+}
+
+/**
+ * @brief zaznamena parametry prijate centralnim zarizenim (udalost GAP) - dosavadni doba
+ * ve fazi se zapocita jeste s puvodnimi parametry
+ * 
+ */
+void link_params_updated(Link *link, uint16_t acceptedInterval, uint16_t acceptedLatency, uint16_t acceptedTimeout, uint32_t now) {
+  if (link->connected) {
+    closePhase(link, now);
+  }
+  link->eventRemainder = 0;
+  link->interval = acceptedInterval;
+  link->latency = acceptedLatency;
+  link->timeout = acceptedTimeout;
+}
+
+/**
+ * @brief zapocita dosavadni dobu probihajici faze, prehled metrik ji tak zahrnuje
+ * 
+ * @param link spojeni
+ * @param now aktualni cas (ms)
+ */
+void link_flush(Link *link, uint32_t now) {
+  if (link->connected) {
+    closePhase(link, now);
+  }
+}
+
+/**
+ * @brief zapocita odeslanou notifikaci do aktualni faze spojeni
+ * 
+ * @param link spojeni
+ * @param bytes delka hodnoty notifikace
+ */
+void link_count(Link *link, size_t bytes) {
+  metrics[link->phase].bytes += bytes;
+  metrics[link->phase].packets++;
+  metrics[link->phase].airtime += (bytes + LINK_PACKET_OVERHEAD) * LINK_BYTE_AIRTIME;
+}
+
+LinkPhase link_phase(const Link *link) {
+  return link->phase;
+}
+
+uint16_t link_interval(const Link *link) {
+  return link->interval;
+}
+
+bool link_metrics(LinkPhase which, LinkMetrics *result) {
+  if (which >= LINK_PHASES) {
+    return false;
+  }
+  *result = metrics[which];
+  return true;
+}
+
+/**
+ * @brief textovy prehled fazi vsech spojeni "doba ms|propustnost B/s|strida vysilani
+ * v setinach procenta" oddeleny strednikem
+ * 
+ * @return delka textu
+ */
+size_t link_report(char *dest, size_t len) {
+  int written = 0;
+
+  for (uint8_t i = 0; i < LINK_PHASES && written >= 0 && (size_t)written < len; ++i) {
+    uint32_t duration = metrics[i].duration;
+    uint32_t throughput = (duration > 0) ? (uint32_t)((uint64_t)metrics[i].bytes * 1000 / duration) : 0;
+    uint32_t duty = (duration > 0) ? (uint32_t)(metrics[i].airtime * 10 / duration) : 0;
+    written += snprintf(dest + written, len - written, (i == 0) ? "%u|%u|%u" : ";%u|%u|%u", duration, throughput, duty);
+  }
+  return (written > 0 && (size_t)written < len) ? written : 0;
+}
+
+/**
+ * @brief textovy prehled prijatych parametru spojeni "interval|latency|timeout"
+ * 
+ * @return delka textu
+ */
+size_t link_params_report(const Link *link, char *dest, size_t len) {
+  int written = snprintf(dest, len, "%u|%u|%u", link->interval, link->latency, link->timeout);
+  return (written > 0 && (size_t)written < len) ? written : 0;
+}
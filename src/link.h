@@ -0,0 +1,81 @@
+#ifndef LINK_H
+#define LINK_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* PARAMETRY SPOJENI */
+
+// faze spojeni, kazda ma vlastni pozadovane parametry spojeni
+enum LinkPhase {LINK_IDLE, LINK_PAIRING, LINK_TRANSFER};
+
+#define LINK_PHASES 3
+
+// interval v jednotkach 1.25 ms, timeout v jednotkach 10 ms
+struct LinkParams {
+  uint16_t minInterval;
+  uint16_t maxInterval;
+  uint16_t latency;
+  uint16_t timeout;
+};
+
+// necinnost - dlouhy interval s vynechanim udalosti; parovani - kazdy krok handshaku je
+// jedna vymena zapis/cteni, staci interval 15-30 ms; prenos - nejkratsi povoleny interval
+// 7.5 ms, kazda udalost spojeni nese dalsi notifikace
+#define LINK_PARAMS_IDLE { 160, 320, 4, 600 }
+#define LINK_PARAMS_PAIRING { 12, 24, 0, 400 }
+#define LINK_PARAMS_TRANSFER { 6, 12, 0, 400 }
+
+// odhad doby vysilani (us) - prazdna vymena v udalosti spojeni a bajt paketu na 1M PHY
+#define LINK_EVENT_AIRTIME 380
+#define LINK_PACKET_OVERHEAD 14
+#define LINK_BYTE_AIRTIME 8
+
+// stav jednoho spojeni - adresa protistrany, faze a parametry, ktere centralni zarizeni
+// skutecne prijalo (0 = zatim nezname)
+struct Link {
+  bool connected;
+  uint8_t peer[6];
+  LinkPhase phase;
+  uint32_t phaseStart;
+  uint16_t interval;
+  uint16_t latency;
+  uint16_t timeout;
+  uint32_t eventRemainder;
+};
+
+struct LinkMetrics {
+  uint32_t duration;
+  uint32_t bytes;
+  uint32_t packets;
+  uint64_t airtime;
+};
+
+
+/* FUNKCE SPOJENI */
+
+void link_connect(Link *link, const uint8_t *address, uint32_t now);
+
+void link_disconnect(Link *link, uint32_t now);
+
+bool link_matches(const Link *link, const uint8_t *address);
+
+bool link_set_phase(Link *link, LinkPhase phase, uint32_t now);
+
+void link_params_updated(Link *link, uint16_t interval, uint16_t latency, uint16_t timeout, uint32_t now);
+
+void link_flush(Link *link, uint32_t now);
+
+void link_count(Link *link, size_t bytes);
+
+LinkPhase link_phase(const Link *link);
+
+uint16_t link_interval(const Link *link);
+
+bool link_metrics(LinkPhase phase, LinkMetrics *metrics);
+
+size_t link_report(char *dest, size_t len);
+
+size_t link_params_report(const Link *link, char *dest, size_t len);
+
+#endif
@@ -0,0 +1,175 @@
+#include <stddef.h>
+#include "lttb.h"
+
+static LttbSource lttbSource = NULL;
+
+static void clearBucket(LttbBucket *bucket) {
+  bucket->count = 0;
+  bucket->sumTime = 0;
+  bucket->sumValue = 0;
+}
+
+/**
+ * @brief zaradi mereni do intervalu - posune konec jeho rozsahu a pricte je k souctum
+ * 
+ */
+static void addToBucket(LttbBucket *bucket, uint32_t index, CGMeasurement measurement) {
+  if (bucket->count == 0) {
+    bucket->index = index;
+    bucket->firstTime = measurement.timeOffset;
+  }
+  bucket->lastTime = measurement.timeOffset;
+  bucket->count++;
+  bucket->sumTime += measurement.timeOffset;
+  bucket->sumValue += measurement.glucoseValue;
+}
+
+/**
+ * @brief znovu projde mereni intervalu a vybere to s nejvetsi plochou trojuhelniku
+ * s predchozim vybranym bodem a bodem c (prumer nasledujiciho intervalu nebo posledni
+ * mereni); pri shode plochy vyhrava starsi mereni
+ * 
+ */
+static CGMeasurement selectPoint(const LttbBucket *bucket, CGMeasurement a, int64_t cTime, int64_t cValue) {
+  CGMeasurement best = {bucket->firstTime, 0};
+  CGMeasurement b;
+  int64_t bestArea = -1;
+
+  for (int32_t time = bucket->firstTime - 1; lttbSource(time, &b) && b.timeOffset <= bucket->lastTime; time = b.timeOffset) {
+    int64_t area = (int64_t)(b.timeOffset - a.timeOffset) * (cValue - a.glucoseValue) - (int64_t)(b.glucoseValue - a.glucoseValue) * (cTime - a.timeOffset);
+    if (area < 0) {
+      area = -area;
+    }
+    if (area > bestArea) {
+      bestArea = area;
+      best = b;
+    }
+  }
+  return best;
+}
+
+// index vnitrniho intervalu - casovy usek od prvniho mereni do konce dotazu rozdeleny na points - 2 dilu
+static uint32_t bucketOf(const LttbQuery *query, int32_t time) {
+  int64_t span = (int64_t)query->to - query->from + 1;
+  return (uint32_t)(((int64_t)time - query->from) * (query->points - 2) / span);
+}
+
+/**
+ * @brief nastavi zdroj mereni pro dotazy
+ * 
+ * @param source funkce vracejici prvni mereni novejsi nez zadany cas
+ */
+void lttb_init(LttbSource source) {
+  lttbSource = source;
+}
+
+/**
+ * @brief zahaji dotaz nad uzavrenym casovym intervalem
+ * 
+ * @param query stav dotazu
+ * @param from pocatek intervalu
+ * @param to konec intervalu
+ * @param points pocet bodu, alespon 3 a nejvyse LTTB_MAX_POINTS
+ * @return false neplatny interval nebo pocet bodu
+ */
+bool lttb_start(LttbQuery *query, int32_t from, int32_t to, uint16_t points) {
+  if (from > to || points < 3 || points > LTTB_MAX_POINTS) {
+    return false;
+  }
+  query->from = from;
+  query->to = to;
+  query->points = points;
+  query->cursor = from - 1;
+  query->started = false;
+  query->exhausted = false;
+  query->finished = false;
+  query->hasPending = false;
+  clearBucket(&query->current);
+  clearBucket(&query->next);
+  return true;
+}
+
+/**
+ * @brief vrati dalsi bod grafu - prvni mereni, vybrane body intervalu a posledni mereni
+ * 
+ * Posledni prectene mereni se do intervalu zaradi az s dalsim merenim, aby konec
+ * dotazu zustal samostatnym bodem.
+ * 
+ * @param query stav dotazu
+ * @param point dalsi bod
+ * @return false dotaz je u konce
+ */
+bool lttb_next(LttbQuery *query, CGMeasurement *point) {
+  CGMeasurement measurement;
+
+  while (!query->finished) {
+    if (!query->exhausted) {
+      if (!lttbSource(query->cursor, &measurement) || measurement.timeOffset > query->to) {
+        query->exhausted = true;
+        continue;
+      }
+      query->cursor = measurement.timeOffset;
+
+      if (!query->started) {
+        query->started = true;
+        query->from = measurement.timeOffset;
+        query->selected = measurement;
+        *point = measurement;
+        return true;
+      }
+      if (!query->hasPending) {
+        query->pending = measurement;
+        query->hasPending = true;
+        continue;
+      }
+
+      CGMeasurement added = query->pending;
+      query->pending = measurement;
+      uint32_t index = bucketOf(query, added.timeOffset);
+      if (query->next.count == 0 || index == query->next.index) {
+        addToBucket(&query->next, index, added);
+        continue;
+      }
+
+      // zaznam patri do dalsiho intervalu - nasledujici interval je uzavren a bod
+      // aktualniho lze vybrat podle jeho prumeru
+      bool selected = query->current.count > 0;
+      if (selected) {
+        query->selected = selectPoint(&query->current, query->selected, query->next.sumTime / query->next.count, query->next.sumValue / query->next.count);
+      }
+      query->current = query->next;
+      clearBucket(&query->next);
+      addToBucket(&query->next, index, added);
+      if (selected) {
+        *point = query->selected;
+        return true;
+      }
+      continue;
+    }
+
+    // zdroj je vycerpan - dovyberou se zbyvajici intervaly a posledni mereni
+    if (query->current.count > 0) {
+      if (query->next.count > 0) {
+        query->selected = selectPoint(&query->current, query->selected, query->next.sumTime / query->next.count, query->next.sumValue / query->next.count);
+      }
+      else {
+        query->selected = selectPoint(&query->current, query->selected, query->pending.timeOffset, query->pending.glucoseValue);
+      }
+      query->current = query->next;
+      clearBucket(&query->next);
+      *point = query->selected;
+      return true;
+    }
+    if (query->next.count > 0) {
+      query->current = query->next;
+      clearBucket(&query->next);
+      continue;
+    }
+    query->finished = true;
+    if (query->hasPending) {
+      *point = query->pending;
+      return true;
+    }
+  }
+  return false;
+}
@@ -0,0 +1,55 @@
+#ifndef LTTB_H
+#define LTTB_H
+
+#include <stdint.h>
+#include "measurement.h"
+
+/* PARAMETRY PODVZORKOVANI PRO GRAF */
+
+// nejvetsi pocet bodu jednoho dotazu
+#define LTTB_MAX_POINTS 1000
+
+// zdroj mereni pro dotaz - prvni mereni novejsi nez time
+typedef bool (*LttbSource)(int32_t time, CGMeasurement *measurement);
+
+// interval drzi jen svuj casovy rozsah a soucty pro prumer, body se pri vyberu ctou znovu
+struct LttbBucket {
+  uint32_t index;
+  int32_t firstTime;
+  int32_t lastTime;
+  uint32_t count;
+  int64_t sumTime;
+  int64_t sumValue;
+};
+
+/**
+ * Dotaz Largest-Triangle-Three-Buckets nad casovym intervalem. Mereni se ctou
+ * jednim pruchodem, z kazdeho intervalu se drzi jen rozsah a soucty pro prumer,
+ * pamet je tedy pevna. Jakmile je znam prumer nasledujiciho intervalu, mereni
+ * aktualniho se prectou ze zdroje znovu a vybere se presne to s nejvetsi plochou.
+ */
+struct LttbQuery {
+  int32_t from;
+  int32_t to;
+  uint16_t points;
+  int32_t cursor;
+  bool started;
+  bool exhausted;
+  bool finished;
+  CGMeasurement selected;
+  CGMeasurement pending;
+  bool hasPending;
+  LttbBucket current;
+  LttbBucket next;
+};
+
+
+/* FUNKCE PODVZORKOVANI */
+
+void lttb_init(LttbSource source);
+
+bool lttb_start(LttbQuery *query, int32_t from, int32_t to, uint16_t points);
+
+bool lttb_next(LttbQuery *query, CGMeasurement *point);
+
+#endif
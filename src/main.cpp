@@ -1,174 +1,1637 @@
+#include <atomic>
 #include <Arduino.h>
 #include <BLEDevice.h>
 #include <BLE2902.h>
 #include <SSD1306.h>
-#include <CircularBuffer.h>
 
 #include "aes.h"
+#include "agp.h"
+#include "backfill.h"
+#include "beacon.h"
+#include "client.h"
+#include "format.h"
+#include "history.h"
+#include "link.h"
+#include "lttb.h"
+#include "measurement.h"
+#include "mlog.h"
+#include "packed.h"
+#include "racp.h"
 #include "rng.h"
+#include "rollup.h"
+#include "sdt.h"
+#include "session.h"
+#include "spsc.h"
+#include "stats.h"
+#include "status.h"
 #include "uuid.h"
 
 #define SENSOR_BLE_NAME "CGM Sensor"
 
+// pocet handlu sluzby CGM - sluzba 1, kazda charakteristika 2, kazdy deskriptor 1
+// (14 charakteristik vcetne zabezpeceni a 5 deskriptoru v kompaktnim rozlozeni = 34)
+#define CGM_SERVICE_HANDLES 34
+
+// vychozi a nejvetsi ATT MTU a velikost hlavicky notifikace
+#define BLE_DEFAULT_MTU 23
+#define BLE_MTU 517
+#define ATT_HEADER_SIZE 3
+
+// pocet notifikaci odeslanych za sebou v jednom pruchodu smyckou
+#define BACKFILL_BURST 8
+#define BACKFILL_PAUSE 10
+
+// pocet notifikaci odeslanych za sebou v jednom pruchodu smyckou pri streamovani
+#define STREAM_BURST 8
+
 #define DEFAULT_CGM_INTERVAL 5
 
-#define INVALID_TIME -1
-#define INVALID_TIME_STR "-1"
+#define INVALID_TIME -1
+#define INVALID_TIME_STR "-1"
+
+#define DH_COMMON_G 2
+#define DH_COMMON_P 19
+
+#define PIN_OLED_SDA 4
+#define PIN_OLED_SCL 15
+#define PIN_OLED_RST 16
+#define PIN_LED_R 23
+#define PIN_POT_0 13
+
+#define PATIENT 1
+
+// dlouhodoba ztratova historie (swinging door) s odchylkou SDT_DEFAULT_DEVIATION - graf
+// z ni doplni obdobi, ktere uz log ve flash neobsahuje
+#define LOSSY_HISTORY 1
+
+// rychly start - nejdrive se spusti advertising, relace se obnovi z flash a uvodni
+// obrazovky se zobrazi bez cekani
+#define FAST_BOOT 1
+
+// vysilani posledniho mereni sifrovane v scan response pro sparovane prijemce bez spojeni;
+// vychozi vypnuto - klice se odvozuji z ukazkoveho Diffie-Hellmana modulo 19, kterych je
+// nejvyse 18 a kdokoli je vyzkousi, vysilani tedy data nechrani
+#define BEACON_BROADCAST 0
+
+// potvrzeni, mazani a zmena zacatku relace se do NVS ulozi az po odpojeni klienta, nejvyse
+// jednou za SESSION_PERSIST_PERIOD ms nebo po posunu potvrzeni o SESSION_PERSIST_SPAN
+// sekund mereni - zapis blokuje smycku a opotrebovava oddil NVS, pad pokryje kontrolni bod logu
+#define SESSION_PERSIST_PERIOD 60000
+#define SESSION_PERSIST_SPAN 600
+
+// kompaktni rozlozeni GATT - charakteristiky zabezpeceni lezi ve sluzbe CGM, klient tak
+// objevuje jedinou sluzbu; bez nej zustava samostatna sluzba zabezpeceni pro starsi klienty
+#define COMPACT_GATT 1
+
+// ladici vypisy (doby startu, stav logu) na seriovou linku - seriova linka nese
+// protokol simulatoru pacienta, vypisy jsou proto ve vychozim stavu vypnute
+#define SERIAL_DEBUG 0
+
+#define ACQUISITION_STACK_SIZE 4096
+
+// delka fronty udalosti a nejdelsi cekani hlavni smycky na udalost (ms)
+#define EVENT_QUEUE_LENGTH 24
+#define LOOP_PERIOD 1000
+
+// mista fronty vyhrazena pro pripojeni a odpojeni, ostatni udalosti je nezaberou
+#define EVENT_QUEUE_RESERVE (2 * CLIENT_MAX_CONNECTIONS)
+
+// objekt integrovaneho displeje
+SSD1306  display(0x3c, PIN_OLED_SDA, PIN_OLED_SCL);
+
+// zprava a interval naposledy vykreslene obrazovky
+char *screenMessage = NULL;
+int screenInterval = 0;
+
+// bitove pakovany buffer poslednich mereni, starsi mereni drzi komprimovana
+// historie v RAM a cela relace se uklada do logu ve flash (mlog)
+PackedSeries<64> buffer;
+CGMeasurement lastMeasurement;
+
+// fronta predavajici mereni z ulohy snimani do hlavni smycky
+SpscRing<CGMeasurement, 16> acquired;
+
+// pocet mereni zahozenych kvuli plne fronte nebo hodnote mimo rozsah bufferu,
+// zapocitavaji se do ztracenych mereni
+std::atomic<uint32_t> droppedMeasurements(0);
+
+// udalosti z callbacku BLE a ulohy snimani - hodnota zapisu se parsuje jen jednou,
+// hlavni smycka na udalosti ceka misto pevneho zpozdeni
+enum EventType {EVENT_MEASUREMENT, EVENT_CONNECT, EVENT_DISCONNECT, EVENT_TIME, EVENT_SECURITY, EVENT_SECURITY_VALUE, EVENT_BACKFILL, EVENT_FORMAT, EVENT_SUBSCRIBE, EVENT_RACP, EVENT_CHART, EVENT_ROLLUP, EVENT_AGP, EVENT_ACK, EVENT_READ, EVENT_CONGEST, EVENT_LINK_PARAMS};
+
+struct Event {
+  EventType type;
+  uint16_t connId;
+  int32_t value;
+  int32_t parameter;
+  int32_t bound;
+  uint8_t address[6];
+};
+
+QueueHandle_t events;
+
+// pocet udalosti zahozenych kvuli plne fronte, vypisuje se v metrikach spojeni
+std::atomic<uint32_t> droppedEvents(0);
+
+/**
+ * @brief preda udalost hlavni smycce
+ * 
+ * Pripojeni, odpojeni, zmena zahlceni a prijate parametry spojeni se nesmi ztratit -
+ * maji ve fronte vyhrazena mista a pri jejich vycerpani callback pocka, nez smycka
+ * frontu uvolni. Ostatni udalosti se pri zaplneni fronty zahodi a zapocitaji.
+ *
+ * @param address adresa protistrany (pripojeni a udalosti GAP, ktere conn_id nenesou)
+ */
+void postEvent(EventType type, uint16_t connId, int32_t value, int32_t parameter, int32_t bound = 0, const uint8_t *address = NULL) {
+  Event event = {type, connId, value, parameter, bound, {0}};
+
+  if (address != NULL) {
+    memcpy(event.address, address, sizeof(event.address));
+  }
+  if (type == EVENT_CONNECT || type == EVENT_DISCONNECT || type == EVENT_CONGEST || type == EVENT_LINK_PARAMS) {
+    xQueueSend(events, &event, portMAX_DELAY);
+  }
+  else if (uxQueueSpacesAvailable(events) <= EVENT_QUEUE_RESERVE || xQueueSend(events, &event, 0) != pdTRUE) {
+    droppedEvents++;
+  }
+}
+
+// snimek relace spojeni pro cteni charakteristik - zaznam mereni po kurzoru klienta
+// (cas zaznamu se po precteni preda smycce) a stavovy snimek
+struct ClientSnapshot {
+  bool active;
+  uint16_t connId;
+  State state;
+  SecurityState securityState;
+  uint32_t challenge;
+  MeasurementFormat format;
+  int32_t lastTime;
+  int32_t recordTime;
+  uint8_t record[FORMAT_ASCII_SIZE + 1];
+  size_t recordLen;
+  uint8_t status[STATUS_SIZE];
+  size_t statusLen;
+};
+
+// callbacky charakteristik bezi v uloze BT, relace a uloziste mereni vsak patri hlavni
+// smycce - cteni se proto obsluhuji ze snimku, ktery smycka publikuje pod zamkem
+struct Snapshot {
+  ClientSnapshot clients[CLIENT_MAX_CONNECTIONS];
+  char ack[24];
+  uint8_t agp[AGP_PACKED_SIZE];
+  size_t agpLen;
+  uint8_t stats[STATUS_STATS_SIZE];
+  size_t statsLen;
+  char metrics[192];
+};
+
+// snimek sestavovany smyckou a snimek publikovany pro callbacky
+Snapshot staged;
+Snapshot snapshot;
+portMUX_TYPE snapshotLock = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * @brief zkopiruje publikovany snimek relace spojeni
+ * 
+ * @return false spojeni nema relaci
+ */
+bool readClientSnapshot(uint16_t connId, ClientSnapshot *result) {
+  bool found = false;
+
+  portENTER_CRITICAL(&snapshotLock);
+  for (uint8_t i = 0; i < CLIENT_MAX_CONNECTIONS && !found; ++i) {
+    if (snapshot.clients[i].active && snapshot.clients[i].connId == connId) {
+      *result = snapshot.clients[i];
+      found = true;
+    }
+  }
+  portEXIT_CRITICAL(&snapshotLock);
+  return found;
+}
+
+// nazvy stavu relace (client.h) a podstavu pro sluzbu zabezpeceni
+char *stateStrings[5] = {"INIT", "SECURITY", "READ", "NOTIFY", "STREAM"};
+char *securityStateStrings[5] = {"PAIR", "PAIR", "AUTH", "AUTH", "READY"};
+char *securityStateValueStrings[5] = {"0", "1", "2", "3", "4"};
+
+/**
+ * @brief stav prvniho pripojeneho klienta k zobrazeni na displeji
+ * 
+ */
+char *getStateStr() {
+    Client *client = NULL;
+    for (uint8_t i = 0; i < CLIENT_MAX_CONNECTIONS && client == NULL; ++i) {
+        client = client_at(i);
+    }
+
+    if (client == NULL) {
+        return stateStrings[static_cast<int>(INIT)];
+    }
+    else if (client->state == SECURITY) {
+        return securityStateStrings[static_cast<int>(client->securityState)];
+    }
+    else {
+        return stateStrings[static_cast<int>(client->state)];
+    }
+}
+
+
+// BLE server, sluzby a jejich charakteristiky
+BLEServer *cgmServer;
+
+BLEService *cgmService;
+BLECharacteristic *cgmMeasurementCharacteristic;
+BLE2902 *cgmMeasurementNotifications;
+BLECharacteristic *cgmTimeCharacteristic;
+BLECharacteristic *cgmRollupCharacteristic;
+BLE2902 *cgmRollupNotifications;
+BLECharacteristic *cgmAckCharacteristic;
+BLECharacteristic *cgmAgpCharacteristic;
+BLECharacteristic *cgmFormatCharacteristic;
+BLECharacteristic *cgmBackfillCharacteristic;
+BLECharacteristic *cgmMetricsCharacteristic;
+BLECharacteristic *cgmStatsCharacteristic;
+BLE2902 *cgmBackfillNotifications;
+BLECharacteristic *cgmRacpCharacteristic;
+BLE2902 *cgmRacpNotifications;
+BLECharacteristic *cgmChartCharacteristic;
+BLE2902 *cgmChartNotifications;
+BLECharacteristic *cgmStatusCharacteristic;
+
+BLEService *securityService;
+BLECharacteristic *securityValueCharacteristic;
+BLECharacteristic *securityActionCharacteristic;
+
+char messageBuffer[64];
+
+// klice serveru pro parovani a sdileny klic posledniho sparovaneho klienta, kterym
+// se autentizuji nove relace; klice a kontrolni hodnoty relaci drzi Client
+uint32_t private_key;
+uint32_t server_public_key;
+uint32_t shared_key = 0;
+
+// klice vysilani odvozene ze sdileneho klice - po parovani nebo po obnoveni relace z flash
+BeaconKeys beaconKeys;
+bool beaconEnabled = false;
+
+// citac vysilani (nonce) a konec bloku hodnot ulozeneho ve flash - roste pres restarty
+// i nova parovani, protoze ukazkove sdilene klice se opakuji
+uint32_t beaconCounter = 0;
+uint32_t beaconReserved = 0;
+
+// promenne potenciometru k nastaveni intervalu mereni
+int pot_0;
+int cgm_interval = DEFAULT_CGM_INTERVAL;
+
+// cas behu zarizeni
+int timeSinceStart = 0;
+
+// posledni mereni potvrzene klienty - prezije odpojeni i restart a log ve flash
+// nepotvrzena mereni nepocita za dorucena; odeslana mereni si drzi kazda relace
+int32_t acknowledged = INVALID_TIME;
+
+// zaznamy do tohoto casu klient smazal kontrolnim bodem, klientum se uz neposilaji
+int32_t deleted = INVALID_TIME;
+
+// cas dne zacatku relace (timeOffset 0) v sekundach od pulnoci, zapise jej klient;
+// useky glykemickeho profilu se k nemu vztahuji
+int32_t agpOrigin = 0;
+
+// log ve flash odmitl posledni mereni (chyba zapisu), zobrazi se na displeji
+bool logError = false;
+
+// doba od startu do spusteni advertisingu a do prvni notifikace a doba obnoveni
+// agregaci z logu (us), uvadi se v metrikach
+unsigned long bootToAdvertising = 0;
+unsigned long bootToNotification = 0;
+unsigned long bootRebuild = 0;
+
+// relace v RAM se lisi od ulozene, cas posledniho ulozeni a ulozene potvrzeni
+bool sessionDirty = false;
+unsigned long sessionPersistedAt = 0;
+int32_t persistedAcknowledged = INVALID_TIME;
+
+/**
+ * @brief ulozi sdileny klic a kurzor potvrzeni, aby je relace po restartu obnovila
+ * 
+ */
+void persistSession() {
+  PersistedSession session = {SESSION_MAGIC, shared_key, acknowledged, deleted, agpOrigin, beaconReserved};
+  session_save(&session);
+  sessionDirty = false;
+  sessionPersistedAt = millis();
+  persistedAcknowledged = acknowledged;
+}
+
+/**
+ * @brief ulozi zmenenou relaci, pokud uplynula perioda ukladani nebo se potvrzeni
+ * posunulo o vice nez SESSION_PERSIST_SPAN sekund
+ * 
+ * @param force ulozit zmenenou relaci hned (odpojeni klienta)
+ */
+void flushSession(bool force) {
+  if (!sessionDirty) {
+    return;
+  }
+  if (force || millis() - sessionPersistedAt >= SESSION_PERSIST_PERIOD || acknowledged - persistedAcknowledged >= SESSION_PERSIST_SPAN) {
+    persistSession();
+  }
+}
+
+/**
+ * @brief obnovi sdileny klic a kurzor potvrzeni ulozene pred restartem
+ * 
+ * @return true ulozena relace byla nalezena
+ */
+bool restoreSession() {
+  PersistedSession session;
+
+  if (!session_load(&session)) {
+    return false;
+  }
+  shared_key = session.sharedKey;
+  acknowledged = session.acknowledged;
+  persistedAcknowledged = acknowledged;
+  deleted = session.deleted;
+  agpOrigin = session.agpOrigin;
+  return true;
+}
+
+/**
+ * @brief obnovi citac vysilani i bez obnoveni relace - pokracuje za celym blokem
+ * rezervovanym pred restartem, takze se zadna hodnota nepouzije dvakrat
+ * 
+ */
+void restoreBeaconCounter() {
+  PersistedSession session;
+
+  if (session_load(&session)) {
+    beaconReserved = session.beaconReserved;
+  }
+  beaconCounter = beaconReserved;
+}
+
+/**
+ * @brief funkce k vystaveni nahodne zpravy relaci ve stavu AUTH_0
+ * 
+ * @param client relace klienta
+ */
+void setAuthValue(Client *client) {
+  client->challenge = random_from_to(1, 100);
+  client->checkNum = client->challenge + client->sharedKey;
+  client->securityState = AUTH_0;
+}
+
+/**
+ * @brief nastavi sdileny klic relace a z nej odvozeny klic AES
+ * 
+ */
+void setSharedKey(Client *client, uint32_t key) {
+  client->sharedKey = key;
+  for (int i = 0; i < 4; ++i) {
+    client->aesKey[i] = key;
+  }
+}
+
+// callback funkce serveru - spojeni se predavaji hlavni smycce jako udalosti, relace
+// i stav spojeni zaklada a rusi az smycka
+class CGMServerCallbacks: public BLEServerCallbacks {
+    void onConnect(BLEServer* pServer, esp_ble_gatts_cb_param_t *param) {
+      postEvent(EVENT_CONNECT, param->connect.conn_id, 0, 0, 0, param->connect.remote_bda);
+    }
+
+    void onDisconnect(BLEServer* pServer, esp_ble_gatts_cb_param_t *param) {
+      postEvent(EVENT_DISCONNECT, param->disconnect.conn_id, 0, 0);
+    }
+};
+
+// callback funkce charakteristiky casu klienta
+class TimeCallbacks: public BLECharacteristicCallbacks {
+    /**
+     * @brief klient zapise cas posledniho mereni, ktere ma k dispozici
+     * 
+     * @param pCharacteristic charakteristika casu
+     */
+    void onWrite(BLECharacteristic* pCharacteristic, esp_ble_gatts_cb_param_t *param) {
+      postEvent(EVENT_TIME, param->write.conn_id, atoi(pCharacteristic->getValue().c_str()), 0);
+    }
+};
+
+// callback funkce charakteristiky hodnoty zabezpeceni
+class SecurityValueCallbacks: public BLECharacteristicCallbacks {
+    /**
+     * @brief hodnotu zapsanou pred akci si smycka ulozi do relace spojeni - hodnota
+     * charakteristiky je spolecna vsem spojenim
+     * 
+     * @param pCharacteristic charakteristika hodnoty zabezpeceni
+     */
+    void onWrite(BLECharacteristic* pCharacteristic, esp_ble_gatts_cb_param_t *param) {
+      postEvent(EVENT_SECURITY_VALUE, param->write.conn_id, atoi(pCharacteristic->getValue().c_str()), 0);
+    }
+
+    /**
+     * @brief ve stavu AUTH_0 klient cte nahodnou zpravu sve relace, jinak verejny klic serveru
+     * 
+     * @param pCharacteristic charakteristika hodnoty zabezpeceni
+     */
+    void onRead(BLECharacteristic* pCharacteristic, esp_ble_gatts_cb_param_t *param) {
+      char value[12];
+      ClientSnapshot client;
+
+      if (readClientSnapshot(param->read.conn_id, &client) && client.securityState == AUTH_0) {
+        sprintf(value, "%u", client.challenge);
+      }
+      else {
+        sprintf(value, "%u", server_public_key);
+      }
+      pCharacteristic->setValue(value);
+    }
+};
+
+// callback funkce charakteristiky akce zabezpeceni
+class SecurityActionCallbacks: public BLECharacteristicCallbacks {
+    /**
+     * @brief klient zapise hodnotu a pote akci, smycka akci provede s hodnotou ulozenou v relaci
+     * 
+     * @param pCharacteristic charakteristika akce zabezpeceni
+     */
+    void onWrite(BLECharacteristic* pCharacteristic, esp_ble_gatts_cb_param_t *param) {
+      postEvent(EVENT_SECURITY, param->write.conn_id, atoi(pCharacteristic->getValue().c_str()), 0);
+    }
+
+    void onRead(BLECharacteristic* pCharacteristic, esp_ble_gatts_cb_param_t *param) {
+      ClientSnapshot client;
+      SecurityState state = readClientSnapshot(param->read.conn_id, &client) ? client.securityState : PAIR_0;
+      pCharacteristic->setValue(securityStateValueStrings[static_cast<int>(state)]);
+    }
+};
+
+// callback funkce charakteristiky agregovanych hodnot
+class RollupCallbacks: public BLECharacteristicCallbacks {
+    /**
+     * @brief klient zapise "uroven|cas od", intervaly prijdou notifikacemi po strankach
+     * 
+     * @param pCharacteristic charakteristika agregovanych hodnot
+     */
+    void onWrite(BLECharacteristic* pCharacteristic, esp_ble_gatts_cb_param_t *param) {
+      int level = 0;
+      int from = 0;
+
+      if (sscanf(pCharacteristic->getValue().c_str(), "%d|%d", &level, &from) == 2 && level >= 0 && level < ROLLUP_LEVELS) {
+        postEvent(EVENT_ROLLUP, param->write.conn_id, level, from);
+      }
+    }
+};
+
+// callback funkce charakteristiky formatu zaznamu
+class FormatCallbacks: public BLECharacteristicCallbacks {
+    /**
+     * @brief klient zapise "0" pro textovy a "1" pro binarni zaznam mereni
+     * 
+     * @param pCharacteristic charakteristika formatu zaznamu
+     */
+    void onWrite(BLECharacteristic* pCharacteristic, esp_ble_gatts_cb_param_t *param) {
+      postEvent(EVENT_FORMAT, param->write.conn_id, atoi(pCharacteristic->getValue().c_str()), 0);
+    }
+
+    void onRead(BLECharacteristic* pCharacteristic, esp_ble_gatts_cb_param_t *param) {
+      ClientSnapshot client;
+      bool binary = readClientSnapshot(param->read.conn_id, &client) && client.format == FORMAT_BINARY;
+      pCharacteristic->setValue(binary ? "1" : "0");
+    }
+};
+
+// callback funkce charakteristiky hromadneho prenosu
+class BackfillCallbacks: public BLECharacteristicCallbacks {
+    /**
+     * @brief klient zapise cas posledniho mereni, ktere ma k dispozici, pripadne
+     * "cas|kodovani" (1 pro Simple8b), a server mu notifikacemi posle vsechna novejsi mereni
+     * 
+     * @param pCharacteristic charakteristika hromadneho prenosu
+     */
+    void onWrite(BLECharacteristic* pCharacteristic, esp_ble_gatts_cb_param_t *param) {
+      int time = 0;
+      int encoding = BACKFILL_ENCODING_RAW;
+
+      if (sscanf(pCharacteristic->getValue().c_str(), "%d|%d", &time, &encoding) >= 1) {
+        postEvent(EVENT_BACKFILL, param->write.conn_id, time, encoding);
+      }
+    }
+};
+
+// callback funkce kontrolniho bodu pristupu k zaznamum
+class RacpCallbacks: public BLECharacteristicCallbacks {
+    /**
+     * @brief pozadavek se rozebere hned, hlavni smycce se preda operacni kod, operator,
+     * vysledek kontroly a casovy interval
+     * 
+     * @param pCharacteristic kontrolni bod
+     */
+    void onWrite(BLECharacteristic* pCharacteristic, esp_ble_gatts_cb_param_t *param) {
+      RacpRequest request;
+      uint8_t status = racp_parse(param->write.value, param->write.len, &request);
+
+      postEvent(EVENT_RACP, param->write.conn_id, request.opcode | (request.op << 8) | (status << 16), request.from, request.to);
+    }
+};
+
+// callback funkce charakteristiky grafu
+class ChartCallbacks: public BLECharacteristicCallbacks {
+    /**
+     * @brief klient zapise "cas od|cas do|pocet bodu", body prijdou notifikacemi
+     * 
+     * @param pCharacteristic charakteristika grafu
+     */
+    void onWrite(BLECharacteristic* pCharacteristic, esp_ble_gatts_cb_param_t *param) {
+      int from = 0;
+      int to = 0;
+      int points = 0;
+
+      if (sscanf(pCharacteristic->getValue().c_str(), "%d|%d|%d", &from, &to, &points) == 3) {
+        postEvent(EVENT_CHART, param->write.conn_id, from, to, points);
+      }
+    }
+};
+
+// callback funkce charakteristiky metrik spojeni
+class MetricsCallbacks: public BLECharacteristicCallbacks {
+    /**
+     * @brief pri cteni nastavi prehled metrik fazi vsech spojeni, ";pocet zahozenych
+     * udalosti", ";start do advertisingu|start do prvni notifikace|obnoveni agregaci"
+     * v us a pro kazde spojeni ";prijate parametry"
+     * 
+     * @param pCharacteristic charakteristika metrik
+     */
+    void onRead(BLECharacteristic* pCharacteristic) {
+      char report[sizeof(snapshot.metrics)];
+
+      portENTER_CRITICAL(&snapshotLock);
+      memcpy(report, snapshot.metrics, sizeof(report));
+      portEXIT_CRITICAL(&snapshotLock);
+      pCharacteristic->setValue(report);
+    }
+};
+
+/**
+ * @brief zachyti parametry spojeni, ktere centralni zarizeni skutecne nastavilo - udalost
+ * nese jen adresu protistrany, spojeni podle ni dohleda smycka
+ * 
+ */
+void linkGapHandler(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t *param) {
+  if (event == ESP_GAP_BLE_UPDATE_CONN_PARAMS_EVT && param->update_conn_params.status == ESP_BT_STATUS_SUCCESS) {
+    postEvent(EVENT_LINK_PARAMS, 0, param->update_conn_params.conn_int, param->update_conn_params.latency, param->update_conn_params.timeout, param->update_conn_params.bda);
+  }
+}
+
+/**
+ * @brief zachyti zapisy deskriptoru BLE2902 - knihovna drzi jedinou hodnotu pro vsechna
+ * spojeni, odber notifikaci se proto eviduje v relaci podle conn_id; dale predava
+ * zahlceni spojeni, behem ktereho se notifikace neposilaji
+ * 
+ */
+void subscriptionGattsHandler(esp_gatts_cb_event_t event, esp_gatt_if_t gattsIf, esp_ble_gatts_cb_param_t *param) {
+  if (event == ESP_GATTS_CONGEST_EVT) {
+    postEvent(EVENT_CONGEST, param->congest.conn_id, param->congest.congested, 0);
+    return;
+  }
+  if (event != ESP_GATTS_WRITE_EVT || param->write.is_prep || param->write.len < 1) {
+    return;
+  }
+  if (param->write.handle == cgmMeasurementNotifications->getHandle()) {
+    postEvent(EVENT_SUBSCRIBE, param->write.conn_id, CLIENT_SUBSCRIBED_MEASUREMENT, param->write.value[0] & 0x01);
+  }
+  else if (param->write.handle == cgmBackfillNotifications->getHandle()) {
+    postEvent(EVENT_SUBSCRIBE, param->write.conn_id, CLIENT_SUBSCRIBED_BACKFILL, param->write.value[0] & 0x01);
+  }
+  else if (param->write.handle == cgmRacpNotifications->getHandle()) {
+    postEvent(EVENT_SUBSCRIBE, param->write.conn_id, CLIENT_SUBSCRIBED_RACP, param->write.value[0] & 0x01);
+  }
+  else if (param->write.handle == cgmChartNotifications->getHandle()) {
+    postEvent(EVENT_SUBSCRIBE, param->write.conn_id, CLIENT_SUBSCRIBED_CHART, param->write.value[0] & 0x01);
+  }
+  else if (param->write.handle == cgmRollupNotifications->getHandle()) {
+    postEvent(EVENT_SUBSCRIBE, param->write.conn_id, CLIENT_SUBSCRIBED_ROLLUP, param->write.value[0] & 0x01);
+  }
+}
+
+// callback funkce charakteristiky glykemickeho profilu
+class AgpCallbacks: public BLECharacteristicCallbacks {
+    /**
+     * @brief klient zapise cas dne zacatku relace v sekundach od pulnoci
+     * 
+     * @param pCharacteristic charakteristika glykemickeho profilu
+     */
+    void onWrite(BLECharacteristic* pCharacteristic, esp_ble_gatts_cb_param_t *param) {
+      postEvent(EVENT_AGP, param->write.conn_id, atoi(pCharacteristic->getValue().c_str()), 0);
+    }
+
+    /**
+     * @brief pred ctenim sestavi percentily vsech useku dne, profil se precte jednim pozadavkem
+     * 
+     * @param pCharacteristic charakteristika glykemickeho profilu
+     */
+    void onRead(BLECharacteristic* pCharacteristic, esp_ble_gatts_cb_param_t *param) {
+      uint8_t packed[AGP_PACKED_SIZE];
+      ClientSnapshot client;
+      size_t len;
+
+      if (!readClientSnapshot(param->read.conn_id, &client) || client.securityState != READY) {
+        pCharacteristic->setValue("");
+        return;
+      }
+      portENTER_CRITICAL(&snapshotLock);
+      len = snapshot.agpLen;
+      memcpy(packed, snapshot.agp, len);
+      portEXIT_CRITICAL(&snapshotLock);
+      pCharacteristic->setValue(packed, len);
+    }
+};
+
+// callback funkce charakteristiky souhrnu poslednich 24 hodin
+class StatsCallbacks: public BLECharacteristicCallbacks {
+    /**
+     * @brief pri cteni nastavi souhrn poslednich 24 hodin, bez mereni je prazdny
+     * 
+     * @param pCharacteristic charakteristika souhrnu
+     */
+    void onRead(BLECharacteristic* pCharacteristic, esp_ble_gatts_cb_param_t *param) {
+      uint8_t packed[STATUS_STATS_SIZE];
+      ClientSnapshot client;
+      size_t len;
+
+      if (!readClientSnapshot(param->read.conn_id, &client) || client.securityState != READY) {
+        pCharacteristic->setValue("");
+        return;
+      }
+      portENTER_CRITICAL(&snapshotLock);
+      len = snapshot.statsLen;
+      memcpy(packed, snapshot.stats, len);
+      portEXIT_CRITICAL(&snapshotLock);
+      pCharacteristic->setValue(packed, len);
+    }
+};
+
+// callback funkce charakteristiky potvrzeni
+class AckCallbacks: public BLECharacteristicCallbacks {
+    /**
+     * @brief klient zapise cas posledniho mereni, ktere bezpecne ulozil
+     * 
+     * @param pCharacteristic charakteristika potvrzeni
+     */
+    void onWrite(BLECharacteristic* pCharacteristic, esp_ble_gatts_cb_param_t *param) {
+      postEvent(EVENT_ACK, param->write.conn_id, atoi(pCharacteristic->getValue().c_str()), 0);
+    }
+
+    /**
+     * @brief pred ctenim nastavi "potvrzeny cas|pocet ztracenych mereni"
+     * 
+     * @param pCharacteristic charakteristika potvrzeni
+     */
+    void onRead(BLECharacteristic* pCharacteristic) {
+      char value[sizeof(snapshot.ack)];
+
+      portENTER_CRITICAL(&snapshotLock);
+      memcpy(value, snapshot.ack, sizeof(value));
+      portEXIT_CRITICAL(&snapshotLock);
+      pCharacteristic->setValue(value);
+    }
+};
+
+/**
+ * @brief funkce hledajici mereni nasledujici po zadanem case
+ * 
+ * Mereni starsi nez obsah bufferu se dohledavaji v komprimovane historii,
+ * a pokud ji zadany cas predchazi, v logu ve flash.
+ * 
+ * @param time cas posledniho mereni, ktere ma klient k dispozici
+ * @param measurement nalezene mereni
+ * @return true nasledujici mereni bylo nalezeno
+ * @return false zadne nasledujici mereni neni k dispozici
+ */
+bool findMeasurementAfter(int32_t time, CGMeasurement *measurement) {
+  if (buffer.isEmpty() || time < buffer.timeAt(0)) {
+    if (time >= history_first_time() && history_find_after(time, measurement)) {
+      return true;
+    }
+    if (mlog_find_after(time, measurement) || history_find_after(time, measurement)) {
+      return true;
+    }
+  }
+
+  // casy mereni jsou monotonni, prvni novejsi mereni se najde pulenim sloupce casu
+  size_t index = buffer.upperBound(time);
+  if (index < buffer.size()) {
+    *measurement = buffer[index];
+    return true;
+  }
+  return false;
+}
+
+/**
+ * @brief najde prvni mereni po zadanem case, ktere klient nesmazal
+ * 
+ */
+bool findRecordAfter(int32_t time, CGMeasurement *measurement) {
+  return findMeasurementAfter((time < deleted) ? deleted : time, measurement);
+}
+
+// cas nejstarsiho presne ulozeneho mereni relace, zjisti se pri zahajeni dotazu grafu
+int32_t chartExactFrom = INT32_MAX;
+
+/**
+ * @brief najde bod grafu novejsi nez zadany cas - obdobi pred nejstarsim presne
+ * ulozenym merenim doplni body ztratove historie, smazana mereni se vynechaji
+ * 
+ */
+bool findChartPointAfter(int32_t time, CGMeasurement *measurement) {
+  int32_t after = (time < deleted) ? deleted : time;
+
+  if (LOSSY_HISTORY && after < chartExactFrom && sdt_find_after(after, measurement) && measurement->timeOffset < chartExactFrom) {
+    return true;
+  }
+  return findRecordAfter(time, measurement);
+}
+
+/**
+ * @brief spocita nesmazana mereni novejsi nez zadany cas - z indexu logu ve flash,
+ * bez logu z bufferu poslednich mereni
+ * 
+ */
+uint32_t countRecordsAfter(int32_t time) {
+  uint32_t count;
+
+  if (time < deleted) {
+    time = deleted;
+  }
+  if (mlog_count_after(time, &count)) {
+    return count;
+  }
+  return buffer.size() - buffer.upperBound(time);
+}
+
+/**
+ * @brief vrati nejnovejsi nesmazane mereni
+ * 
+ */
+bool lastRecord(CGMeasurement *measurement) {
+  if (!buffer.isEmpty()) {
+    *measurement = buffer[buffer.size() - 1];
+  }
+  else if (!mlog_last(measurement)) {
+    return false;
+  }
+  return measurement->timeOffset > deleted;
+}
+
+/**
+ * @brief vrati nejnovejsi mereni relace vcetne smazanych
+ * 
+ */
+bool lastSessionMeasurement(CGMeasurement *measurement) {
+  if (!buffer.isEmpty()) {
+    *measurement = buffer.last();
+    return true;
+  }
+  return mlog_last(measurement);
+}
+
+/**
+ * @brief sestavi glykemicky profil z mereni poslednich 14 dni ulozenych v logu
+ * 
+ */
+void rebuildAgp() {
+  CGMeasurement last;
+
+  agp_init(findMeasurementAfter, agpOrigin);
+  if (lastSessionMeasurement(&last)) {
+    agp_rebuild(last.timeOffset);
+  }
+}
+
+/**
+ * @brief sestavi statistiky, urovne agregace a ztratovou historii znovu z mereni
+ * ulozenych v logu, napr. po restartu - jeden pruchod oknem nejdelsi urovne agregace;
+ * ztratova historie starsi nez log restart neprezije
+ * 
+ */
+void rebuildAggregates() {
+  CGMeasurement last;
+  CGMeasurement measurement;
+
+  rollup_clear();
+  stats_init(findMeasurementAfter);
+  sdt_clear();
+  if (!lastSessionMeasurement(&last)) {
+    return;
+  }
+  int32_t from = (last.timeOffset > INT32_MIN + ROLLUP_RETENTION) ? last.timeOffset - ROLLUP_RETENTION : INT32_MIN;
+  for (int32_t time = from; findMeasurementAfter(time, &measurement) && measurement.timeOffset <= last.timeOffset; time = measurement.timeOffset) {
+    rollup_push(measurement);
+    stats_push(measurement);
+    if (LOSSY_HISTORY) {
+      sdt_push(measurement);
+    }
+  }
+}
+
+/**
+ * @brief zahaji novou relaci - cas mereni zacina znovu, proto se zahodi mereni
+ * predchozi relace a kurzory, ktere se k jejim casum vztahovaly
+ * 
+ * Rozpracovane prenosy klientu skonci samy, v nove relaci uz po jejich kurzoru
+ * zadne mereni neni. Streamovani pokracuje od zacatku nove relace.
+ */
+void startSession() {
+  mlog_new_session();
+  acknowledged = INVALID_TIME;
+  deleted = INVALID_TIME;
+  agpOrigin = 0;
+  persistSession();
+
+  buffer.clear();
+  history_clear();
+  rollup_clear();
+  sdt_clear();
+  stats_init(findMeasurementAfter);
+  agp_init(findMeasurementAfter, agpOrigin);
+
+  for (uint8_t i = 0; i < CLIENT_MAX_CONNECTIONS; ++i) {
+    Client *client = client_at(i);
+    if (client != NULL) {
+      client->lastTime = INVALID_TIME;
+      client->delivered = INVALID_TIME;
+    }
+  }
+}
+
+/**
+ * @brief funkce kodujici zaznam mereni ve formatu relace
+ * 
+ * @param client relace klienta
+ * @param measurement mereni
+ * @param dest buffer o velikosti alespon FORMAT_BINARY_MAX_SIZE a FORMAT_ASCII_SIZE + 1
+ * @return delka zaznamu
+ */
+size_t formatMeasurement(Client *client, CGMeasurement measurement, uint8_t *dest) {
+  if (client->format == FORMAT_BINARY) {
+    CGMeasurement previous;
+    // predchozi mereni pro trend je k dispozici, pokud mereni lezi v bufferu
+    size_t index = buffer.upperBound(measurement.timeOffset - 1);
+    bool hasPrevious = index > 0 && index < buffer.size();
+    if (hasPrevious) {
+      previous = buffer[index - 1];
+    }
+    return format_binary(measurement, hasPrevious ? &previous : NULL, dest);
+  }
+  return format_ascii(measurement, (char *)dest);
+}
+
+/**
+ * @brief sestavi stavovy snimek relace klienta - stav, hodnotu zabezpeceni, interval,
+ * posledni mereni a hranice historie
+ * 
+ * @param client relace klienta, NULL pro spojeni bez relace
+ * @param dest buffer o velikosti STATUS_SIZE
+ * @return delka snimku
+ */
+size_t packStatus(Client *client, uint8_t *dest) {
+  CGMeasurement measurement;
+  SensorStatus status = {INIT, PAIR_0, (uint8_t)cgm_interval, server_public_key, INVALID_TIME, 0, INVALID_TIME, INVALID_TIME};
+
+  if (client != NULL) {
+    status.state = client->state;
+    status.securityState = client->securityState;
+    if (client->securityState == AUTH_0) {
+      status.securityValue = client->challenge;
+    }
+  }
+  if (client != NULL && client->securityState == READY) {
+    if (lastRecord(&measurement)) {
+      status.lastTime = measurement.timeOffset;
+      status.lastValue = (uint16_t)measurement.glucoseValue;
+    }
+    if (findRecordAfter(INVALID_TIME, &measurement)) {
+      status.firstTime = measurement.timeOffset;
+    }
+    status.acknowledged = acknowledged;
+  }
+  return status_pack(&status, dest);
+}
+
+/**
+ * @brief sestavi souhrn poslednich 24 hodin konciciho poslednim merenim
+ * 
+ * @param dest buffer o velikosti STATUS_STATS_SIZE
+ * @return delka souhrnu, 0 bez mereni
+ */
+size_t packDayStats(uint8_t *dest) {
+  CGMeasurement measurement;
+  WindowStats window;
+  DayStats day;
+
+  if (!lastRecord(&measurement) || !stats_query(measurement.timeOffset - STATUS_STATS_WINDOW + 1, measurement.timeOffset, &window)) {
+    return 0;
+  }
+  status_set_stats(&day, &window);
+  return status_pack_stats(&day, dest);
+}
+
+/**
+ * @brief sestavi a publikuje snimek pro cteni charakteristik
+ * 
+ * Snimek relace se sestavi znovu po zmene - udalosti, novem mereni nebo posunu
+ * kurzoru relace pri obsluze, potvrzeni a profil jen po udalosti nebo mereni.
+ * 
+ * @param changed od posledniho snimku prisla udalost nebo mereni
+ */
+void publishSnapshot(bool changed) {
+  CGMeasurement measurement;
+
+  for (uint8_t i = 0; i < CLIENT_MAX_CONNECTIONS; ++i) {
+    Client *client = client_at(i);
+    ClientSnapshot *entry = &staged.clients[i];
+
+    if (client == NULL) {
+      entry->active = false;
+      continue;
+    }
+    if (!changed && entry->active && entry->connId == client->connId && entry->state == client->state && entry->lastTime == client->lastTime) {
+      continue;
+    }
+    entry->active = true;
+    entry->connId = client->connId;
+    entry->state = client->state;
+    entry->securityState = client->securityState;
+    entry->challenge = client->challenge;
+    entry->format = client->format;
+    entry->lastTime = client->lastTime;
+    entry->recordLen = 0;
+    if (client->securityState == READY && findRecordAfter(client->lastTime, &measurement)) {
+      entry->recordTime = measurement.timeOffset;
+      entry->recordLen = formatMeasurement(client, measurement, entry->record);
+    }
+    entry->statusLen = packStatus(client, entry->status);
+  }
+
+  if (changed) {
+    snprintf(staged.ack, sizeof(staged.ack), "%d|%u", acknowledged, mlog_lost() + droppedMeasurements.load());
+    staged.agpLen = agp_pack(staged.agp, sizeof(staged.agp));
+    staged.statsLen = packDayStats(staged.stats);
+  }
+  // metriky zahrnou i probihajici faze spojeni
+  for (uint8_t i = 0; i < CLIENT_MAX_CONNECTIONS; ++i) {
+    Client *client = client_at(i);
+    if (client != NULL) {
+      link_flush(&client->link, millis());
+    }
+  }
+  size_t len = link_report(staged.metrics, sizeof(staged.metrics));
+  int written = snprintf(staged.metrics + len, sizeof(staged.metrics) - len, ";%u;%lu|%lu|%lu", (unsigned)droppedEvents.load(), bootToAdvertising, bootToNotification, bootRebuild);
+  len = (written > 0 && (size_t)written < sizeof(staged.metrics) - len) ? len + written : len;
+  for (uint8_t i = 0; i < CLIENT_MAX_CONNECTIONS && len + 1 < sizeof(staged.metrics); ++i) {
+    Client *client = client_at(i);
+    if (client == NULL) {
+      continue;
+    }
+    staged.metrics[len] = ';';
+    size_t params = link_params_report(&client->link, staged.metrics + len + 1, sizeof(staged.metrics) - len - 1);
+    if (params == 0) {
+      staged.metrics[len] = '\0';
+      break;
+    }
+    len += 1 + params;
+  }
+
+  portENTER_CRITICAL(&snapshotLock);
+  snapshot = staged;
+  portEXIT_CRITICAL(&snapshotLock);
+}
+
+// callback funkce charakteristiky mereni
+class MeasurementCallbacks: public BLECharacteristicCallbacks {
+    /**
+     * @brief pri cteni nastavi mereni nasledujici po poslednim mereni klienta, smycka
+     * si pote zaznamena jeho doruceni
+     * 
+     * @param pCharacteristic charakteristika mereni
+     */
+    void onRead(BLECharacteristic* pCharacteristic, esp_ble_gatts_cb_param_t *param) {
+      ClientSnapshot client;
+
+      if (!readClientSnapshot(param->read.conn_id, &client) || client.recordLen == 0) {
+        pCharacteristic->setValue("");
+        return;
+      }
+      pCharacteristic->setValue(client.record, client.recordLen);
+      postEvent(EVENT_READ, param->read.conn_id, client.recordTime, 0);
+    }
+};
+
+// callback funkce stavove charakteristiky
+class StatusCallbacks: public BLECharacteristicCallbacks {
+    /**
+     * @brief pri cteni nastavi stavovy snimek relace klienta
+     * 
+     * @param pCharacteristic stavova charakteristika
+     */
+    void onRead(BLECharacteristic* pCharacteristic, esp_ble_gatts_cb_param_t *param) {
+      uint8_t packed[STATUS_SIZE];
+      ClientSnapshot client;
+
+      if (readClientSnapshot(param->read.conn_id, &client)) {
+        pCharacteristic->setValue(client.status, client.statusLen);
+      }
+      else {
+        pCharacteristic->setValue(packed, packStatus(NULL, packed));
+      }
+    }
+};
+
+/**
+ * @brief odesle notifikaci hodnoty charakteristiky jedinemu spojeni
+ * 
+ * @param client relace klienta
+ * @param characteristic charakteristika
+ * @param data hodnota
+ * @param len delka hodnoty
+ */
+bool notifyClient(Client *client, BLECharacteristic *characteristic, uint8_t *data, size_t len) {
+  if (esp_ble_gatts_send_indicate(cgmServer->getGattsIf(), client->connId, characteristic->getHandle(), len, data, false) != ESP_OK) {
+    return false;
+  }
+  link_count(&client->link, len);
+  return true;
+}
+
+/**
+ * @brief nejvetsi delka notifikace pro vyjednane MTU spojeni
+ * 
+ * @param client relace klienta
+ * @param max velikost bufferu volajiciho
+ */
+size_t notificationCapacity(Client *client, size_t max) {
+  uint16_t mtu = cgmServer->getPeerMTU(client->connId);
+
+  if (mtu < BLE_DEFAULT_MTU) {
+    mtu = BLE_DEFAULT_MTU;
+  }
+  size_t payload = mtu - ATT_HEADER_SIZE;
+  return (payload < max) ? payload : max;
+}
+
+/**
+ * @brief odesle klientovi notifikaci zaznamu mereni a zaznamena jeho doruceni, u prvni
+ * notifikace zaznamena dobu od startu
+ * 
+ * @param client relace klienta
+ * @param measurement mereni
+ * @param record buffer pro zaznam o velikosti alespon FORMAT_ASCII_SIZE + 1
+ * @return false notifikaci se nepodarilo odeslat
+ */
+bool notifyMeasurement(Client *client, CGMeasurement measurement, uint8_t *record) {
+  if (!notifyClient(client, cgmMeasurementCharacteristic, record, formatMeasurement(client, measurement, record))) {
+    return false;
+  }
+  if (measurement.timeOffset > client->delivered) {
+    client->delivered = measurement.timeOffset;
+  }
+  if (bootToNotification == 0) {
+    bootToNotification = micros();
+    if (SERIAL_DEBUG) {
+      Serial.printf("Boot to first notification in %lu us\n", bootToNotification);
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief odesle jednu notifikaci hromadneho prenosu v kodovani relace - pocet zaznamu a tolik zaznamu,
+ * kolik se vejde do vyjednaneho MTU; notifikace bez zaznamu prenos ukoncuje
+ * 
+ * @param client relace klienta
+ * @return false notifikaci se nepodarilo odeslat, kurzor prenosu zustava
+ */
+bool sendBackfill(Client *client) {
+  uint8_t packed[BLE_MTU - ATT_HEADER_SIZE];
+  size_t capacity = notificationCapacity(client, sizeof(packed));
+  int32_t cursor = client->backfillTime;
+  size_t len;
+
+  if (client->backfillEncoding == BACKFILL_ENCODING_SIMPLE8B) {
+    len = backfill_pack_compressed(&cursor, packed, capacity);
+  }
+  else {
+    len = backfill_pack(&cursor, packed, capacity);
+  }
+
+  if (!notifyClient(client, cgmBackfillCharacteristic, packed, len)) {
+    return false;
+  }
+  client->backfillTime = cursor;
+  if (client->backfillTime > client->delivered) {
+    client->delivered = client->backfillTime;
+  }
+  client->backfillActive = packed[0] > 0;
+  return true;
+}
+
+/**
+ * @brief odesle klientovi cekajici odpoved kontrolniho bodu, pokud odebira jeho notifikace
+ * 
+ * @return false odpoved se nepodarilo odeslat, ceka na dalsi pokus
+ */
+bool sendRacpResponse(Client *client) {
+  if ((client->subscriptions & CLIENT_SUBSCRIBED_RACP) && !notifyClient(client, cgmRacpCharacteristic, client->racpResponse, client->racpResponseLen)) {
+    return false;
+  }
+  client->racpResponseLen = 0;
+  return true;
+}
+
+/**
+ * @brief provede pozadavek kontrolniho bodu - pocet, prvni a posledni zaznam se urci
+ * pulenim indexu, report se rozjede a zaznamy i odpoved posila serveClient po davkach
+ * 
+ * Novy pozadavek ukonci probihajici report. Mazat lze jen od nejstarsiho zaznamu,
+ * log ve flash se pouze pripojuje - smazani posune hranici, pred kterou se zaznamy
+ * klientum neposilaji, a zaroven je potvrdi.
+ * 
+ * @param client relace klienta
+ * @param request rozebrany pozadavek
+ * @param status vysledek kontroly pozadavku
+ */
+void processRacp(Client *client, RacpRequest request, uint8_t status) {
+  CGMeasurement first;
+  CGMeasurement last;
+
+  client->racpActive = false;
+  if (status != RACP_SUCCESS || request.opcode == RACP_ABORT) {
+    client->racpResponseLen = racp_response(request.opcode, status, client->racpResponse);
+    return;
+  }
+
+  bool found = findRecordAfter(INT32_MIN, &first) && lastRecord(&last);
+  if (found && request.op == RACP_FIRST) {
+    request.from = request.to = first.timeOffset;
+  }
+  else if (found && request.op == RACP_LAST) {
+    request.from = request.to = last.timeOffset;
+  }
+  int32_t after = (request.from == INT32_MIN) ? INT32_MIN : request.from - 1;
+  uint32_t count = found ? countRecordsAfter(after) - countRecordsAfter(request.to) : 0;
+
+  switch (request.opcode) {
+    case RACP_REPORT_COUNT: 
+      client->racpResponseLen = racp_count_response(count, client->racpResponse);
+      return;
+
+    case RACP_REPORT: 
+      if (count == 0) {
+        status = RACP_NO_RECORDS;
+      }
+      else if (!(client->subscriptions & CLIENT_SUBSCRIBED_MEASUREMENT)) {
+        status = RACP_NOT_COMPLETED;
+      }
+      else {
+        client->racpActive = true;
+        client->racpTime = after;
+        client->racpTo = request.to;
+        return;
+      }
+      break;
+
+    case RACP_DELETE: 
+      if (count == 0) {
+        status = RACP_NO_RECORDS;
+      }
+      else if (request.from > first.timeOffset) {
+        status = RACP_OPERATOR_NOT_SUPPORTED;
+      }
+      else {
+        deleted = (request.to < last.timeOffset) ? request.to : last.timeOffset;
+        if (deleted > acknowledged) {
+          acknowledged = deleted;
+          mlog_acknowledge(acknowledged);
+        }
+        sessionDirty = true;
+      }
+      break;
+  }
+  client->racpResponseLen = racp_response(request.opcode, status, client->racpResponse);
+}
+
+/**
+ * @brief odesle jednu notifikaci bodu grafu ve formatu hromadneho prenosu, bodu je
+ * tolik, kolik se vejde do vyjednaneho MTU; notifikace bez bodu dotaz ukoncuje
+ * 
+ * Dotaz se posouva na kopii, stav relace se prevezme az po odeslani.
+ * 
+ * @param client relace klienta
+ * @return false notifikaci se nepodarilo odeslat
+ */
+bool sendChart(Client *client) {
+  uint8_t packed[BLE_MTU - ATT_HEADER_SIZE];
+  CGMeasurement point;
+  LttbQuery query = client->chart;
+  size_t capacity = notificationCapacity(client, sizeof(packed));
+  size_t len = BACKFILL_HEADER_SIZE;
+
+  while (len + BACKFILL_RECORD_SIZE <= capacity && lttb_next(&query, &point)) {
+    len += backfill_put(point, packed + len);
+  }
+  packed[0] = (uint8_t)((len - BACKFILL_HEADER_SIZE) / BACKFILL_RECORD_SIZE);
+
+  if (!notifyClient(client, cgmChartCharacteristic, packed, len)) {
+    return false;
+  }
+  client->chart = query;
+  client->chartActive = packed[0] > 0;
+  return true;
+}
+
+/**
+ * @brief zahaji dotaz grafu - konec intervalu se omezi na posledni mereni, aby se
+ * intervaly LTTB rozdelily jen pres ulozena mereni, a zacatek za smazana mereni
+ * 
+ */
+void startChart(Client *client, int32_t from, int32_t to, int32_t points) {
+  CGMeasurement last;
+  CGMeasurement first;
+
+  if (!(client->subscriptions & CLIENT_SUBSCRIBED_CHART)) {
+    return;
+  }
+  if (lastRecord(&last) && to > last.timeOffset) {
+    to = last.timeOffset;
+  }
+  if (from <= deleted) {
+    from = deleted + 1;
+  }
+  if (!findMeasurementAfter(INT32_MIN, &first)) {
+    first.timeOffset = INT32_MAX;
+  }
+  chartExactFrom = first.timeOffset;
+  client->chartActive = true;
+  if (points < 3 || points > LTTB_MAX_POINTS || !lttb_start(&client->chart, from, to, (uint16_t)points)) {
+    // neplatny dotaz se ukonci prazdnou notifikaci
+    client->chart.finished = true;
+  }
+}
+
+/**
+ * @brief odesle jednu stranku agregovanych intervalu, intervalu je tolik, kolik se
+ * vejde do vyjednaneho MTU; stranka bez intervalu odpoved ukoncuje
+ * 
+ * @param client relace klienta
+ * @return false stranku se nepodarilo odeslat, kurzor odpovedi zustava
+ */
+bool sendRollup(Client *client) {
+  uint8_t packed[BLE_MTU - ATT_HEADER_SIZE];
+  int32_t from = client->rollupFrom;
+  size_t len = rollup_pack(client->rollupLevel, &from, packed, notificationCapacity(client, sizeof(packed)));
+
+  if (!notifyClient(client, cgmRollupCharacteristic, packed, len)) {
+    return false;
+  }
+  client->rollupFrom = from;
+  client->rollupActive = packed[1] > 0;
+  return true;
+}
+
+/**
+ * @brief zahaji odpoved agregovanych intervalu dane urovne od zadaneho casu
+ * 
+ */
+void startRollup(Client *client, uint8_t level, int32_t from) {
+  if (!(client->subscriptions & CLIENT_SUBSCRIBED_ROLLUP)) {
+    return;
+  }
+  client->rollupLevel = level;
+  client->rollupFrom = from;
+  client->rollupActive = true;
+}
+
+/**
+ * @brief zpracuje akci zabezpeceni zapsanou klientem - klient smi zapsat jen PAIR_1
+ * (verejny klic) a AUTH_1 (odpoved na vystavenou zpravu), ostatni stavy nastavuje
+ * server; jine akce se zahodi
+ * 
+ * @param client relace klienta
+ * @param action zapsana akce (podstav zabezpeceni)
+ * @param value hodnota zapsana spolu s akci
+ */
+void processSecurity(Client *client, int32_t action, int32_t value) {
+  if (action == PAIR_1) {
+    setSharedKey(client, ((int)pow(value, private_key)) % DH_COMMON_P);
+    shared_key = client->sharedKey;
+    persistSession();
+    beacon_derive(shared_key, &beaconKeys);
+    beaconEnabled = true;
+    setAuthValue(client);
+  }
+  // odpoved se overuje jen proti vystavene zprave, bez ni je kontrolni hodnota neplatna;
+  // neuspesna odpoved zustava v AUTH_1
+  else if (action == AUTH_1 && (client->securityState == AUTH_0 || client->securityState == AUTH_1)) {
+    client->securityState = AUTH_1;
+    if ((uint32_t)value == client->checkNum) {
+      client->securityState = READY;
+      client->state = READ;
+    }
+  }
+}
 
-#define DH_COMMON_G 2
-#define DH_COMMON_P 19
+/**
+ * @brief zalozi relaci noveho spojeni, klient se sdilenym klicem rovnou autentizuje
+ * 
+ */
+void openClient(uint16_t connId, const uint8_t *address) {
+  Client *client = client_open(connId);
 
-#define PIN_OLED_SDA 4
-#define PIN_OLED_SCL 15
-#define PIN_OLED_RST 16
-#define PIN_LED_R 23
-#define PIN_POT_0 13
+  if (client == NULL) {
+    return;
+  }
+  link_connect(&client->link, address, millis());
+  client->state = SECURITY;
+  client->securityState = PAIR_0;
+  client->lastTime = INVALID_TIME;
+  client->delivered = acknowledged;
+  client->format = FORMAT_ASCII;
+  if (shared_key != 0) {
+    setSharedKey(client, shared_key);
+    setAuthValue(client);
+  }
+  digitalWrite(PIN_LED_R, HIGH);
 
-#define PATIENT 1
+  // po pripojeni se advertising zastavi, dalsi klienti se pripoji, dokud je misto
+  if (client_count() < CLIENT_MAX_CONNECTIONS) {
+    cgmServer->getAdvertising()->start();
+  }
+}
 
-// objekt integrovaneho displeje
-SSD1306  display(0x3c, PIN_OLED_SDA, PIN_OLED_SCL);
+void closeClient(uint16_t connId) {
+  Client *client = client_find(connId);
 
-// datova struktura mereni a buffer k jejich ukladani
-struct CGMeasurement {
-  int32_t timeOffset;
-  int32_t glucoseValue;
-};
+  if (client != NULL) {
+    link_disconnect(&client->link, millis());
+    client_close(connId);
+  }
+  flushSession(true);
+  if (client_count() == 0) {
+    digitalWrite(PIN_LED_R, LOW);
+  }
+  cgmServer->getAdvertising()->start();
+}
 
-CircularBuffer<CGMeasurement, 10> buffer;
+/**
+ * @brief zpracuje udalost - pripojeni, odpojeni, zapis klienta nebo nove mereni
+ * 
+ * @param event udalost z fronty
+ */
+void handleEvent(Event event) {
+  if (event.type == EVENT_MEASUREMENT) {
+    return;
+  }
+  if (event.type == EVENT_CONNECT) {
+    openClient(event.connId, event.address);
+    return;
+  }
+  if (event.type == EVENT_DISCONNECT) {
+    closeClient(event.connId);
+    return;
+  }
+  if (event.type == EVENT_LINK_PARAMS) {
+    for (uint8_t i = 0; i < CLIENT_MAX_CONNECTIONS; ++i) {
+      Client *client = client_at(i);
+      if (client != NULL && link_matches(&client->link, event.address)) {
+        link_params_updated(&client->link, event.value, event.parameter, event.bound, millis());
+      }
+    }
+    return;
+  }
 
-// stavy relace a podstavy pro sluzbu zabezpeceni
-enum State {INIT, SECURITY, READ, NOTIFY};
-char *stateStrings[4] = {"INIT", "SECURITY", "READ", "NOTIFY"};
-enum SecurityState {PAIR_0, PAIR_1, AUTH_0, AUTH_1, READY};
-char *securityStateStrings[5] = {"PAIR", "PAIR", "AUTH", "AUTH", "READY"};
-char *securityStateValueStrings[5] = {"0", "1", "2", "3", "4"};
+  Client *client = client_find(event.connId);
+  if (client == NULL) {
+    return;
+  }
 
-State state = INIT;
-SecurityState securityState = PAIR_0;
+  switch (event.type) {
+    case EVENT_TIME: 
+      if (client->securityState != READY) {
+        break;
+      }
+      client->lastTime = event.value;
+      // s povolenymi notifikacemi staci klientovi zadat kurzor jednou, dalsi mereni
+      // server posila sam a kurzor si drzi v relaci
+      if ((client->subscriptions & CLIENT_SUBSCRIBED_MEASUREMENT) && event.value != INVALID_TIME) {
+        client->state = STREAM;
+      }
+      else {
+        client->state = (event.value == INVALID_TIME) ? READ : NOTIFY;
+      }
+      break;
 
-char *getStateStr() {
-    if (state == SECURITY) {
-        return securityStateStrings[static_cast<int>(securityState)];
-    }
-    else {
-        return stateStrings[static_cast<int>(state)];
-    }
-}
+    case EVENT_SECURITY_VALUE: 
+      client->securityValue = event.value;
+      break;
 
+    case EVENT_SECURITY: 
+      if (client->state == SECURITY) {
+        processSecurity(client, event.value, client->securityValue);
+      }
+      break;
 
-// BLE server, sluzby a jejich charakteristiky
-BLEServer *cgmServer;
+    case EVENT_ACK: 
+      if (client->securityState == READY && event.value > acknowledged && event.value <= client->delivered) {
+        acknowledged = event.value;
+        mlog_acknowledge(acknowledged);
+        sessionDirty = true;
+      }
+      break;
 
-BLEService *cgmService;
-BLECharacteristic *cgmMeasurementCharacteristic;
-BLECharacteristic *cgmTimeCharacteristic;
+    case EVENT_READ: 
+      if (client->securityState == READY && event.value > client->delivered) {
+        client->delivered = event.value;
+      }
+      break;
 
-BLEService *securityService;
-BLECharacteristic *securityValueCharacteristic;
-BLECharacteristic *securityActionCharacteristic;
+    case EVENT_BACKFILL: 
+      if (client->securityState == READY && (client->subscriptions & CLIENT_SUBSCRIBED_BACKFILL)) {
+        client->backfillTime = event.value;
+        client->backfillEncoding = (event.parameter == BACKFILL_ENCODING_SIMPLE8B) ? BACKFILL_ENCODING_SIMPLE8B : BACKFILL_ENCODING_RAW;
+        client->backfillActive = true;
+      }
+      break;
 
-char messageBuffer[64];
+    case EVENT_FORMAT: 
+      client->format = (event.value == FORMAT_BINARY) ? FORMAT_BINARY : FORMAT_ASCII;
+      break;
 
-// klice a hodnoty pro parovani, autentizaci a sifrovani
-uint32_t private_key;
-uint32_t server_public_key;
-uint32_t client_public_key;
-uint32_t shared_key = 0;
-uint32_t aes_key[4] = { 0 };
-uint32_t checkNum;
+    case EVENT_RACP: 
+      if (client->securityState == READY) {
+        RacpRequest request = {(uint8_t)(event.value & 0xFF), (uint8_t)((event.value >> 8) & 0xFF), event.parameter, event.bound};
+        processRacp(client, request, (uint8_t)((event.value >> 16) & 0xFF));
+      }
+      break;
 
-// promenne potenciometru k nastaveni intervalu mereni
-int pot_0;
-int cgm_interval = DEFAULT_CGM_INTERVAL;
+    case EVENT_CHART: 
+      if (client->securityState == READY) {
+        startChart(client, event.value, event.parameter, event.bound);
+      }
+      break;
 
-// cas behu zarizeni a posledniho mereni klienta
-int timeSinceStart = 0;
-int32_t clientLastTime = -1;
+    case EVENT_ROLLUP: 
+      if (client->securityState == READY) {
+        startRollup(client, (uint8_t)event.value, event.parameter);
+      }
+      break;
 
-/**
- * @brief funkce k vystaveni nahodne zpravy ve stavu AUTH_0
- * 
- */
-void setAuthValue() {
-  checkNum = random_from_to(1, 100);
-  sprintf(messageBuffer, "%d", checkNum);
-  securityValueCharacteristic->setValue(messageBuffer);
-  securityActionCharacteristic->setValue(securityStateValueStrings[static_cast<int>(AUTH_0)]);
-  checkNum += shared_key;
-}
+    case EVENT_AGP: 
+      if (client->securityState == READY && event.value >= 0 && event.value < AGP_DAY && event.value != agpOrigin) {
+        agpOrigin = event.value;
+        sessionDirty = true;
+        rebuildAgp();
+      }
+      break;
 
-// callback funkce serveru
-class CGMServerCallbacks: public BLEServerCallbacks {
-    void onConnect(BLEServer* pServer) {
-      digitalWrite(PIN_LED_R, HIGH);
-      state = SECURITY;
-      if (shared_key != 0) {
-        securityState = AUTH_0;
-        setAuthValue();
+    case EVENT_CONGEST: 
+      client->congested = event.value != 0;
+      break;
+
+    case EVENT_SUBSCRIBE: 
+      if (event.parameter) {
+        client->subscriptions |= event.value;
       }
-    }
+      else {
+        client->subscriptions &= ~event.value;
+      }
+      break;
 
-    void onDisconnect(BLEServer* pServer) {
-      digitalWrite(PIN_LED_R, LOW);
-      state = INIT;
-      cgmTimeCharacteristic->setValue(INVALID_TIME_STR);
-      clientLastTime = INVALID_TIME;
-      pServer->getAdvertising()->start();
-    }
-};
+    default: 
+      break;
+  }
+}
 
 /**
- * @brief funkce nastavujici hodnotu charakteristiky mereni nasledujici po zadanem case
+ * @brief odesle klientovi cekajici notifikace podle stavu jeho relace
  * 
- * @param clientLastTime cas posledniho mereni, ktere ma klient k dispozici
- * @return true nasledujici mereni je k dispozici a bylo nastaveno
- * @return false zadne nasledujici mereni neni k dispozici
+ * Kurzory se posouvaji jen po uspesnem odeslani. Pri zahlceni spojeni (nebo odmitnuti
+ * notifikace zasobnikem) se davka prerusi a pokracuje v dalsim pruchodu smyckou.
+ * 
+ * @param client relace klienta
  */
-bool setValueAfter(int clientLastTime) {
-  for (int i = 0; i < buffer.size(); ++i) {
-    if (clientLastTime >= buffer[i].timeOffset) {
-      continue;
-    }
-    sprintf(messageBuffer, "%10d|%4d", buffer[i].timeOffset, buffer[i].glucoseValue);
-    cgmMeasurementCharacteristic->setValue(messageBuffer);
-    return true;
+void serveClient(Client *client) {
+  uint8_t record[FORMAT_ASCII_SIZE + 1];
+  CGMeasurement measurement;
+
+  // prenosy, jejichz notifikace klient prestal odebirat, se ukonci
+  if (!(client->subscriptions & CLIENT_SUBSCRIBED_BACKFILL)) {
+    client->backfillActive = false;
+  }
+  if (!(client->subscriptions & CLIENT_SUBSCRIBED_CHART)) {
+    client->chartActive = false;
+  }
+  if (!(client->subscriptions & CLIENT_SUBSCRIBED_ROLLUP)) {
+    client->rollupActive = false;
+  }
+  if (client->congested) {
+    return;
   }
-  return false;
-}
 
-void processSecurity() {
-  securityState = static_cast<SecurityState>(atoi(securityActionCharacteristic->getValue().c_str()));
+  // report kontrolniho bodu a streamovani sdili charakteristiku mereni - zaznamy
+  // se neprokladaji, notifikace podle kurzoru pockaji na konec reportu
+  switch (client->racpActive ? READ : client->state) {
+    case NOTIFY: 
+      if ((client->subscriptions & CLIENT_SUBSCRIBED_MEASUREMENT) && findRecordAfter(client->lastTime, &measurement)
+          && notifyMeasurement(client, measurement, record)) {
+        client->lastTime = INVALID_TIME;
+        client->state = READ;
+      }
+      break;
 
-  switch (securityState) {
-    case PAIR_0: 
+    case STREAM: 
+      if (!(client->subscriptions & CLIENT_SUBSCRIBED_MEASUREMENT)) {
+        client->lastTime = INVALID_TIME;
+        client->state = READ;
+        break;
+      }
+      client->streamBacklog = true;
+      for (int i = 0; i < STREAM_BURST; ++i) {
+        if (!findRecordAfter(client->lastTime, &measurement)) {
+          client->streamBacklog = false;
+          break;
+        }
+        if (!notifyMeasurement(client, measurement, record)) {
+          break;
+        }
+        client->lastTime = measurement.timeOffset;
+      }
       break;
-    
-    case PAIR_1: 
-      client_public_key = atoi(securityValueCharacteristic->getValue().c_str());
-      shared_key = ((int)pow(client_public_key, private_key)) % DH_COMMON_P;
-      for (int i = 0; i < 4; ++i) {
-        aes_key[i] = shared_key;
-      }
-      securityState = AUTH_0;
-      setAuthValue();
+
+    default: 
       break;
+  }
 
-    case AUTH_0: 
+  // report kontrolniho bodu se posila po davkach jako streamovani, konci odpovedi
+  for (int i = 0; client->racpActive && i < STREAM_BURST; ++i) {
+    if (!findRecordAfter(client->racpTime, &measurement) || measurement.timeOffset > client->racpTo) {
+      client->racpActive = false;
+      client->racpResponseLen = racp_response(RACP_REPORT, RACP_SUCCESS, client->racpResponse);
       break;
+    }
+    if (!notifyMeasurement(client, measurement, record)) {
+      break;
+    }
+    client->racpTime = measurement.timeOffset;
+  }
+  if (client->racpResponseLen > 0 && !sendRacpResponse(client)) {
+    return;
+  }
 
-    case AUTH_1: 
-      if (atoi(securityValueCharacteristic->getValue().c_str()) == checkNum) {
-        securityState = READY;
-        securityActionCharacteristic->setValue(securityStateValueStrings[static_cast<int>(READY)]);
-        state = READ;
-        setValueAfter(clientLastTime);
-      }
+  // body grafu se posilaji po celych paketech, dokud dotaz nevrati vsechny
+  for (int i = 0; client->chartActive && i < BACKFILL_BURST; ++i) {
+    if (!sendChart(client)) {
+      break;
+    }
+  }
+
+  // agregovane intervaly se posilaji po strankach, dokud odpoved nedojde ke konci
+  for (int i = 0; client->rollupActive && i < BACKFILL_BURST; ++i) {
+    if (!sendRollup(client)) {
       break;
+    }
+  }
 
-    case READY: 
+  // hromadny prenos posila notifikace za sebou, dokud klient nedozene aktualni mereni
+  for (int i = 0; client->backfillActive && i < BACKFILL_BURST; ++i) {
+    if (!sendBackfill(client)) {
       break;
+    }
+  }
+}
+
+/**
+ * @brief vlozi posledni mereni do scan response - dve operace AES a jedna konfigurace
+ * dat advertisingu, advertising bezi dal; do advertising paketu se vedle 128bitoveho UUID
+ * data nevejdou
+ * 
+ */
+void updateBeacon() {
+  uint8_t payload[BEACON_PAYLOAD_SIZE];
+  BLEAdvertisementData scanResponse;
+  CGMeasurement previous;
+  bool hasPrevious = buffer.size() > 1;
+
+  if (hasPrevious) {
+    previous = buffer[buffer.size() - 2];
+  }
+  // dalsi blok hodnot citace se ulozi drive, nez se z nej prvni hodnota vysle
+  if (beaconCounter >= beaconReserved) {
+    beaconReserved = beaconCounter + BEACON_COUNTER_BLOCK;
+    persistSession();
   }
+  size_t len = beacon_seal(&beaconKeys, beaconCounter++, lastMeasurement, hasPrevious ? &previous : NULL, payload);
+  scanResponse.setManufacturerData(std::string((char *)payload, len));
+  cgmServer->getAdvertising()->setScanResponseData(scanResponse);
 }
 
 /**
@@ -200,126 +1663,330 @@ void drawScreen(CGMeasurement measurement, char *message) {
   display.display();
 }
 
-void setup() {
-  pinMode(PIN_OLED_RST, OUTPUT);
-  digitalWrite(PIN_OLED_RST, LOW);
-  delay(50);
-  digitalWrite(PIN_OLED_RST, HIGH);
+/**
+ * @brief preda nove mereni hlavni smycce - mereni, ktere se do plne fronty nevejde,
+ * se zahodi a zapocita, udalost se pro nej neposila
+ * 
+ * @param measurement nove mereni
+ */
+void acquireMeasurement(CGMeasurement measurement) {
+  if (!acquired.push(measurement)) {
+    droppedMeasurements++;
+    return;
+  }
+  postEvent(EVENT_MEASUREMENT, 0, measurement.timeOffset, 0);
+}
 
-  pinMode(PIN_LED_R, OUTPUT);
-  pinMode(PIN_POT_0, INPUT);
+/**
+ * @brief uloha snimani - jednou za sekundu, v intervalu mereni ziska nove mereni
+ * a preda jej hlavni smycce, ta tak neceka na blokujici komunikaci se simulatorem
+ * 
+ * @param parameter nepouzito
+ */
+void acquisitionTask(void *parameter) {
+  TickType_t lastWake = xTaskGetTickCount();
 
-  Serial.begin(115200);
-  Serial.println();
+  while (true) {
+    pot_0 = analogRead(PIN_POT_0);
+    cgm_interval = map(pot_0, 0, 4095, 1, 10);
 
-  display.init();
-  display.flipScreenVertically();
-  display.setFont(ArialMT_Plain_10);
-  display.setTextAlignment(TEXT_ALIGN_CENTER);
+    if (timeSinceStart % cgm_interval == 0) {
+      CGMeasurement measurement;
 
-  display.clear();
-  display.drawStringMaxWidth(64, 22, 128, "Setting up...");
-  display.display();
-  delay(1500);
+      if (PATIENT) {
+        String received;
+        int32_t time = 0;
+        int32_t val = 0;
+
+        Serial.println("STEP");
+        do {
+          received = Serial.readStringUntil('\n');
+          sscanf(received.c_str(), "OK;%d", &time);
+        } while (time == 0);
+
+        Serial.println("GET_IG");
+        received = Serial.readStringUntil('\n');
+        sscanf(received.c_str(), "OK;%d", &val);
+
+        measurement = CGMeasurement{time, val};
+      }
+      else {
+        measurement = CGMeasurement{timeSinceStart, random_from_to(750, 1500)};
+      }
+      acquireMeasurement(measurement);
+    }
+
+    timeSinceStart++;
+    vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(1000));
+  }
+}
 
+/**
+ * @brief inicializuje BLE server, obe sluzby a spusti advertising
+ * 
+ */
+void startBLE() {
   private_key = random_from_to(1, 100);
   server_public_key = ((int)pow(DH_COMMON_G, private_key)) % DH_COMMON_P;
 
   BLEDevice::init(SENSOR_BLE_NAME);
+  // vetsi MTU pri vymene MTU klientem, hromadny prenos jej vyuzije cele
+  BLEDevice::setMTU(BLE_MTU);
+  BLEDevice::setCustomGapHandler(linkGapHandler);
+  BLEDevice::setCustomGattsHandler(subscriptionGattsHandler);
 
   cgmServer = BLEDevice::createServer();
   cgmServer->setCallbacks(new CGMServerCallbacks());
 
-  cgmService = cgmServer->createService(CGM_SERVICE_UUID);
+  cgmService = cgmServer->createService(BLEUUID(CGM_SERVICE_UUID), CGM_SERVICE_HANDLES);
+
+  cgmStatusCharacteristic = new BLECharacteristic(CGM_STATUS_CHARACTERISTIC_UUID, BLECharacteristic::PROPERTY_READ);
+  cgmStatusCharacteristic->setCallbacks(new StatusCallbacks());
+  securityValueCharacteristic = new BLECharacteristic(CGM_SECURITY_VALUE_CHARACTERISTIC_UUID, BLECharacteristic::PROPERTY_READ | BLECharacteristic::PROPERTY_WRITE);
+  sprintf(messageBuffer, "%d", server_public_key);
+  securityValueCharacteristic->setValue(messageBuffer);
+  securityValueCharacteristic->setCallbacks(new SecurityValueCallbacks());
+  securityActionCharacteristic = new BLECharacteristic(CGM_SECURITY_ACTION_CHARACTERISTIC_UUID, BLECharacteristic::PROPERTY_WRITE | BLECharacteristic::PROPERTY_READ);
+  securityActionCharacteristic->setValue(securityStateValueStrings[static_cast<int>(PAIR_0)]);
+  securityActionCharacteristic->setCallbacks(new SecurityActionCallbacks());
 
   cgmMeasurementCharacteristic = new BLECharacteristic(CGM_MEASUREMENT_CHARACTERISTIC_UUID, BLECharacteristic::PROPERTY_NOTIFY | BLECharacteristic::PROPERTY_READ);
-  cgmMeasurementCharacteristic->addDescriptor(new BLE2902());
+  cgmMeasurementNotifications = new BLE2902();
+  cgmMeasurementCharacteristic->addDescriptor(cgmMeasurementNotifications);
+  cgmMeasurementCharacteristic->setCallbacks(new MeasurementCallbacks());
   cgmTimeCharacteristic = new BLECharacteristic(CGM_TIME_CHARACTERISTIC_UUID, BLECharacteristic::PROPERTY_WRITE);
   cgmTimeCharacteristic->setValue(INVALID_TIME_STR);
-
+  cgmTimeCharacteristic->setCallbacks(new TimeCallbacks());
+  cgmRollupCharacteristic = new BLECharacteristic(CGM_ROLLUP_CHARACTERISTIC_UUID, BLECharacteristic::PROPERTY_WRITE | BLECharacteristic::PROPERTY_NOTIFY);
+  cgmRollupNotifications = new BLE2902();
+  cgmRollupCharacteristic->addDescriptor(cgmRollupNotifications);
+  cgmRollupCharacteristic->setCallbacks(new RollupCallbacks());
+  cgmAckCharacteristic = new BLECharacteristic(CGM_ACK_CHARACTERISTIC_UUID, BLECharacteristic::PROPERTY_WRITE | BLECharacteristic::PROPERTY_READ);
+  cgmAckCharacteristic->setCallbacks(new AckCallbacks());
+  cgmAgpCharacteristic = new BLECharacteristic(CGM_AGP_CHARACTERISTIC_UUID, BLECharacteristic::PROPERTY_READ | BLECharacteristic::PROPERTY_WRITE);
+  cgmAgpCharacteristic->setCallbacks(new AgpCallbacks());
+  cgmFormatCharacteristic = new BLECharacteristic(CGM_FORMAT_CHARACTERISTIC_UUID, BLECharacteristic::PROPERTY_WRITE | BLECharacteristic::PROPERTY_READ);
+  cgmFormatCharacteristic->setCallbacks(new FormatCallbacks());
+  cgmFormatCharacteristic->setValue("0");
+  cgmBackfillCharacteristic = new BLECharacteristic(CGM_BACKFILL_CHARACTERISTIC_UUID, BLECharacteristic::PROPERTY_WRITE | BLECharacteristic::PROPERTY_NOTIFY);
+  cgmBackfillNotifications = new BLE2902();
+  cgmBackfillCharacteristic->addDescriptor(cgmBackfillNotifications);
+  cgmBackfillCharacteristic->setCallbacks(new BackfillCallbacks());
+  cgmMetricsCharacteristic = new BLECharacteristic(CGM_METRICS_CHARACTERISTIC_UUID, BLECharacteristic::PROPERTY_READ);
+  cgmMetricsCharacteristic->setCallbacks(new MetricsCallbacks());
+  cgmStatsCharacteristic = new BLECharacteristic(CGM_STATS_CHARACTERISTIC_UUID, BLECharacteristic::PROPERTY_READ);
+  cgmStatsCharacteristic->setCallbacks(new StatsCallbacks());
+  cgmRacpCharacteristic = new BLECharacteristic(CGM_RACP_CHARACTERISTIC_UUID, BLECharacteristic::PROPERTY_WRITE | BLECharacteristic::PROPERTY_NOTIFY);
+  cgmRacpNotifications = new BLE2902();
+  cgmRacpCharacteristic->addDescriptor(cgmRacpNotifications);
+  cgmRacpCharacteristic->setCallbacks(new RacpCallbacks());
+  cgmChartCharacteristic = new BLECharacteristic(CGM_CHART_CHARACTERISTIC_UUID, BLECharacteristic::PROPERTY_WRITE | BLECharacteristic::PROPERTY_NOTIFY);
+  cgmChartNotifications = new BLE2902();
+  cgmChartCharacteristic->addDescriptor(cgmChartNotifications);
+  cgmChartCharacteristic->setCallbacks(new ChartCallbacks());
+
+  // stav a zabezpeceni jsou na zacatku sluzby, klient je potrebuje pred ostatnimi
+  cgmService->addCharacteristic(cgmStatusCharacteristic);
+  if (COMPACT_GATT) {
+    cgmService->addCharacteristic(securityValueCharacteristic);
+    cgmService->addCharacteristic(securityActionCharacteristic);
+  }
   cgmService->addCharacteristic(cgmMeasurementCharacteristic);
   cgmService->addCharacteristic(cgmTimeCharacteristic);
+  cgmService->addCharacteristic(cgmRollupCharacteristic);
+  cgmService->addCharacteristic(cgmAckCharacteristic);
+  cgmService->addCharacteristic(cgmAgpCharacteristic);
+  cgmService->addCharacteristic(cgmFormatCharacteristic);
+  cgmService->addCharacteristic(cgmBackfillCharacteristic);
+  cgmService->addCharacteristic(cgmMetricsCharacteristic);
+  cgmService->addCharacteristic(cgmRacpCharacteristic);
+  cgmService->addCharacteristic(cgmChartCharacteristic);
+  cgmService->addCharacteristic(cgmStatsCharacteristic);
   cgmService->start();
 
-  securityService = cgmServer->createService(CGM_SECURITY_SERVICE_UUID);
+  if (!COMPACT_GATT) {
+    securityService = cgmServer->createService(CGM_SECURITY_SERVICE_UUID);
+    securityService->addCharacteristic(securityValueCharacteristic);
+    securityService->addCharacteristic(securityActionCharacteristic);
+    securityService->start();
+  }
 
-  securityValueCharacteristic = new BLECharacteristic(CGM_SECURITY_VALUE_CHARACTERISTIC_UUID, BLECharacteristic::PROPERTY_READ | BLECharacteristic::PROPERTY_WRITE);
-  sprintf(messageBuffer, "%d", server_public_key);
-  securityValueCharacteristic->setValue(messageBuffer);
-  securityActionCharacteristic = new BLECharacteristic(CGM_SECURITY_ACTION_CHARACTERISTIC_UUID, BLECharacteristic::PROPERTY_WRITE | BLECharacteristic::PROPERTY_READ);
-  securityActionCharacteristic->setValue(securityStateValueStrings[static_cast<int>(securityState)]);
+  cgmServer->getAdvertising()->start();
+  bootToAdvertising = micros();
+}
+
+/**
+ * @brief pripoji log ve flash a z jeho mereni obnovi statistiky, urovne agregace
+ * a glykemicky profil, ktere v RAM restart neprezily
+ * 
+ * Pri rychlem startu log pokracuje v relaci pred restartem a cas navazuje na posledni
+ * mereni, jinak zacina nova relace.
+ */
+void restoreMeasurements() {
+  unsigned long mlogStart = micros();
+  if (mlog_init()) {
+    if (SERIAL_DEBUG) {
+      Serial.printf("Measurement log ready in %lu us (%u flash reads)\n", micros() - mlogStart, mlog_recovery_reads());
+    }
+    if (FAST_BOOT && mlog_last(&lastMeasurement)) {
+      timeSinceStart = lastMeasurement.timeOffset + 1;
+      mlog_acknowledge(acknowledged);
+    }
+    else {
+      startSession();
+    }
+  }
+  else if (SERIAL_DEBUG) {
+    Serial.println("Measurement log partition not available");
+  }
+  unsigned long rebuildStart = micros();
+  rebuildAggregates();
+  backfill_init(findRecordAfter);
+  lttb_init(findChartPointAfter);
+  rebuildAgp();
+  bootRebuild = micros() - rebuildStart;
+}
 
-  securityService->addCharacteristic(securityValueCharacteristic);
-  securityService->addCharacteristic(securityActionCharacteristic);
-  securityService->start();
+void setup() {
+  pinMode(PIN_LED_R, OUTPUT);
+  pinMode(PIN_POT_0, INPUT);
 
-  cgmServer->getAdvertising()->start();
+  Serial.begin(115200);
+  Serial.println();
+
+  events = xQueueCreate(EVENT_QUEUE_LENGTH, sizeof(Event));
+
+  // pri rychlem startu se klic obnovi jeste pred advertisingem, klient se tak rovnou autentizuje
+  bool restored = FAST_BOOT && restoreSession();
+  restoreBeaconCounter();
+  if (restored && shared_key != 0) {
+    beacon_derive(shared_key, &beaconKeys);
+    beaconEnabled = true;
+  }
+  if (FAST_BOOT) {
+    startBLE();
+  }
+
+  pinMode(PIN_OLED_RST, OUTPUT);
+  digitalWrite(PIN_OLED_RST, LOW);
+  delay(50);
+  digitalWrite(PIN_OLED_RST, HIGH);
+
+  display.init();
+  display.flipScreenVertically();
+  display.setFont(ArialMT_Plain_10);
+  display.setTextAlignment(TEXT_ALIGN_CENTER);
 
   display.clear();
-  display.drawStringMaxWidth(64, 22, 128, "Advertising started...");
+  display.drawStringMaxWidth(64, 22, 128, "Setting up...");
   display.display();
-  delay(1500);
-}
+  if (!FAST_BOOT) {
+    delay(1500);
+  }
 
-void loop() {
-  pot_0 = analogRead(PIN_POT_0);
-  cgm_interval = map(pot_0, 0, 4095, 1, 10);
+  // mereni prepsana logem drive, nez opustila okno profilu, se z profilu odectou
+  mlog_on_evict(agp_drop);
+  restoreMeasurements();
 
-  if (timeSinceStart % cgm_interval == 0) {
-    if (PATIENT) {
-      String received;
-      int32_t time = 0;
-      int32_t val = 0;
+  if (!FAST_BOOT) {
+    startBLE();
+  }
+  if (SERIAL_DEBUG) {
+    Serial.printf("Boot to advertising in %lu us (session %s)\n", bootToAdvertising, restored ? "restored" : "new");
+  }
 
-      Serial.println("STEP");
-      do {
-        received = Serial.readStringUntil('\n');
-        sscanf(received.c_str(), "OK;%d", &time);
-      } while (time == 0);
+  display.clear();
+  display.drawStringMaxWidth(64, 22, 128, "Advertising started...");
+  display.display();
+  if (!FAST_BOOT) {
+    delay(1500);
+  }
 
-      Serial.println("GET_IG");
-      received = Serial.readStringUntil('\n');
-      sscanf(received.c_str(), "OK;%d", &val);
+  publishSnapshot(true);
+  xTaskCreatePinnedToCore(acquisitionTask, "acquisition", ACQUISITION_STACK_SIZE, NULL, 1, NULL, xPortGetCoreID());
+}
 
-      buffer.push(CGMeasurement{time, val});
+void loop() {
+  CGMeasurement measurement;
+  Event event;
+  bool pending = false;
+
+  // smycka ceka na udalost, pri nedokoncenem prenosu nektereho klienta jen kratce
+  for (uint8_t i = 0; i < CLIENT_MAX_CONNECTIONS; ++i) {
+    Client *client = client_at(i);
+    if (client != NULL && (client->backfillActive || client->racpActive || client->racpResponseLen > 0 || client->chartActive || client->rollupActive || (client->state == STREAM && client->streamBacklog))) {
+      pending = true;
     }
-    else {
-      buffer.push(CGMeasurement{timeSinceStart, random_from_to(750, 1500)});
-    }   
+  }
+  bool handled = false;
+  if (xQueueReceive(events, &event, pdMS_TO_TICKS(pending ? BACKFILL_PAUSE : LOOP_PERIOD)) == pdTRUE) {
+    do {
+      handleEvent(event);
+    } while (xQueueReceive(events, &event, 0) == pdTRUE);
+    handled = true;
   }
 
-  drawScreen(buffer.last(), getStateStr());
+  bool updated = false;
+  while (acquired.pop(&measurement)) {
+    CGMeasurement previous;
 
-  if (securityState == READY) {
-    clientLastTime = atoi(cgmTimeCharacteristic->getValue().c_str());
-    if (clientLastTime == INVALID_TIME) {
-      state = READ;
+    // cas se vratil (simulator pacienta nebo restart) - mereni patri do nove relace
+    if (lastSessionMeasurement(&previous) && measurement.timeOffset <= previous.timeOffset) {
+      startSession();
     }
-    else {
-      state = NOTIFY;
+    // mereni, ktere buffer neumi reprezentovat, se nezaradi do zadne urovne, aby
+    // hledani v bufferu a ve starsich urovnich vracelo stejna mereni
+    if (!buffer.push(measurement)) {
+      droppedMeasurements++;
+      if (SERIAL_DEBUG) {
+        Serial.printf("Measurement %d|%d out of range, dropped\n", measurement.timeOffset, measurement.glucoseValue);
+      }
+      continue;
+    }
+    updated = true;
+    lastMeasurement = measurement;
+    history_push(lastMeasurement);
+    rollup_push(lastMeasurement);
+    stats_push(lastMeasurement);
+    agp_push(lastMeasurement);
+    if (LOSSY_HISTORY) {
+      sdt_push(lastMeasurement);
     }
+    // mereni odmitnute logem zustava v RAM urovnich a zapocita se do ztracenych
+    logError = !mlog_append(lastMeasurement);
+  }
+  if (BEACON_BROADCAST && beaconEnabled && updated) {
+    updateBeacon();
   }
 
-  switch (state) {
-    case INIT: 
-      break;
-  
-    case SECURITY: 
-      processSecurity();
-      break;
+  // displej se prekresli jen pri zmene mereni, zpravy nebo intervalu
+  char *message = logError ? (char *)"Log error" : getStateStr();
+  bool intervalChanged = cgm_interval != screenInterval;
+  if (updated || message != screenMessage || intervalChanged) {
+    screenMessage = message;
+    screenInterval = cgm_interval;
+    drawScreen(lastMeasurement, message);
+  }
 
-    case READ: 
-      setValueAfter(clientLastTime);
-      break;
+  // vsechny relace obsluhuje jedna smycka ze sdileneho uloziste mereni
+  for (uint8_t i = 0; i < CLIENT_MAX_CONNECTIONS; ++i) {
+    Client *client = client_at(i);
+    if (client == NULL) {
+      continue;
+    }
+    serveClient(client);
 
-    case NOTIFY: 
-      if (setValueAfter(clientLastTime)) {
-        cgmTimeCharacteristic->setValue(INVALID_TIME_STR);
-        cgmMeasurementCharacteristic->notify();
-      }
-      break;
+    // kazde spojeni ma fazi podle sve relace - kratky interval pri parovani a prenosu,
+    // jinak dlouhy s vynechanim udalosti
+    bool transfer = client->backfillActive || client->racpActive || client->racpResponseLen > 0 || client->chartActive || client->rollupActive || client->streamBacklog;
+    if (client->state == SECURITY) {
+      link_set_phase(&client->link, LINK_PAIRING, millis());
+    }
+    else {
+      link_set_phase(&client->link, transfer ? LINK_TRANSFER : LINK_IDLE, millis());
+    }
   }
 
-  timeSinceStart++;
-  delay(1000);
-}
\ No newline at end of file
+  flushSession(false);
+  publishSnapshot(handled || updated || intervalChanged);
+}
@@ -0,0 +1,12 @@
+#ifndef MEASUREMENT_H
+#define MEASUREMENT_H
+
+#include <stdint.h>
+
+// datova struktura mereni
+struct CGMeasurement {
+  int32_t timeOffset;
+  int32_t glucoseValue;
+};
+
+#endif
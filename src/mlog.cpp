@@ -0,0 +1,752 @@
+#include "mlog.h"
+
+// hlavicka sektoru - cislo sektoru v poradi zapisu, relace a pocet smazani sektoru
+struct SectorHeader {
+  uint32_t magic;
+  uint32_t seq;
+  uint32_t session;
+  uint32_t eraseCount;
+};
+
+#define CHECKPOINTS_PER_SECTOR (FLASH_SECTOR_SIZE / sizeof(Checkpoint))
+
+// hodnota ridkeho indexu pro sektor, jehoz prvni zaznam jeste nebyl nacten
+#define UNKNOWN_TIME INT32_MIN
+
+static_assert(sizeof(SectorHeader) == MLOG_HEADER_SLOTS * sizeof(LogRecord), "hlavicka musi zabirat presne MLOG_HEADER_SLOTS zaznamu");
+
+static bool mounted = false;
+
+static uint32_t sectorCount = 0;
+static uint32_t tailSector = 0;
+static uint32_t headSector = 0;
+static uint32_t headSlot = MLOG_HEADER_SLOTS;
+static uint32_t headSeq = 0;
+static uint32_t session = 0;
+static uint32_t recordSeq = 0;
+
+static uint32_t checkpointSector = 0;
+static uint32_t checkpointSlot = 0;
+static uint32_t checkpointSeq = 0;
+
+static uint32_t recoveryReads = 0;
+
+// cas posledniho mereni potvrzeneho klienty, pocet nepotvrzenych prepsanych zaznamu
+// a pocet mereni odmitnutych kvuli chybe zapisu
+static int32_t acknowledged = INT32_MIN;
+static uint32_t lostRecords = 0;
+static uint32_t droppedRecords = 0;
+
+// obsluha mereni prepsanych pri zaplneni logu
+static MlogEvictHandler evictHandler = NULL;
+
+// cas posledniho prijateho mereni relace - casy v relaci musi rust
+static int32_t lastAppended = INT32_MIN;
+
+static LogRecord writeBuffer[MLOG_PAGE_RECORDS];
+static uint32_t buffered = 0;
+
+// ridky index - cas a poradove cislo prvniho zaznamu kazdeho sektoru, nacita se az pri prvnim pouziti
+static int32_t sectorFirstTime[MLOG_MAX_SECTORS];
+static uint32_t sectorFirstSeq[MLOG_MAX_SECTORS];
+
+// pozice posledniho zaznamu vraceneho mlog_find_after - postupne cteni logu pokracuje
+// dalsim slotem jednim ctenim flash misto puleni
+static bool cursorValid = false;
+static int32_t cursorTime = 0;
+static uint32_t cursorSector = 0;
+static uint32_t cursorSlot = 0;
+
+static uint32_t crc32(const void *data, size_t len) {
+  static const uint32_t table[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+  };
+  const uint8_t *bytes = (const uint8_t *)data;
+  uint32_t crc = 0xFFFFFFFF;
+
+  for (size_t i = 0; i < len; ++i) {
+    crc = table[(crc ^ bytes[i]) & 0x0F] ^ (crc >> 4);
+    crc = table[(crc ^ (bytes[i] >> 4)) & 0x0F] ^ (crc >> 4);
+  }
+  return ~crc;
+}
+
+static uint32_t slotOffset(uint32_t sector, uint32_t slot) {
+  return sector * FLASH_SECTOR_SIZE + slot * sizeof(LogRecord);
+}
+
+static bool readHeader(uint32_t sector, SectorHeader *header) {
+  return flash_read(sector * FLASH_SECTOR_SIZE, header, sizeof(SectorHeader)) && header->magic == MLOG_MAGIC;
+}
+
+static bool recordValid(const LogRecord *record) {
+  return record->crc == crc32(record, offsetof(LogRecord, crc));
+}
+
+static bool recordErased(const LogRecord *record) {
+  const uint8_t *bytes = (const uint8_t *)record;
+  for (size_t i = 0; i < sizeof(LogRecord); ++i) {
+    if (bytes[i] != 0xFF) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool readRecord(uint32_t sector, uint32_t slot, LogRecord *record) {
+  return flash_read(slotOffset(sector, slot), record, sizeof(LogRecord)) && recordValid(record);
+}
+
+// stranka v RAM bufferu je plna a ceka na zapis do flash
+static bool pageFull() {
+  return buffered > 0 && (headSlot + buffered) % MLOG_PAGE_RECORDS == 0;
+}
+
+static uint32_t sessionSectors() {
+  return (headSector + sectorCount - tailSector) % sectorCount + 1;
+}
+
+// pocet sektoru relace, ktere obsahuji alespon jeden zapsany zaznam
+static uint32_t indexedSectors() {
+  return (headSlot == MLOG_HEADER_SLOTS) ? sessionSectors() - 1 : sessionSectors();
+}
+
+static uint32_t sectorAt(uint32_t position) {
+  return (tailSector + position) % sectorCount;
+}
+
+static int32_t firstTimeAt(uint32_t position) {
+  uint32_t sector = sectorAt(position);
+  if (sectorFirstTime[sector] == UNKNOWN_TIME) {
+    LogRecord record;
+    sectorFirstTime[sector] = readRecord(sector, MLOG_HEADER_SLOTS, &record) ? record.timeOffset : INT32_MAX;
+    sectorFirstSeq[sector] = record.seq;
+  }
+  return sectorFirstTime[sector];
+}
+
+/**
+ * @brief poradove cislo prvniho zaznamu sektoru na dane pozici relace
+ * 
+ * Poradova cisla v relaci navazuji i pres opustene konce sektoru (preruseny zapis),
+ * pocty zaznamu se proto urci jejich rozdilem a neplatne sloty se nezapocitaji.
+ * 
+ * @return pro pozici za poslednim zapsanym sektorem cislo pristiho zaznamu ve flash
+ */
+static uint32_t firstSeqAt(uint32_t position) {
+  if (position >= indexedSectors()) {
+    return recordSeq - buffered;
+  }
+  if (firstTimeAt(position) == INT32_MAX) {
+    // sektor bez platneho zaznamu
+    return firstSeqAt(position + 1);
+  }
+  return sectorFirstSeq[sectorAt(position)];
+}
+
+// konec zapsanych slotu sektoru
+static uint32_t sectorEnd(uint32_t sector) {
+  return (sector == headSector) ? headSlot : MLOG_SLOTS_PER_SECTOR;
+}
+
+/**
+ * @brief precte zaznam sektoru na dane pozici relace, pokud do logu patri
+ * 
+ * Zaznamy s platnym CRC za poskozenym zaznamem (preruseny zapis) sektor opustil,
+ * jejich poradova cisla uz nesou zaznamy nasledujicich sektoru.
+ */
+static bool readLiveRecord(uint32_t position, uint32_t slot, LogRecord *record) {
+  return readRecord(sectorAt(position), slot, record) && record->seq < firstSeqAt(position + 1);
+}
+
+/**
+ * @brief najde v sektoru na dane pozici relace prvni zaznam novejsi nez zadany cas
+ * 
+ * Neplatne a opustene zaznamy na konci sektoru (preruseny zapis) se chovaji jako
+ * novejsi nez jakykoli cas.
+ * 
+ * @return index slotu, pripadne konec sektoru, pokud takovy zaznam neexistuje
+ */
+static uint32_t slotAfter(uint32_t position, int32_t time) {
+  LogRecord record;
+  uint32_t low = MLOG_HEADER_SLOTS;
+  uint32_t high = sectorEnd(sectorAt(position));
+
+  while (low < high) {
+    uint32_t mid = (low + high) / 2;
+    if (!readLiveRecord(position, mid, &record) || record.timeOffset > time) {
+      high = mid;
+    }
+    else {
+      low = mid + 1;
+    }
+  }
+  return low;
+}
+
+static void writeCheckpoint() {
+  if (checkpointSlot == CHECKPOINTS_PER_SECTOR) {
+    checkpointSector = (checkpointSector == sectorCount) ? sectorCount + 1 : sectorCount;
+    checkpointSlot = 0;
+    flash_erase_sector(checkpointSector);
+  }
+
+  Checkpoint checkpoint = {MLOG_CHECKPOINT_MAGIC, ++checkpointSeq, session, headSeq, headSector, tailSector, recordSeq, 0};
+  checkpoint.crc = crc32(&checkpoint, offsetof(Checkpoint, crc));
+  flash_write(checkpointSector * FLASH_SECTOR_SIZE + checkpointSlot * sizeof(Checkpoint), &checkpoint, sizeof(Checkpoint));
+  checkpointSlot++;
+}
+
+/**
+ * @brief najde posledni platny kontrolni bod v jednom sektoru kontrolnich bodu
+ * 
+ * Kontrolni body se zapisuji postupne, posledni zapsany se najde pulenim.
+ * Preruseny zapis posledniho bodu se pozna podle CRC a pouzije se predchozi.
+ */
+static bool lastCheckpoint(uint32_t sector, Checkpoint *checkpoint, uint32_t *written) {
+  uint32_t low = 0;
+  uint32_t high = CHECKPOINTS_PER_SECTOR;
+  while (low < high) {
+    uint32_t mid = (low + high) / 2;
+    recoveryReads++;
+    if (flash_read(sector * FLASH_SECTOR_SIZE + mid * sizeof(Checkpoint), checkpoint, sizeof(Checkpoint)) && checkpoint->magic != 0xFFFFFFFF) {
+      low = mid + 1;
+    }
+    else {
+      high = mid;
+    }
+  }
+  *written = low;
+
+  while (low-- > 0) {
+    recoveryReads++;
+    if (flash_read(sector * FLASH_SECTOR_SIZE + low * sizeof(Checkpoint), checkpoint, sizeof(Checkpoint)) &&
+        checkpoint->magic == MLOG_CHECKPOINT_MAGIC && checkpoint->crc == crc32(checkpoint, offsetof(Checkpoint, crc))) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief smaze dalsi sektor v kruhu, zapise do nej hlavicku a kontrolni bod
+ * 
+ * Log se zapisuje do sektoru dokola, kazdy sektor se tedy maze stejne casto (wear levelling).
+ */
+static bool openSector(uint32_t sector) {
+  SectorHeader header;
+  uint32_t eraseCount = readHeader(sector, &header) ? header.eraseCount + 1 : 1;
+
+  if (!flash_erase_sector(sector)) {
+    return false;
+  }
+
+  header = SectorHeader{MLOG_MAGIC, ++headSeq, session, eraseCount};
+  if (cursorSector == sector) {
+    cursorValid = false;
+  }
+  headSector = sector;
+  headSlot = MLOG_HEADER_SLOTS;
+  sectorFirstTime[sector] = UNKNOWN_TIME;
+  if (!flash_write(sector * FLASH_SECTOR_SIZE, &header, sizeof(SectorHeader))) {
+    return false;
+  }
+  writeCheckpoint();
+  return true;
+}
+
+// posune zacatek relace, pokud hlava v kruhu dobehla nejstarsi sektor
+static void evictTailBefore(uint32_t sector) {
+  if (sector == tailSector) {
+    tailSector = (tailSector + 1) % sectorCount;
+  }
+}
+
+/**
+ * @brief preda obsluze vyrazeni vsechna mereni nejstarsiho sektoru relace, cte se
+ * po strankach
+ * 
+ */
+static void reportEvicted() {
+  LogRecord page[MLOG_PAGE_RECORDS];
+  uint32_t end = firstSeqAt(1);
+  uint32_t slot = MLOG_HEADER_SLOTS;
+
+  while (slot < MLOG_SLOTS_PER_SECTOR) {
+    uint32_t count = MLOG_PAGE_RECORDS - slot % MLOG_PAGE_RECORDS;
+    if (!flash_read(slotOffset(tailSector, slot), page, count * sizeof(LogRecord))) {
+      return;
+    }
+    for (uint32_t i = 0; i < count; ++i) {
+      if (recordValid(&page[i]) && page[i].seq < end) {
+        evictHandler(CGMeasurement{page[i].timeOffset, page[i].glucoseValue});
+      }
+    }
+    slot += count;
+  }
+}
+
+static bool openNextSector() {
+  LogRecord record;
+  uint32_t next = (headSector + 1) % sectorCount;
+  if (next == tailSector) {
+    uint32_t slot = slotAfter(0, acknowledged);
+    if (slot < MLOG_SLOTS_PER_SECTOR && readLiveRecord(0, slot, &record)) {
+      lostRecords += firstSeqAt(1) - record.seq;
+    }
+    if (evictHandler != NULL) {
+      reportEvicted();
+    }
+  }
+  evictTailBefore(next);
+  return openSector(next);
+}
+
+/**
+ * @brief dohleda zaznamy zapsane po poslednim kontrolnim bodu
+ * 
+ * Cte se od aktualni pozice hlavy, dokud zaznamy navazuji poradovym cislem
+ * a maji platne CRC, pripadne pokracuje do dalsiho sektoru stejne relace.
+ */
+static void scanTail() {
+  LogRecord page[MLOG_PAGE_RECORDS];
+
+  while (true) {
+    while (headSlot < MLOG_SLOTS_PER_SECTOR) {
+      uint32_t count = MLOG_PAGE_RECORDS - headSlot % MLOG_PAGE_RECORDS;
+      recoveryReads++;
+      if (!flash_read(slotOffset(headSector, headSlot), page, count * sizeof(LogRecord))) {
+        return;
+      }
+      for (uint32_t i = 0; i < count; ++i) {
+        if (!recordValid(&page[i]) || page[i].seq != recordSeq) {
+          // preruseny zapis - zbytek sektoru se jiz nepouzije
+          if (!recordErased(&page[i])) {
+            headSlot = MLOG_SLOTS_PER_SECTOR;
+          }
+          return;
+        }
+        recordSeq++;
+        headSlot++;
+      }
+    }
+
+    SectorHeader header;
+    uint32_t next = (headSector + 1) % sectorCount;
+    recoveryReads++;
+    if (!readHeader(next, &header) || header.session != session || header.seq != headSeq + 1) {
+      return;
+    }
+    evictTailBefore(next);
+    headSector = next;
+    headSeq = header.seq;
+    headSlot = MLOG_HEADER_SLOTS;
+  }
+}
+
+/**
+ * @brief obnovi stav logu z posledniho kontrolniho bodu
+ * 
+ * @return false log nema platny kontrolni bod
+ */
+static bool recoverFromCheckpoint() {
+  Checkpoint checkpoint;
+  Checkpoint other;
+  uint32_t written;
+  uint32_t otherWritten;
+
+  bool found = lastCheckpoint(sectorCount, &checkpoint, &written);
+  if (lastCheckpoint(sectorCount + 1, &other, &otherWritten) && (!found || other.checkpointSeq > checkpoint.checkpointSeq)) {
+    checkpoint = other;
+    checkpointSector = sectorCount + 1;
+    checkpointSlot = otherWritten;
+  }
+  else if (found) {
+    checkpointSector = sectorCount;
+    checkpointSlot = written;
+  }
+  else {
+    return false;
+  }
+  if (checkpoint.headSector >= sectorCount || checkpoint.tailSector >= sectorCount) {
+    return false;
+  }
+
+  checkpointSeq = checkpoint.checkpointSeq;
+  session = checkpoint.session;
+  headSeq = checkpoint.headSeq;
+  headSector = checkpoint.headSector;
+  tailSector = checkpoint.tailSector;
+  headSlot = MLOG_HEADER_SLOTS;
+  recordSeq = checkpoint.recordSeq;
+  return true;
+}
+
+/**
+ * @brief obnovi stav logu ctenim hlavicek vsech sektoru (log bez kontrolniho bodu)
+ * 
+ * @return false oddil neobsahuje zadny sektor logu
+ */
+static bool recoverFromHeaders() {
+  SectorHeader header;
+  LogRecord record;
+  bool found = false;
+
+  for (uint32_t i = 0; i < sectorCount; ++i) {
+    recoveryReads++;
+    if (readHeader(i, &header) && (!found || header.seq > headSeq)) {
+      found = true;
+      headSector = i;
+      headSeq = header.seq;
+      session = header.session;
+    }
+  }
+  if (!found) {
+    return false;
+  }
+
+  // nejstarsi sektor relace - sektory pred hlavou se stejnou relaci a navazujicim poradim
+  tailSector = headSector;
+  uint32_t seq = headSeq;
+  for (uint32_t i = 1; i < sectorCount; ++i) {
+    uint32_t previous = (headSector + sectorCount - i) % sectorCount;
+    recoveryReads++;
+    if (!readHeader(previous, &header) || header.session != session || header.seq != seq - 1) {
+      break;
+    }
+    tailSector = previous;
+    seq = header.seq;
+  }
+
+  headSlot = MLOG_HEADER_SLOTS;
+  recordSeq = readRecord(headSector, MLOG_HEADER_SLOTS, &record) ? record.seq : 0;
+  checkpointSector = sectorCount;
+  checkpointSlot = CHECKPOINTS_PER_SECTOR;
+  return true;
+}
+
+/**
+ * @brief funkce pripojujici log - obnovi stav z posledniho kontrolniho bodu a dohleda
+ * zaznamy zapsane po nem, pri chybejicim kontrolnim bodu prohleda hlavicky sektoru
+ * 
+ * @return true log je pripraven k zapisu
+ * @return false oddil pro log neexistuje nebo jej nelze zapsat
+ */
+bool mlog_init() {
+  recoveryReads = 0;
+  buffered = 0;
+  cursorValid = false;
+  if (!flash_init()) {
+    return false;
+  }
+  sectorCount = flash_size() / FLASH_SECTOR_SIZE;
+  if (sectorCount > MLOG_MAX_SECTORS + MLOG_CHECKPOINT_SECTORS) {
+    sectorCount = MLOG_MAX_SECTORS + MLOG_CHECKPOINT_SECTORS;
+  }
+  if (sectorCount < 2 + MLOG_CHECKPOINT_SECTORS) {
+    return false;
+  }
+  sectorCount -= MLOG_CHECKPOINT_SECTORS;
+
+  for (uint32_t i = 0; i < sectorCount; ++i) {
+    sectorFirstTime[i] = UNKNOWN_TIME;
+  }
+
+  CGMeasurement last;
+  lastAppended = INT32_MIN;
+  if (!recoverFromCheckpoint() && !recoverFromHeaders()) {
+    headSeq = 0;
+    session = 1;
+    recordSeq = 0;
+    tailSector = 0;
+    headSector = 0;
+    checkpointSector = sectorCount;
+    checkpointSlot = CHECKPOINTS_PER_SECTOR;
+    mounted = openSector(0);
+    return mounted;
+  }
+
+  scanTail();
+
+  mounted = true;
+  if (mlog_last(&last)) {
+    lastAppended = last.timeOffset;
+  }
+  if (headSlot == MLOG_SLOTS_PER_SECTOR) {
+    mounted = openNextSector();
+  }
+  return mounted;
+}
+
+/**
+ * @brief zahaji novou relaci - zaznamy predchozich relaci uz nejsou dostupne
+ * 
+ */
+void mlog_new_session() {
+  if (!mounted) {
+    return;
+  }
+  if (!mlog_flush()) {
+    // nezapsana stranka patri predchozi relaci, do nove se zapsat nesmi
+    droppedRecords += buffered;
+    buffered = 0;
+  }
+  session++;
+  cursorValid = false;
+  acknowledged = INT32_MIN;
+  lastAppended = INT32_MIN;
+  tailSector = (headSector + 1) % sectorCount;
+  mounted = openSector(tailSector);
+}
+
+/**
+ * @brief prida mereni do logu, do flash se zapise po naplneni stranky
+ * 
+ * Plna stranka, jejiz zapis drive selhal, se nejdrive zapise znovu. Pokud zapis
+ * selze i tentokrat, mereni se odmitne a buffer se nepreplni. Mereni, jehoz cas
+ * nenavazuje na posledni mereni relace, se odmitne - cas, ktery se vratil, patri
+ * do nove relace (mlog_new_session).
+ * 
+ * @param measurement mereni k ulozeni
+ * @return true mereni bylo prijato
+ * @return false log neni pripojen, nelze zapsat predchozi stranku nebo cas mereni
+ * neni novejsi nez posledni mereni relace
+ */
+bool mlog_append(CGMeasurement measurement) {
+  if (measurement.timeOffset <= lastAppended) {
+    return false;
+  }
+  if (!mounted || (pageFull() && !mlog_flush())) {
+    droppedRecords++;
+    return false;
+  }
+  LogRecord *record = &writeBuffer[buffered++];
+  *record = LogRecord{measurement.timeOffset, measurement.glucoseValue, recordSeq++, 0};
+  record->crc = crc32(record, offsetof(LogRecord, crc));
+  lastAppended = measurement.timeOffset;
+  if (pageFull()) {
+    mlog_flush();
+  }
+  return true;
+}
+
+/**
+ * @brief zapise zaznamy z RAM bufferu do flash
+ * 
+ */
+bool mlog_flush() {
+  if (!mounted || buffered == 0) {
+    return mounted;
+  }
+  if (!flash_write(slotOffset(headSector, headSlot), writeBuffer, buffered * sizeof(LogRecord))) {
+    return false;
+  }
+  if (headSlot == MLOG_HEADER_SLOTS) {
+    sectorFirstTime[headSector] = writeBuffer[0].timeOffset;
+    sectorFirstSeq[headSector] = writeBuffer[0].seq;
+  }
+  headSlot += buffered;
+  buffered = 0;
+  if (headSlot == MLOG_SLOTS_PER_SECTOR) {
+    mounted = openNextSector();
+  }
+  return mounted;
+}
+
+/**
+ * @brief najde v logu prvni mereni nasledujici po zadanem case
+ * 
+ * Casy mereni jsou monotonni - sektor se najde pulenim ridkeho indexu v RAM
+ * a zaznam pulenim uvnitr sektoru, cena je tedy O(log n) cteni flash.
+ * Pokud sektor konci neplatnymi zaznamy, hledani pokracuje dalsim sektorem.
+ * 
+ * @param time cas posledniho mereni, ktere ma klient k dispozici
+ * @param measurement nalezene mereni
+ * @return true nasledujici mereni bylo nalezeno
+ * @return false zadne nasledujici mereni neni k dispozici
+ */
+bool mlog_find_after(int32_t time, CGMeasurement *measurement) {
+  LogRecord record;
+
+  if (!mounted) {
+    return false;
+  }
+
+  // navazujici dotaz (cas posledniho vraceneho zaznamu) precte jen nasledujici slot
+  if (cursorValid && time == cursorTime) {
+    uint32_t position = (cursorSector + sectorCount - tailSector) % sectorCount;
+    if (cursorSlot + 1 < sectorEnd(cursorSector) && readLiveRecord(position, cursorSlot + 1, &record) && record.timeOffset > time) {
+      cursorSlot++;
+      cursorTime = record.timeOffset;
+      *measurement = CGMeasurement{record.timeOffset, record.glucoseValue};
+      return true;
+    }
+  }
+
+  // prvni sektor, jehoz prvni zaznam je novejsi nez zadany cas
+  uint32_t sectors = indexedSectors();
+  uint32_t low = 0;
+  uint32_t high = sectors;
+  while (low < high) {
+    uint32_t mid = (low + high) / 2;
+    if (firstTimeAt(mid) > time) {
+      high = mid;
+    }
+    else {
+      low = mid + 1;
+    }
+  }
+
+  // hledany zaznam muze lezet jeste v predchozim sektoru
+  if (low > 0) {
+    uint32_t sector = sectorAt(low - 1);
+    uint32_t slot = slotAfter(low - 1, time);
+    if (slot < sectorEnd(sector) && readLiveRecord(low - 1, slot, &record)) {
+      *measurement = CGMeasurement{record.timeOffset, record.glucoseValue};
+      cursorValid = true;
+      cursorTime = record.timeOffset;
+      cursorSector = sector;
+      cursorSlot = slot;
+      return true;
+    }
+  }
+  for (; low < sectors; ++low) {
+    if (readRecord(sectorAt(low), MLOG_HEADER_SLOTS, &record)) {
+      *measurement = CGMeasurement{record.timeOffset, record.glucoseValue};
+      cursorValid = true;
+      cursorTime = record.timeOffset;
+      cursorSector = sectorAt(low);
+      cursorSlot = MLOG_HEADER_SLOTS;
+      return true;
+    }
+  }
+
+  for (uint32_t i = 0; i < buffered; ++i) {
+    if (writeBuffer[i].timeOffset > time) {
+      *measurement = CGMeasurement{writeBuffer[i].timeOffset, writeBuffer[i].glucoseValue};
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief spocita zaznamy logu novejsi nez zadany cas
+ * 
+ * Prvni novejsi zaznam se najde pulenim ridkeho indexu a pulenim uvnitr sektoru,
+ * pocet je rozdil jeho poradoveho cisla a cisla pristiho zaznamu - O(log n) cteni
+ * flash. Neplatne zaznamy na konci sektoru (preruseny zapis) se nezapocitaji.
+ * 
+ * @param time cas, od ktereho se zaznamy pocitaji (bez nej)
+ * @param count pocet novejsich zaznamu
+ * @return false log neni pripojen
+ */
+bool mlog_count_after(int32_t time, uint32_t *count) {
+  if (!mounted) {
+    return false;
+  }
+
+  uint32_t sectors = indexedSectors();
+  uint32_t low = 0;
+  uint32_t high = sectors;
+  while (low < high) {
+    uint32_t mid = (low + high) / 2;
+    if (firstTimeAt(mid) > time) {
+      high = mid;
+    }
+    else {
+      low = mid + 1;
+    }
+  }
+
+  // hledany zaznam muze lezet jeste v predchozim sektoru, jinak je prvnim zaznamem nalezeneho
+  uint32_t first = firstSeqAt(low);
+  if (low > 0) {
+    LogRecord record;
+    uint32_t slot = slotAfter(low - 1, time);
+    if (slot < sectorEnd(sectorAt(low - 1)) && readLiveRecord(low - 1, slot, &record)) {
+      first = record.seq;
+    }
+  }
+  *count = recordSeq - first;
+
+  // vsechny zaznamy ve flash jsou starsi - z RAM bufferu se pocitaji jen novejsi
+  if (first == recordSeq - buffered) {
+    for (uint32_t i = 0; i < buffered && writeBuffer[i].timeOffset <= time; ++i) {
+      (*count)--;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief vrati nejnovejsi mereni logu, napr. k navazani na relaci po restartu
+ * 
+ * @param measurement posledni zapsane mereni
+ * @return false log neobsahuje zadne mereni
+ */
+bool mlog_last(CGMeasurement *measurement) {
+  LogRecord record;
+
+  if (!mounted) {
+    return false;
+  }
+  if (buffered > 0) {
+    *measurement = CGMeasurement{writeBuffer[buffered - 1].timeOffset, writeBuffer[buffered - 1].glucoseValue};
+    return true;
+  }
+
+  // neplatne zaznamy se chovaji jako nejnovejsi, pulenim se tak najde konec platnych zaznamu
+  for (uint32_t position = indexedSectors(); position > 0; --position) {
+    uint32_t slot = slotAfter(position - 1, INT32_MAX);
+    if (slot > MLOG_HEADER_SLOTS && readRecord(sectorAt(position - 1), slot - 1, &record)) {
+      *measurement = CGMeasurement{record.timeOffset, record.glucoseValue};
+      return true;
+    }
+  }
+  return false;
+}
+
+uint32_t mlog_size() {
+  return mounted ? recordSeq - firstSeqAt(0) : 0;
+}
+
+/**
+ * @brief pocet cteni flash potrebnych pri poslednim pripojeni logu
+ * 
+ */
+uint32_t mlog_recovery_reads() {
+  return recoveryReads;
+}
+
+/**
+ * @brief nastavi obsluhu mereni, ktera log pri zaplneni prepise
+ * 
+ * @param handler funkce volana pro kazde prepsane mereni od nejstarsiho, NULL bez obsluhy
+ */
+void mlog_on_evict(MlogEvictHandler handler) {
+  evictHandler = handler;
+}
+
+/**
+ * @brief nastavi cas posledniho mereni potvrzeneho klienty
+ * 
+ * Zaznamy novejsi nez tento cas, ktere log pri zaplneni prepise, se pocitaji jako ztracene.
+ * 
+ * @param time cas posledniho potvrzeneho mereni
+ */
+void mlog_acknowledge(int32_t time) {
+  if (time > acknowledged) {
+    acknowledged = time;
+  }
+}
+
+/**
+ * @brief pocet mereni, ktera v logu chybi - nepotvrzene zaznamy, ktere log prepsal,
+ * a mereni odmitnuta kvuli chybe zapisu
+ * 
+ */
+uint32_t mlog_lost() {
+  return lostRecords + droppedRecords;
+}
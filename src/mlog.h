@@ -0,0 +1,82 @@
+#ifndef MLOG_H
+#define MLOG_H
+
+#include <stdint.h>
+#include "flash.h"
+#include "measurement.h"
+
+/* PARAMETRY LOGU MERENI */
+
+#define MLOG_MAGIC 0x474F4C4D
+#define MLOG_CHECKPOINT_MAGIC 0x54504B43
+
+/**
+ * Zaznam logu - mereni, poradove cislo zaznamu a CRC32 predchozich polozek.
+ * Zaznam s chybnym CRC nebo nenavazujicim poradovym cislem (preruseny zapis)
+ * ukoncuje platnou cast logu.
+ */
+struct LogRecord {
+  int32_t timeOffset;
+  int32_t glucoseValue;
+  uint32_t seq;
+  uint32_t crc;
+};
+
+// kontrolni bod - stav logu v okamziku otevreni sektoru
+struct Checkpoint {
+  uint32_t magic;
+  uint32_t checkpointSeq;
+  uint32_t session;
+  uint32_t headSeq;
+  uint32_t headSector;
+  uint32_t tailSector;
+  uint32_t recordSeq;
+  uint32_t crc;
+};
+
+// kazdy sektor zacina hlavickou o velikosti jednoho zaznamu, zbytek tvori zaznamy mereni
+#define MLOG_SLOTS_PER_SECTOR (FLASH_SECTOR_SIZE / sizeof(LogRecord))
+#define MLOG_HEADER_SLOTS 1
+#define MLOG_RECORDS_PER_SECTOR (MLOG_SLOTS_PER_SECTOR - MLOG_HEADER_SLOTS)
+
+// posledni dva sektory oddilu stridave drzi kontrolni body (checkpointy) logu
+#define MLOG_CHECKPOINT_SECTORS 2
+
+// nejvetsi podporovany pocet sektoru oddilu (velikost ridkeho indexu v RAM)
+#define MLOG_MAX_SECTORS 512
+
+// zaznamy se v RAM hromadi a do flash se programuji po celych strankach
+#define MLOG_PAGE_RECORDS (FLASH_PAGE_SIZE / sizeof(LogRecord))
+
+// obsluha mereni, ktera log pri zaplneni prepise - dostane je od nejstarsiho pred smazanim
+// sektoru, odvozene urovne (glykemicky profil) je tak mohou odecist
+typedef void (*MlogEvictHandler)(CGMeasurement measurement);
+
+
+/* FUNKCE LOGU MERENI */
+
+bool mlog_init();
+
+void mlog_new_session();
+
+bool mlog_append(CGMeasurement measurement);
+
+bool mlog_flush();
+
+bool mlog_find_after(int32_t time, CGMeasurement *measurement);
+
+bool mlog_last(CGMeasurement *measurement);
+
+bool mlog_count_after(int32_t time, uint32_t *count);
+
+uint32_t mlog_size();
+
+uint32_t mlog_recovery_reads();
+
+void mlog_acknowledge(int32_t time);
+
+void mlog_on_evict(MlogEvictHandler handler);
+
+uint32_t mlog_lost();
+
+#endif
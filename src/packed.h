@@ -0,0 +1,160 @@
+#ifndef PACKED_H
+#define PACKED_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "measurement.h"
+
+/**
+ * Sloupec hodnot o sirce BITS bitu ulozenych tesne za sebou.
+ * Pristup se prelozi na cteni dvou slov, posun a masku.
+ */
+template<uint8_t BITS, size_t N> class PackedColumn {
+public:
+  static constexpr uint32_t mask = (BITS == 32) ? UINT32_MAX : ((uint32_t)1 << BITS) - 1;
+
+  inline uint32_t get(size_t index) const {
+    size_t bit = index * BITS;
+    uint64_t pair = ((uint64_t)words[(bit >> 5) + 1] << 32) | words[bit >> 5];
+    return (uint32_t)(pair >> (bit & 31)) & mask;
+  }
+
+  inline void set(size_t index, uint32_t value) {
+    size_t bit = index * BITS;
+    uint64_t pair = ((uint64_t)words[(bit >> 5) + 1] << 32) | words[bit >> 5];
+    pair &= ~((uint64_t)mask << (bit & 31));
+    pair |= (uint64_t)(value & mask) << (bit & 31);
+    words[bit >> 5] = (uint32_t)pair;
+    words[(bit >> 5) + 1] = (uint32_t)(pair >> 32);
+  }
+
+private:
+  // posledni slovo je rezerva, aby cteni dvojice slov nepreteklo
+  uint32_t words[(N * BITS + 31) / 32 + 1] = { 0 };
+};
+
+/**
+ * Kruhovy buffer mereni ve tvaru struktury poli - casy relativne k zakladu bufferu
+ * a hodnoty jsou v oddelenych bitove pakovanych sloupcich. Hledani podle casu tak
+ * cte pouze sloupec casu. Mereni, ktere nelze reprezentovat (hodnota mimo rozsah
+ * VALUE_BITS nebo cas starsi nez posledni mereni), push odmitne a vrati false, obsah
+ * bufferu zustane. Mereni, ktera s novym casem nelze drzet v rozsahu TIME_BITS, se
+ * zahodi jako nejstarsi.
+ */
+template<size_t N, uint8_t TIME_BITS = 20, uint8_t VALUE_BITS = 12> class PackedSeries {
+  static_assert((N & (N - 1)) == 0, "kapacita musi byt mocninou dvou");
+
+public:
+  bool push(CGMeasurement measurement) {
+    if (measurement.glucoseValue < 0 || (uint32_t)measurement.glucoseValue > values.mask) {
+      return false;
+    }
+    if (count > 0 && measurement.timeOffset < last().timeOffset) {
+      return false;
+    }
+
+    if (count > 0 && (int64_t)measurement.timeOffset - baseTime > times.mask) {
+      // zahodi mereni starsi nez nejstarsi cas, ktery se s novym vejde do sloupce
+      int64_t oldest = (int64_t)measurement.timeOffset - times.mask;
+      size_t expired = (oldest - 1 < timeAt(0)) ? 0 : upperBound((int32_t)(oldest - 1));
+      head = (head + expired) & (N - 1);
+      count -= expired;
+      rebase();
+    }
+    if (count == N) {
+      head = (head + 1) & (N - 1);
+      count--;
+    }
+    if (count == 0) {
+      baseTime = measurement.timeOffset;
+    }
+
+    uint32_t relative = (uint32_t)((int64_t)measurement.timeOffset - baseTime);
+    size_t slot = (head + count++) & (N - 1);
+    times.set(slot, (uint32_t)relative);
+    values.set(slot, (uint32_t)measurement.glucoseValue);
+    return true;
+  }
+
+  inline int32_t timeAt(size_t index) const {
+    return baseTime + (int32_t)times.get((head + index) & (N - 1));
+  }
+
+  inline CGMeasurement operator [] (size_t index) const {
+    size_t slot = (head + index) & (N - 1);
+    return CGMeasurement{baseTime + (int32_t)times.get(slot), (int32_t)values.get(slot)};
+  }
+
+  /**
+   * Vrati index prvniho mereni s casem vetsim nez time, pripadne size().
+   */
+  size_t upperBound(int32_t time) const {
+    if (time < baseTime) {
+      return 0;
+    }
+    uint32_t relative = (uint32_t)((int64_t)time - baseTime);
+    size_t low = 0;
+    size_t high = count;
+    while (low < high) {
+      size_t mid = (low + high) / 2;
+      if (times.get((head + mid) & (N - 1)) > relative) {
+        high = mid;
+      }
+      else {
+        low = mid + 1;
+      }
+    }
+    return low;
+  }
+
+  inline CGMeasurement first() const {
+    return (*this)[0];
+  }
+
+  inline CGMeasurement last() const {
+    return (*this)[count - 1];
+  }
+
+  inline size_t size() const {
+    return count;
+  }
+
+  inline bool isEmpty() const {
+    return count == 0;
+  }
+
+  inline void clear() {
+    head = 0;
+    count = 0;
+  }
+
+  // zahodi nejstarsi mereni
+  inline void dropFirst() {
+    if (count > 0) {
+      head = (head + 1) & (N - 1);
+      count--;
+    }
+  }
+
+private:
+  // posune zaklad casu na nejstarsi mereni, aby se do sloupce vesly novejsi casy
+  void rebase() {
+    if (count == 0) {
+      return;
+    }
+    uint32_t shift = times.get(head);
+    for (size_t i = 0; i < count; ++i) {
+      size_t slot = (head + i) & (N - 1);
+      times.set(slot, times.get(slot) - shift);
+    }
+    baseTime += (int32_t)shift;
+  }
+
+  PackedColumn<TIME_BITS, N> times;
+  PackedColumn<VALUE_BITS, N> values;
+  int32_t baseTime = 0;
+  size_t head = 0;
+  size_t count = 0;
+};
+
+#endif
@@ -0,0 +1,105 @@
+#include "bytes.h"
+#include "racp.h"
+
+static int32_t getTime(const uint8_t *src) {
+  uint32_t value = getLE(src, 4);
+  return (value > INT32_MAX) ? INT32_MAX : (int32_t)value;
+}
+
+/**
+ * @brief overi pozadavek a prevede operator na casovy interval
+ * 
+ * @param src zapsana hodnota kontrolniho bodu
+ * @param len delka hodnoty
+ * @param request rozebrany pozadavek
+ * @return RACP_SUCCESS nebo kod odpovedi s chybou
+ */
+uint8_t racp_parse(const uint8_t *src, size_t len, RacpRequest *request) {
+  request->opcode = (len > 0) ? src[0] : 0;
+  request->op = (len > 1) ? src[1] : RACP_NULL;
+  request->from = INT32_MIN;
+  request->to = INT32_MAX;
+
+  // nepodporovany operacni kod se hlasi i u pozadavku bez operatoru
+  switch (request->opcode) {
+    case RACP_ABORT: 
+      return (request->op == RACP_NULL && len == 2) ? RACP_SUCCESS : RACP_INVALID_OPERATOR;
+
+    case RACP_REPORT: 
+    case RACP_DELETE: 
+    case RACP_REPORT_COUNT: 
+      break;
+
+    default: 
+      return RACP_OPCODE_NOT_SUPPORTED;
+  }
+  if (len < 2) {
+    return RACP_INVALID_OPERATOR;
+  }
+
+  switch (request->op) {
+    case RACP_ALL: 
+    case RACP_FIRST: 
+    case RACP_LAST: 
+      return (len == 2) ? RACP_SUCCESS : RACP_INVALID_OPERAND;
+
+    case RACP_LESS_OR_EQUAL: 
+    case RACP_GREATER_OR_EQUAL: 
+    case RACP_WITHIN: 
+      break;
+
+    case RACP_NULL: 
+      return RACP_INVALID_OPERATOR;
+
+    default: 
+      return RACP_OPERATOR_NOT_SUPPORTED;
+  }
+
+  if (len < 3 || src[2] != RACP_FILTER_TIME_OFFSET) {
+    return (len < 3) ? RACP_INVALID_OPERAND : RACP_OPERAND_NOT_SUPPORTED;
+  }
+  if (request->op == RACP_WITHIN) {
+    if (len != 11) {
+      return RACP_INVALID_OPERAND;
+    }
+    request->from = getTime(src + 3);
+    request->to = getTime(src + 7);
+    return (request->from <= request->to) ? RACP_SUCCESS : RACP_INVALID_OPERAND;
+  }
+  if (len != 7) {
+    return RACP_INVALID_OPERAND;
+  }
+  if (request->op == RACP_LESS_OR_EQUAL) {
+    request->to = getTime(src + 3);
+  }
+  else {
+    request->from = getTime(src + 3);
+  }
+  return RACP_SUCCESS;
+}
+
+/**
+ * @brief zakoduje odpoved s vysledkem pozadavku
+ * 
+ */
+size_t racp_response(uint8_t opcode, uint8_t code, uint8_t *dest) {
+  dest[0] = RACP_RESPONSE;
+  dest[1] = RACP_NULL;
+  dest[2] = opcode;
+  dest[3] = code;
+  return RACP_RESPONSE_SIZE;
+}
+
+/**
+ * @brief zakoduje odpoved s poctem zaznamu, pocet je uint16 jako ve standardu
+ * 
+ */
+size_t racp_count_response(uint32_t count, uint8_t *dest) {
+  if (count > UINT16_MAX) {
+    count = UINT16_MAX;
+  }
+  dest[0] = RACP_COUNT_RESPONSE;
+  dest[1] = RACP_NULL;
+  putLE(dest + 2, count, 2);
+  return RACP_COUNT_RESPONSE_SIZE;
+}
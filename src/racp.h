@@ -0,0 +1,64 @@
+#ifndef RACP_H
+#define RACP_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* KONTROLNI BOD PRISTUPU K ZAZNAMUM */
+
+/**
+ * Pozadavek podle Record Access Control Point (little-endian): operacni kod,
+ * operator, u operatoru s operandem typ filtru (casovy posun) a jeden nebo dva
+ * casy. Na rozdil od standardu (uint16 v minutach) je cas uint32 v sekundach
+ * jako v binarnim zaznamu mereni. Zaznamy se posilaji notifikacemi charakteristiky
+ * mereni, vysledek notifikaci kontrolniho bodu.
+ */
+#define RACP_REPORT 0x01
+#define RACP_DELETE 0x02
+#define RACP_ABORT 0x03
+#define RACP_REPORT_COUNT 0x04
+#define RACP_COUNT_RESPONSE 0x05
+#define RACP_RESPONSE 0x06
+
+#define RACP_NULL 0x00
+#define RACP_ALL 0x01
+#define RACP_LESS_OR_EQUAL 0x02
+#define RACP_GREATER_OR_EQUAL 0x03
+#define RACP_WITHIN 0x04
+#define RACP_FIRST 0x05
+#define RACP_LAST 0x06
+
+#define RACP_FILTER_TIME_OFFSET 0x01
+
+#define RACP_SUCCESS 0x01
+#define RACP_OPCODE_NOT_SUPPORTED 0x02
+#define RACP_INVALID_OPERATOR 0x03
+#define RACP_OPERATOR_NOT_SUPPORTED 0x04
+#define RACP_INVALID_OPERAND 0x05
+#define RACP_NO_RECORDS 0x06
+#define RACP_ABORT_UNSUCCESSFUL 0x07
+#define RACP_NOT_COMPLETED 0x08
+#define RACP_OPERAND_NOT_SUPPORTED 0x09
+
+#define RACP_MAX_SIZE 11
+#define RACP_RESPONSE_SIZE 4
+#define RACP_COUNT_RESPONSE_SIZE 4
+
+// casovy interval pozadavku vcetne okraju; FIRST a LAST se urci az podle ulozenych zaznamu
+struct RacpRequest {
+  uint8_t opcode;
+  uint8_t op;
+  int32_t from;
+  int32_t to;
+};
+
+
+/* FUNKCE KONTROLNIHO BODU */
+
+uint8_t racp_parse(const uint8_t *src, size_t len, RacpRequest *request);
+
+size_t racp_response(uint8_t opcode, uint8_t code, uint8_t *dest);
+
+size_t racp_count_response(uint32_t count, uint8_t *dest);
+
+#endif
@@ -1,11 +1,23 @@
+#include <stdlib.h>
 #include "rng.h"
 
+#ifdef ARDUINO
+
 uint32_t random_uint32() {
   volatile uint32_t *rng_data_reg = (volatile uint32_t *)(RNG_DATA_REG);
 
   return *rng_data_reg;
 }
 
+#else
+
+// generator knihovny C pro preklad mimo Arduino (testovani na PC)
+uint32_t random_uint32() {
+  return ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+}
+
+#endif
+
 int random_from_to(int min, int max) {
   return (min + (abs((int)random_uint32()) % (max - min + 1)));
-}
\ No newline at end of file
+}
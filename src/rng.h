@@ -1,7 +1,7 @@
 #ifndef RNG_H
 #define RNG_H
 
-#include <Arduino.h>
+#include <stdint.h>
 
 /* ADRESY REGISTRU */
 
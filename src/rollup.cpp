@@ -0,0 +1,141 @@
+#include "bytes.h"
+#include "rollup.h"
+
+static const int32_t widths[ROLLUP_LEVELS] = ROLLUP_WIDTHS;
+static const uint32_t capacities[ROLLUP_LEVELS] = { ROLLUP_CAPACITY_15_MIN, ROLLUP_CAPACITY_1_H, ROLLUP_CAPACITY_1_DAY };
+
+// kruhove zasobniky intervalu jednotlivych urovni
+static RollupBucket buckets15Min[ROLLUP_CAPACITY_15_MIN];
+static RollupBucket buckets1H[ROLLUP_CAPACITY_1_H];
+static RollupBucket buckets1Day[ROLLUP_CAPACITY_1_DAY];
+static RollupBucket *levels[ROLLUP_LEVELS] = { buckets15Min, buckets1H, buckets1Day };
+static uint32_t heads[ROLLUP_LEVELS] = { 0 };
+static uint32_t counts[ROLLUP_LEVELS] = { 0 };
+
+static RollupBucket *bucketAt(uint8_t level, uint32_t index) {
+  return &levels[level][(heads[level] + index) % capacities[level]];
+}
+
+/**
+ * @brief zapocita mereni do posledniho intervalu kazde urovne, cena O(1)
+ * 
+ * @param measurement nove mereni
+ */
+void rollup_push(CGMeasurement measurement) {
+  for (uint8_t level = 0; level < ROLLUP_LEVELS; ++level) {
+    int32_t start = measurement.timeOffset - measurement.timeOffset % widths[level];
+    if (measurement.timeOffset < 0 && start != measurement.timeOffset) {
+      start -= widths[level];
+    }
+
+    RollupBucket *bucket = (counts[level] > 0) ? bucketAt(level, counts[level] - 1) : NULL;
+    if (bucket == NULL || bucket->start != start) {
+      if (counts[level] == capacities[level]) {
+        heads[level] = (heads[level] + 1) % capacities[level];
+        counts[level]--;
+      }
+      bucket = bucketAt(level, counts[level]++);
+      *bucket = RollupBucket{start, measurement.glucoseValue, measurement.glucoseValue, 0, 0};
+    }
+
+    if (measurement.glucoseValue < bucket->min) {
+      bucket->min = measurement.glucoseValue;
+    }
+    if (measurement.glucoseValue > bucket->max) {
+      bucket->max = measurement.glucoseValue;
+    }
+    bucket->count++;
+    bucket->sum += measurement.glucoseValue;
+  }
+}
+
+/**
+ * @brief vyprazdni vsechny urovne, napr. pri zahajeni nove relace
+ * 
+ */
+void rollup_clear() {
+  for (uint8_t level = 0; level < ROLLUP_LEVELS; ++level) {
+    heads[level] = 0;
+    counts[level] = 0;
+  }
+}
+
+// zacatky intervalu rostou, prvni interval koncici po case from se najde pulenim
+static uint32_t firstEndingAfter(uint8_t level, int32_t from) {
+  uint32_t low = 0;
+  uint32_t high = counts[level];
+  while (low < high) {
+    uint32_t mid = (low + high) / 2;
+    if (bucketAt(level, mid)->start + widths[level] > from) {
+      high = mid;
+    }
+    else {
+      low = mid + 1;
+    }
+  }
+  return low;
+}
+
+uint32_t rollup_count(uint8_t level) {
+  return (level < ROLLUP_LEVELS) ? counts[level] : 0;
+}
+
+bool rollup_at(uint8_t level, uint32_t index, RollupBucket *bucket) {
+  if (level >= ROLLUP_LEVELS || index >= counts[level]) {
+    return false;
+  }
+  *bucket = *bucketAt(level, index);
+  return true;
+}
+
+/**
+ * @brief vrati intervaly dane urovne zacinajici od zadaneho casu
+ * 
+ * @param level uroven agregace
+ * @param from cas, do ktereho musi interval zasahovat
+ * @param buckets pole pro nalezene intervaly
+ * @param max velikost pole
+ * @return pocet vracenych intervalu
+ */
+uint32_t rollup_query(uint8_t level, int32_t from, RollupBucket *buckets, uint32_t max) {
+  uint32_t found = 0;
+
+  if (level >= ROLLUP_LEVELS) {
+    return 0;
+  }
+  for (uint32_t i = firstEndingAfter(level, from); i < counts[level] && found < max; ++i) {
+    buckets[found++] = *bucketAt(level, i);
+  }
+  return found;
+}
+
+/**
+ * @brief zakoduje jednu stranku odpovedi - uroven, pocet a tolik intervalu po 12 bajtech
+ * (zacatek int32, minimum, maximum a prumer int16, pocet uint16, little-endian), kolik
+ * se vejde do len; intervaly se koduji primo z kruhoveho zasobniku
+ * 
+ * @param level uroven agregace
+ * @param from cas, do ktereho musi interval zasahovat, posune se za posledni zakodovany interval
+ * @param dest cilovy buffer
+ * @param len velikost ciloveho bufferu, alespon ROLLUP_HEADER_SIZE
+ * @return delka stranky, stranka bez intervalu odpoved ukoncuje
+ */
+size_t rollup_pack(uint8_t level, int32_t *from, uint8_t *dest, size_t len) {
+  uint32_t found = 0;
+
+  dest[0] = level;
+  if (level < ROLLUP_LEVELS) {
+    for (uint32_t i = firstEndingAfter(level, *from); i < counts[level] && found < UINT8_MAX && ROLLUP_HEADER_SIZE + (found + 1) * ROLLUP_PACKED_SIZE <= len; ++i) {
+      const RollupBucket *bucket = bucketAt(level, i);
+      uint8_t *packed = dest + ROLLUP_HEADER_SIZE + found++ * ROLLUP_PACKED_SIZE;
+      putLE(packed, (uint32_t)bucket->start, 4);
+      putLE(packed + 4, (uint32_t)bucket->min, 2);
+      putLE(packed + 6, (uint32_t)bucket->max, 2);
+      putLE(packed + 8, (uint32_t)(bucket->sum / bucket->count), 2);
+      putLE(packed + 10, (bucket->count > UINT16_MAX) ? UINT16_MAX : bucket->count, 2);
+      *from = bucket->start + widths[level];
+    }
+  }
+  dest[1] = (uint8_t)found;
+  return ROLLUP_HEADER_SIZE + found * ROLLUP_PACKED_SIZE;
+}
@@ -0,0 +1,53 @@
+#ifndef ROLLUP_H
+#define ROLLUP_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "measurement.h"
+
+/* UROVNE AGREGACE */
+
+#define ROLLUP_LEVELS 3
+
+#define ROLLUP_15_MIN 0
+#define ROLLUP_1_H 1
+#define ROLLUP_1_DAY 2
+
+// delka intervalu v jednotkach timeOffset (s) a pocet uchovavanych intervalu
+#define ROLLUP_WIDTHS { 900, 3600, 86400 }
+
+#define ROLLUP_CAPACITY_15_MIN 96
+#define ROLLUP_CAPACITY_1_H 168
+#define ROLLUP_CAPACITY_1_DAY 14
+
+// nejdelsi okno uchovane nekterou urovni (denni uroven) - rozsah obnoveni z logu
+#define ROLLUP_RETENTION (86400 * ROLLUP_CAPACITY_1_DAY)
+
+// velikost jednoho intervalu pri prenosu pres BLE, stranka odpovedi zacina urovni a poctem
+#define ROLLUP_PACKED_SIZE 12
+#define ROLLUP_HEADER_SIZE 2
+
+struct RollupBucket {
+  int32_t start;
+  int32_t min;
+  int32_t max;
+  uint32_t count;
+  int64_t sum;
+};
+
+
+/* FUNKCE AGREGACE */
+
+void rollup_push(CGMeasurement measurement);
+
+void rollup_clear();
+
+uint32_t rollup_count(uint8_t level);
+
+bool rollup_at(uint8_t level, uint32_t index, RollupBucket *bucket);
+
+uint32_t rollup_query(uint8_t level, int32_t from, RollupBucket *buckets, uint32_t max);
+
+size_t rollup_pack(uint8_t level, int32_t *from, uint8_t *dest, size_t len);
+
+#endif
@@ -0,0 +1,186 @@
+#include "packed.h"
+#include "sdt.h"
+
+// uchovane body lomene cary, posledni prijate mereni ceka v pending
+static PackedSeries<SDT_CAPACITY, SDT_TIME_BITS, SDT_VALUE_BITS> kept;
+static CGMeasurement pending;
+static bool hasPending = false;
+
+static int32_t deviation = SDT_DEFAULT_DEVIATION;
+static uint32_t receivedCount = 0;
+static uint32_t keptCount = 0;
+
+// "dvere" - rozsah smernic usecky z posledniho uchovaneho bodu, pri kterych
+// zustavaji vsechna mereni od nej v povolene odchylce, jako zlomky num / den
+static bool doorOpen;
+static int64_t upperNum;
+static int64_t upperDen;
+static int64_t lowerNum;
+static int64_t lowerDen;
+
+// body starsi nez retence se zahodi, cas noveho bodu se tak vzdy vejde do sloupce casu
+static void keep(CGMeasurement measurement) {
+  while (!kept.isEmpty() && (int64_t)kept.first().timeOffset <= (int64_t)measurement.timeOffset - SDT_RETENTION) {
+    kept.dropFirst();
+  }
+  if (kept.push(measurement)) {
+    keptCount++;
+  }
+  doorOpen = false;
+}
+
+// zuzi dvere o rozsah smernic, ve kterem je mereni od usecky nejvyse o odchylku
+static void narrow(CGMeasurement measurement) {
+  CGMeasurement base = kept.last();
+  int64_t dt = measurement.timeOffset - base.timeOffset;
+  int64_t dv = measurement.glucoseValue - base.glucoseValue;
+
+  if (!doorOpen || (dv + deviation) * upperDen < upperNum * dt) {
+    upperNum = dv + deviation;
+    upperDen = dt;
+  }
+  if (!doorOpen || (dv - deviation) * lowerDen > lowerNum * dt) {
+    lowerNum = dv - deviation;
+    lowerDen = dt;
+  }
+  doorOpen = true;
+}
+
+// usecka z posledniho uchovaneho bodu do mereni vede dvermi vsech mereni mezi nimi
+static bool fits(CGMeasurement measurement) {
+  CGMeasurement base = kept.last();
+  int64_t dt = measurement.timeOffset - base.timeOffset;
+  int64_t dv = measurement.glucoseValue - base.glucoseValue;
+
+  return !doorOpen || (dv * upperDen <= upperNum * dt && dv * lowerDen >= lowerNum * dt);
+}
+
+/**
+ * @brief prida mereni do ztratove historie
+ * 
+ * Predchozi mereni se uchova, jen pokud by usecka vedena az k novemu mereni
+ * nektere mereni mezi nimi minula o vic nez povolenou odchylku. Rekonstrukce
+ * je tak v uchovanych bodech presna a jinde se lisi nejvyse o odchylku.
+ * 
+ * @param measurement nove mereni
+ */
+void sdt_push(CGMeasurement measurement) {
+  receivedCount++;
+
+  if (kept.isEmpty()) {
+    keep(measurement);
+    hasPending = false;
+    return;
+  }
+  if (measurement.timeOffset <= (hasPending ? pending.timeOffset : kept.last().timeOffset)) {
+    return;
+  }
+
+  if (hasPending) {
+    narrow(pending);
+    if (!fits(measurement)) {
+      keep(pending);
+    }
+  }
+  pending = measurement;
+  hasPending = true;
+}
+
+/**
+ * @brief nastavi povolenou odchylku, plati od posledniho prijateho mereni
+ * 
+ * @param value odchylka (mmol/l * 100), 0 uchovava kazdy zlom krivky
+ */
+void sdt_set_deviation(int32_t value) {
+  if (hasPending) {
+    keep(pending);
+    hasPending = false;
+  }
+  deviation = (value > 0) ? value : 0;
+}
+
+int32_t sdt_deviation() {
+  return deviation;
+}
+
+/**
+ * @brief zahodi ztratovou historii, napr. pri zahajeni nove relace
+ * 
+ */
+void sdt_clear() {
+  kept.clear();
+  hasPending = false;
+  doorOpen = false;
+}
+
+/**
+ * @brief rekonstruuje hodnotu v zadanem case linearni interpolaci uchovanych bodu
+ * 
+ * @param time cas
+ * @param value rekonstruovana hodnota (mmol/l * 100)
+ * @return false cas je mimo obdobi ztratove historie
+ */
+bool sdt_value_at(int32_t time, int32_t *value) {
+  if (kept.isEmpty() || time < kept.first().timeOffset) {
+    return false;
+  }
+
+  // prvni uchovany bod po zadanem case se najde pulenim sloupce casu, za poslednim ceka pending
+  size_t index = kept.upperBound(time);
+  CGMeasurement from = kept[index - 1];
+  CGMeasurement to;
+
+  if (index < kept.size()) {
+    to = kept[index];
+  }
+  else if (hasPending && time <= pending.timeOffset) {
+    to = pending;
+  }
+  else {
+    if (time != from.timeOffset) {
+      return false;
+    }
+    to = from;
+  }
+
+  if (to.timeOffset == from.timeOffset) {
+    *value = from.glucoseValue;
+    return true;
+  }
+  int64_t numerator = (int64_t)(to.glucoseValue - from.glucoseValue) * (time - from.timeOffset) * 2;
+  int64_t denominator = (int64_t)(to.timeOffset - from.timeOffset) * 2;
+  // zaokrouhleni k nejblizsimu celemu cislu
+  numerator += (numerator >= 0) ? denominator / 2 : -denominator / 2;
+  *value = from.glucoseValue + (int32_t)(numerator / denominator);
+  return true;
+}
+
+/**
+ * @brief najde prvni uchovany bod novejsi nez zadany cas - body jsou skutecna mereni,
+ * dlouhodoba historie je tak zdrojem mereni starsich nez log
+ * 
+ * @param time cas
+ * @param measurement nalezeny bod
+ * @return false zadny novejsi bod neni
+ */
+bool sdt_find_after(int32_t time, CGMeasurement *measurement) {
+  size_t index = kept.upperBound(time);
+
+  if (index < kept.size()) {
+    *measurement = kept[index];
+    return true;
+  }
+  if (hasPending && pending.timeOffset > time) {
+    *measurement = pending;
+    return true;
+  }
+  return false;
+}
+
+uint32_t sdt_received() {
+  return receivedCount;
+}
+
+uint32_t sdt_kept() {
+  return keptCount + (hasPending ? 1 : 0);
+}
@@ -0,0 +1,45 @@
+#ifndef SDT_H
+#define SDT_H
+
+#include <stdint.h>
+#include "measurement.h"
+
+/* PARAMETRY ZTRATOVE HISTORIE (SWINGING DOOR) */
+
+// dlouhodoba historie drzi body poslednich SDT_RETENTION_DAYS dni, starsi se zahodi
+#define SDT_RETENTION_DAYS 60
+#define SDT_RETENTION (SDT_RETENTION_DAYS * 86400)
+
+// pocet uchovanych bodu lomene cary - plynula krivka glykemie s odchylkou 2 mg/dl
+// uchova 25 - 55 bodu za den bez ohledu na interval mereni, 4096 bodu tak pokryje
+// retenci i pri 68 bodech za den; pri vetsim sumu kruh pokryje kratsi obdobi
+#define SDT_CAPACITY 4096
+
+// sirka sloupcu bodu - cas relativne k nejstarsimu bodu (2^23 s = 97 dni > retence)
+// a hodnota (mmol/l * 100, 0 - 4095)
+#define SDT_TIME_BITS 23
+#define SDT_VALUE_BITS 12
+
+// vychozi povolena odchylka rekonstrukce (mmol/l * 100), 11 ~ 2 mg/dl
+#define SDT_DEFAULT_DEVIATION 11
+
+
+/* FUNKCE ZTRATOVE HISTORIE */
+
+void sdt_push(CGMeasurement measurement);
+
+void sdt_clear();
+
+void sdt_set_deviation(int32_t deviation);
+
+int32_t sdt_deviation();
+
+bool sdt_value_at(int32_t time, int32_t *value);
+
+bool sdt_find_after(int32_t time, CGMeasurement *measurement);
+
+uint32_t sdt_received();
+
+uint32_t sdt_kept();
+
+#endif
@@ -0,0 +1,51 @@
+#include "session.h"
+
+#ifdef ARDUINO
+
+#include <Preferences.h>
+
+static Preferences preferences;
+
+bool session_load(PersistedSession *session) {
+  if (!preferences.begin(SESSION_NAMESPACE, true)) {
+    return false;
+  }
+  size_t len = preferences.getBytes(SESSION_KEY, session, sizeof(PersistedSession));
+  preferences.end();
+  return len == sizeof(PersistedSession) && session->magic == SESSION_MAGIC;
+}
+
+bool session_save(const PersistedSession *session) {
+  if (!preferences.begin(SESSION_NAMESPACE, false)) {
+    return false;
+  }
+  size_t len = preferences.putBytes(SESSION_KEY, session, sizeof(PersistedSession));
+  preferences.end();
+  return len == sizeof(PersistedSession);
+}
+
+#else
+
+#include <stdio.h>
+
+bool session_load(PersistedSession *session) {
+  FILE *file = fopen(SESSION_EMULATOR_FILE, "rb");
+  if (file == NULL) {
+    return false;
+  }
+  size_t len = fread(session, 1, sizeof(PersistedSession), file);
+  fclose(file);
+  return len == sizeof(PersistedSession) && session->magic == SESSION_MAGIC;
+}
+
+bool session_save(const PersistedSession *session) {
+  FILE *file = fopen(SESSION_EMULATOR_FILE, "wb");
+  if (file == NULL) {
+    return false;
+  }
+  size_t len = fwrite(session, 1, sizeof(PersistedSession), file);
+  fclose(file);
+  return len == sizeof(PersistedSession);
+}
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef SESSION_H
+#define SESSION_H
+
+#include <stdint.h>
+
+/* PARAMETRY ULOZENE RELACE */
+
+// jmenny prostor a klic v NVS (Preferences)
+#define SESSION_NAMESPACE "cgm"
+#define SESSION_KEY "session"
+
+// emulace NVS souborem pri prekladu mimo Arduino (testovani na PC)
+#define SESSION_EMULATOR_FILE "session.bin"
+
+#define SESSION_MAGIC 0x53534543
+
+// stav relace, ktery prezije restart - sdileny klic, kurzor potvrzeni klienta, cas,
+// do ktereho klient zaznamy smazal, cas dne zacatku relace pro glykemicky profil
+// a konec bloku hodnot citace vysilani rezervovaneho pred restartem
+struct PersistedSession {
+  uint32_t magic;
+  uint32_t sharedKey;
+  int32_t acknowledged;
+  int32_t deleted;
+  int32_t agpOrigin;
+  uint32_t beaconReserved;
+};
+
+
+/* FUNKCE ULOZENE RELACE */
+
+bool session_load(PersistedSession *session);
+
+bool session_save(const PersistedSession *session);
+
+#endif
@@ -0,0 +1,106 @@
+#include "simple8b.h"
+
+// pocet hodnot a jejich sirka v bitech pro kazdy selektor
+static const uint8_t selectorCount[SIMPLE8B_SELECTORS] = {240, 120, 60, 30, 20, 15, 12, 10, 8, 7, 6, 5, 4, 3, 2, 1};
+static const uint8_t selectorBits[SIMPLE8B_SELECTORS] = {0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 10, 12, 15, 20, 30, 60};
+
+/**
+ * @brief vybere selektor s nejvice hodnotami, do jehoz sirky se vejdou vsechny
+ * nasledujici hodnoty (na konci posloupnosti zbyvajici hodnoty)
+ * 
+ * @return selektor, SIMPLE8B_SELECTORS pokud hodnota presahuje 60 bitu
+ */
+static uint8_t selectorAt(const uint64_t *values, size_t count) {
+  for (uint8_t selector = 0; selector < SIMPLE8B_SELECTORS; ++selector) {
+    size_t n = (count < selectorCount[selector]) ? count : selectorCount[selector];
+    uint64_t limit = (selectorBits[selector] == 0) ? 0 : ((uint64_t)1 << selectorBits[selector]) - 1;
+    size_t i = 0;
+    while (i < n && values[i] <= limit) {
+      ++i;
+    }
+    if (i == n) {
+      return selector;
+    }
+  }
+  return SIMPLE8B_SELECTORS;
+}
+
+/**
+ * @brief spocita pocet slov potrebnych k zakodovani hodnot
+ * 
+ * @return pocet slov, 0 pokud nektera hodnota presahuje 60 bitu
+ */
+size_t simple8b_words(const uint64_t *values, size_t count) {
+  size_t words = 0;
+
+  while (count > 0) {
+    uint8_t selector = selectorAt(values, count);
+    if (selector == SIMPLE8B_SELECTORS) {
+      return 0;
+    }
+    size_t n = (count < selectorCount[selector]) ? count : selectorCount[selector];
+    values += n;
+    count -= n;
+    words++;
+  }
+  return words;
+}
+
+/**
+ * @brief zakoduje hodnoty do slov Simple8b
+ * 
+ * @param values hodnoty (napr. zigzag rozdilu)
+ * @param count pocet hodnot
+ * @param dest cilovy buffer
+ * @param capacity velikost ciloveho bufferu
+ * @return pocet zapsanych bajtu, 0 pokud se hodnoty nevejdou nebo presahuji 60 bitu
+ */
+size_t simple8b_encode(const uint64_t *values, size_t count, uint8_t *dest, size_t capacity) {
+  size_t len = 0;
+
+  while (count > 0) {
+    uint8_t selector = selectorAt(values, count);
+    if (selector == SIMPLE8B_SELECTORS || len + SIMPLE8B_WORD_SIZE > capacity) {
+      return 0;
+    }
+    size_t n = (count < selectorCount[selector]) ? count : selectorCount[selector];
+    uint64_t word = (uint64_t)selector << SIMPLE8B_MAX_BITS;
+    for (size_t i = 0; i < n && selectorBits[selector] > 0; ++i) {
+      word |= values[i] << (i * selectorBits[selector]);
+    }
+    for (uint8_t i = 0; i < SIMPLE8B_WORD_SIZE; ++i) {
+      dest[len + i] = (word >> (8 * i)) & 0xFF;
+    }
+    len += SIMPLE8B_WORD_SIZE;
+    values += n;
+    count -= n;
+  }
+  return len;
+}
+
+/**
+ * @brief dekoduje slova Simple8b - referencni dekoder pro klienta
+ * 
+ * @param src slova
+ * @param len delka v bajtech
+ * @param values cilove pole
+ * @param count pocet hodnot k dekodovani
+ * @return pocet dekodovanych hodnot, mene nez count u zkracenych dat
+ */
+size_t simple8b_decode(const uint8_t *src, size_t len, uint64_t *values, size_t count) {
+  size_t decoded = 0;
+
+  for (size_t offset = 0; offset + SIMPLE8B_WORD_SIZE <= len && decoded < count; offset += SIMPLE8B_WORD_SIZE) {
+    uint64_t word = 0;
+    for (uint8_t i = 0; i < SIMPLE8B_WORD_SIZE; ++i) {
+      word |= (uint64_t)src[offset + i] << (8 * i);
+    }
+    uint8_t selector = word >> SIMPLE8B_MAX_BITS;
+    uint8_t bits = selectorBits[selector];
+    uint64_t mask = (bits == 0) ? 0 : ((uint64_t)1 << bits) - 1;
+    for (uint8_t i = 0; i < selectorCount[selector] && decoded < count; ++i) {
+      values[decoded++] = (word >> (i * bits)) & mask;
+    }
+  }
+  return decoded;
+}
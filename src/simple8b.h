@@ -0,0 +1,27 @@
+#ifndef SIMPLE8B_H
+#define SIMPLE8B_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* PARAMETRY SIMPLE8B */
+
+/**
+ * Slovo Simple8b (uint64, little-endian): 4 bity selektoru a 60 bitu dat
+ * s nekolika hodnotami stejne sirky. Selektory 0 a 1 nesou 240 a 120 nul.
+ * Posledni slovo muze byt doplneno nulami, pocet hodnot zna dekoder z hlavicky.
+ */
+#define SIMPLE8B_WORD_SIZE 8
+#define SIMPLE8B_SELECTORS 16
+#define SIMPLE8B_MAX_BITS 60
+
+
+/* FUNKCE SIMPLE8B */
+
+size_t simple8b_encode(const uint64_t *values, size_t count, uint8_t *dest, size_t capacity);
+
+size_t simple8b_words(const uint64_t *values, size_t count);
+
+size_t simple8b_decode(const uint8_t *src, size_t len, uint64_t *values, size_t count);
+
+#endif
@@ -0,0 +1,86 @@
+#ifndef SPSC_H
+#define SPSC_H
+
+#include <atomic>
+#include <stddef.h>
+
+// velikost radku cache, na ktery se zarovnavaji indexy producenta a konzumenta
+#define SPSC_CACHE_LINE 64
+
+/**
+ * Kruhova fronta bez zamku pro jednoho producenta a jednoho konzumenta.
+ * Producent zapisuje pouze head, konzument pouze tail, obe operace jsou
+ * wait-free. Plna fronta nic neprepisuje - push vrati false.
+ */
+template<typename T, size_t N> class SpscRing {
+  static_assert((N & (N - 1)) == 0, "kapacita musi byt mocninou dvou");
+
+public:
+  /**
+   * Vlozeni prvku, vola pouze producent.
+   */
+  bool push(const T &item) {
+    size_t head = this->head.load(std::memory_order_relaxed);
+    if (head - tail.load(std::memory_order_acquire) == N) {
+      return false;
+    }
+    items[head & (N - 1)] = item;
+    this->head.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * Vyjmuti nejstarsiho prvku, vola pouze konzument.
+   */
+  bool pop(T *item) {
+    size_t tail = this->tail.load(std::memory_order_relaxed);
+    if (tail == head.load(std::memory_order_acquire)) {
+      return false;
+    }
+    *item = items[tail & (N - 1)];
+    this->tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * Konzistentni kopie obsahu fronty bez jejiho vyprazdneni, muze volat libovolne vlakno.
+   * Producent prepise slot teprve po jeho vyjmuti, po kopii se proto zahodi prvky,
+   * ktere mezitim konzument vyjmul. Vraci pocet zkopirovanych prvku od nejstarsiho,
+   * pri omezeni poctu jde o nejnovejsi prvky.
+   */
+  size_t snapshot(T *dest, size_t max) const {
+    size_t tail = this->tail.load(std::memory_order_acquire);
+    size_t head = this->head.load(std::memory_order_acquire);
+    if (head - tail > max) {
+      tail = head - max;
+    }
+    for (size_t i = tail; i != head; ++i) {
+      dest[i - tail] = items[i & (N - 1)];
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    // indexy pretecou, porovnava se proto rozdil
+    size_t consumed = this->tail.load(std::memory_order_relaxed);
+    if ((ptrdiff_t)(consumed - tail) <= 0) {
+      return head - tail;
+    }
+    if (consumed - tail >= head - tail) {
+      return 0;
+    }
+    for (size_t i = consumed; i != head; ++i) {
+      dest[i - consumed] = dest[i - tail];
+    }
+    return head - consumed;
+  }
+
+  size_t size() const {
+    return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+  }
+
+private:
+  alignas(SPSC_CACHE_LINE) std::atomic<size_t> head{0};
+  alignas(SPSC_CACHE_LINE) std::atomic<size_t> tail{0};
+  alignas(SPSC_CACHE_LINE) T items[N];
+};
+
+#endif
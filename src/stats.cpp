@@ -0,0 +1,197 @@
+#include <stddef.h>
+
+#include "stats.h"
+
+static_assert((STATS_LEAVES & (STATS_LEAVES - 1)) == 0, "pocet listu musi byt mocninou dvou");
+
+// strom intervalu nad kruhem listu - list i je v uzlu STATS_LEAVES + i
+static StatsNode tree[2 * STATS_LEAVES];
+static int32_t leafStart[STATS_LEAVES];
+static uint32_t firstLeaf = 0;
+static uint32_t leafCount = 0;
+static int32_t lastTime = 0;
+
+static StatsSource source = NULL;
+
+static const StatsNode EMPTY_NODE = {0, 0, 0, INT16_MAX, INT16_MIN};
+
+static StatsNode merge(const StatsNode &a, const StatsNode &b) {
+  return StatsNode{a.sum + b.sum, (uint16_t)(a.count + b.count), (uint16_t)(a.inRange + b.inRange),
+                   (a.min < b.min) ? a.min : b.min, (a.max > b.max) ? a.max : b.max};
+}
+
+static void add(WindowStats *stats, const StatsNode &node) {
+  stats->count += node.count;
+  stats->inRange += node.inRange;
+  stats->sum += node.sum;
+  if (node.count > 0 && node.min < stats->min) {
+    stats->min = node.min;
+  }
+  if (node.count > 0 && node.max > stats->max) {
+    stats->max = node.max;
+  }
+}
+
+static void addMeasurement(WindowStats *stats, CGMeasurement measurement) {
+  bool inRange = measurement.glucoseValue >= STATS_RANGE_LOW && measurement.glucoseValue <= STATS_RANGE_HIGH;
+  add(stats, StatsNode{measurement.glucoseValue, 1, (uint16_t)inRange, (int16_t)measurement.glucoseValue, (int16_t)measurement.glucoseValue});
+}
+
+static uint32_t slotAt(uint32_t position) {
+  return (firstLeaf + position) & (STATS_LEAVES - 1);
+}
+
+// prepocita predky listu po jeho zmene, O(log n)
+static void update(uint32_t slot) {
+  for (uint32_t node = (STATS_LEAVES + slot) / 2; node > 0; node /= 2) {
+    tree[node] = merge(tree[2 * node], tree[2 * node + 1]);
+  }
+}
+
+// agregace listu v rozsahu slotu [from, to)
+static void queryTree(uint32_t from, uint32_t to, WindowStats *stats) {
+  for (from += STATS_LEAVES, to += STATS_LEAVES; from < to; from /= 2, to /= 2) {
+    if (from & 1) {
+      add(stats, tree[from++]);
+    }
+    if (to & 1) {
+      add(stats, tree[--to]);
+    }
+  }
+}
+
+// agregace listu na pozicich [from, to) kruhu, ktery muze pretect pres konec pole
+static void queryLeaves(uint32_t from, uint32_t to, WindowStats *stats) {
+  if (from >= to) {
+    return;
+  }
+  uint32_t start = slotAt(from);
+  uint32_t end = start + (to - from);
+  if (end <= STATS_LEAVES) {
+    queryTree(start, end, stats);
+  }
+  else {
+    queryTree(start, STATS_LEAVES, stats);
+    queryTree(0, end - STATS_LEAVES, stats);
+  }
+}
+
+// pozice posledniho listu zacinajiciho nejpozdeji v case time
+static uint32_t leafAt(int32_t time) {
+  uint32_t low = 0;
+  uint32_t high = leafCount;
+  while (low < high) {
+    uint32_t mid = (low + high) / 2;
+    if (leafStart[slotAt(mid)] > time) {
+      high = mid;
+    }
+    else {
+      low = mid + 1;
+    }
+  }
+  return (low > 0) ? low - 1 : 0;
+}
+
+// agregace jednotlivych mereni v casech [from, to] ze zdroje mereni
+static void scanRaw(int32_t from, int32_t to, WindowStats *stats) {
+  CGMeasurement measurement;
+  int32_t time = from - 1;
+
+  while (from <= to && source != NULL && source(time, &measurement) && measurement.timeOffset <= to) {
+    addMeasurement(stats, measurement);
+    time = measurement.timeOffset;
+  }
+}
+
+/**
+ * @brief nastavi zdroj jednotlivych mereni a vyprazdni statistiky
+ * 
+ * @param measurementSource funkce vracejici prvni mereni novejsi nez zadany cas
+ */
+void stats_init(StatsSource measurementSource) {
+  source = measurementSource;
+  firstLeaf = 0;
+  leafCount = 0;
+  for (uint32_t i = 0; i < 2 * STATS_LEAVES; ++i) {
+    tree[i] = EMPTY_NODE;
+  }
+}
+
+/**
+ * @brief zapocita mereni do posledniho listu a jeho predku, O(log n)
+ * 
+ * @param measurement nove mereni
+ */
+void stats_push(CGMeasurement measurement) {
+  if (leafCount == 0 || tree[STATS_LEAVES + slotAt(leafCount - 1)].count == STATS_LEAF_SAMPLES) {
+    if (leafCount == STATS_LEAVES) {
+      firstLeaf = (firstLeaf + 1) & (STATS_LEAVES - 1);
+      leafCount--;
+    }
+    uint32_t slot = slotAt(leafCount++);
+    tree[STATS_LEAVES + slot] = EMPTY_NODE;
+    leafStart[slot] = measurement.timeOffset;
+  }
+
+  WindowStats leaf = {0, 0, 0, INT32_MAX, INT32_MIN};
+  uint32_t slot = slotAt(leafCount - 1);
+  StatsNode *node = &tree[STATS_LEAVES + slot];
+  addMeasurement(&leaf, measurement);
+  *node = merge(*node, StatsNode{(int32_t)leaf.sum, 1, (uint16_t)leaf.inRange, (int16_t)leaf.min, (int16_t)leaf.max});
+  update(slot);
+  lastTime = measurement.timeOffset;
+}
+
+/**
+ * @brief spocita statistiky mereni v casovem okne [from, to]
+ * 
+ * Cele listy uvnitr okna se agreguji stromem intervalu v O(log n), mereni
+ * okrajovych listu (nejvyse 2 * STATS_LEAF_SAMPLES) se ctou ze zdroje mereni.
+ * Okno se orizne na obdobi pokryte statistikami.
+ * 
+ * @param from cas zacatku okna
+ * @param to cas konce okna
+ * @param stats vysledne statistiky
+ * @return false okno neobsahuje zadne mereni
+ */
+bool stats_query(int32_t from, int32_t to, WindowStats *stats) {
+  *stats = WindowStats{0, 0, 0, INT32_MAX, INT32_MIN};
+
+  if (leafCount == 0 || to < from) {
+    return false;
+  }
+  if (from < leafStart[slotAt(0)]) {
+    from = leafStart[slotAt(0)];
+  }
+  if (to > lastTime) {
+    to = lastTime;
+  }
+
+  uint32_t first = leafAt(from);
+  uint32_t last = leafAt(to);
+
+  // okrajove listy, ktere okno nepokryva cele, se spocitaji z jednotlivych mereni
+  if (first == last) {
+    bool whole = from <= leafStart[slotAt(first)] && (first + 1 == leafCount ? to >= lastTime : to >= leafStart[slotAt(first + 1)] - 1);
+    if (whole) {
+      queryLeaves(first, first + 1, stats);
+    }
+    else {
+      scanRaw(from, to, stats);
+    }
+    return stats->count > 0;
+  }
+
+  uint32_t fullFrom = first;
+  if (from > leafStart[slotAt(first)]) {
+    scanRaw(from, leafStart[slotAt(first + 1)] - 1, stats);
+    fullFrom = first + 1;
+  }
+  uint32_t fullTo = last + 1;
+  if (last + 1 == leafCount ? to < lastTime : to < leafStart[slotAt(last + 1)] - 1) {
+    scanRaw(leafStart[slotAt(last)], to, stats);
+    fullTo = last;
+  }
+  queryLeaves(fullFrom, fullTo, stats);
+  return stats->count > 0;
+}
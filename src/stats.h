@@ -0,0 +1,46 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdint.h>
+#include "measurement.h"
+
+/* PARAMETRY STATISTIK */
+
+// list stromu intervalu agreguje STATS_LEAF_SAMPLES po sobe jdoucich mereni
+#define STATS_LEAF_SAMPLES 16
+#define STATS_LEAVES 512
+
+// cilove rozmezi glykemie (mmol/l * 100) pro cas v rozmezi (time in range)
+#define STATS_RANGE_LOW 390
+#define STATS_RANGE_HIGH 1000
+
+// uzel stromu intervalu, minimum a maximum predpokladaji hodnoty v rozsahu int16
+struct StatsNode {
+  int32_t sum;
+  uint16_t count;
+  uint16_t inRange;
+  int16_t min;
+  int16_t max;
+};
+
+struct WindowStats {
+  uint32_t count;
+  uint32_t inRange;
+  int64_t sum;
+  int32_t min;
+  int32_t max;
+};
+
+// zdroj jednotlivych mereni pro okrajove listy okna - prvni mereni novejsi nez time
+typedef bool (*StatsSource)(int32_t time, CGMeasurement *measurement);
+
+
+/* FUNKCE STATISTIK */
+
+void stats_init(StatsSource source);
+
+void stats_push(CGMeasurement measurement);
+
+bool stats_query(int32_t from, int32_t to, WindowStats *stats);
+
+#endif
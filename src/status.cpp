@@ -0,0 +1,48 @@
+#include "bytes.h"
+#include "status.h"
+
+/**
+ * @brief zakoduje stavovy snimek
+ * 
+ * @param status stav senzoru a relace klienta
+ * @param dest buffer o velikosti alespon STATUS_SIZE
+ * @return STATUS_SIZE
+ */
+size_t status_pack(const SensorStatus *status, uint8_t *dest) {
+  dest[0] = (status->state & 0x0F) | (status->securityState << 4);
+  dest[1] = status->interval;
+  putLE(dest + 2, status->securityValue, 4);
+  putLE(dest + 6, (uint32_t)status->lastTime, 4);
+  putLE(dest + 10, status->lastValue, 2);
+  putLE(dest + 12, (uint32_t)status->firstTime, 4);
+  putLE(dest + 16, (uint32_t)status->acknowledged, 4);
+  return STATUS_SIZE;
+}
+
+/**
+ * @brief vyplni souhrn okna statistik - prumer, extremy a cas v rozmezi v promile
+ * 
+ * @param day souhrn poslednich 24 hodin
+ * @param stats statistiky okna s alespon jednim merenim
+ */
+void status_set_stats(DayStats *day, const WindowStats *stats) {
+  day->mean = (uint16_t)(stats->sum / stats->count);
+  day->min = (uint16_t)stats->min;
+  day->max = (uint16_t)stats->max;
+  day->inRange = (uint16_t)((uint64_t)stats->inRange * 1000 / stats->count);
+}
+
+/**
+ * @brief zakoduje souhrn poslednich 24 hodin
+ * 
+ * @param day souhrn
+ * @param dest buffer o velikosti alespon STATUS_STATS_SIZE
+ * @return STATUS_STATS_SIZE
+ */
+size_t status_pack_stats(const DayStats *day, uint8_t *dest) {
+  putLE(dest, day->mean, 2);
+  putLE(dest + 2, day->min, 2);
+  putLE(dest + 4, day->max, 2);
+  putLE(dest + 6, day->inRange, 2);
+  return STATUS_STATS_SIZE;
+}
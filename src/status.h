@@ -0,0 +1,58 @@
+#ifndef STATUS_H
+#define STATUS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "stats.h"
+
+/* STAVOVY SNIMEK SENZORU */
+
+/**
+ * Jedno cteni misto cteni akce, hodnoty zabezpeceni a mereni (little-endian):
+ * stav relace (dolni 4 bity) a podstav zabezpeceni (horni 4 bity) v jednom bajtu,
+ * interval mereni v sekundach (uint8), hodnota zabezpeceni (uint32 - nahodna zprava
+ * ve stavu AUTH, jinak verejny klic serveru), cas (int32) a hodnota (uint16)
+ * posledniho mereni, cas nejstarsiho ulozeneho mereni (int32) a posledni potvrzeny
+ * cas (int32).
+ * Mereni a hranice historie se vyplni az ve stavu READY, jinak obsahuji -1 a 0.
+ * Snimek se vejde do jednoho cteni i pri vychozim MTU 23 (MTU - 3 bajty hlavicky).
+ */
+#define STATUS_SIZE 20
+
+/**
+ * Souhrn poslednich 24 hodin ma vlastni charakteristiku (little-endian, uint16):
+ * prumer, minimum, maximum a podil casu v cilovem rozmezi v promile.
+ */
+#define STATUS_STATS_SIZE 8
+
+// okno souhrnnych statistik - konci poslednim merenim
+#define STATUS_STATS_WINDOW (24 * 3600)
+
+struct SensorStatus {
+  uint8_t state;
+  uint8_t securityState;
+  uint8_t interval;
+  uint32_t securityValue;
+  int32_t lastTime;
+  uint16_t lastValue;
+  int32_t firstTime;
+  int32_t acknowledged;
+};
+
+struct DayStats {
+  uint16_t mean;
+  uint16_t min;
+  uint16_t max;
+  uint16_t inRange;
+};
+
+
+/* FUNKCE STAVOVEHO SNIMKU */
+
+size_t status_pack(const SensorStatus *status, uint8_t *dest);
+
+void status_set_stats(DayStats *day, const WindowStats *stats);
+
+size_t status_pack_stats(const DayStats *day, uint8_t *dest);
+
+#endif
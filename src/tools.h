@@ -1,7 +1,7 @@
 #ifndef TOOLS_H
 #define TOOLS_H
 
-#include <Arduino.h>
+#include <stdint.h>
 
 uint32_t set_nth_bit_to(uint32_t reg, int n, bool to);
 
@@ -7,6 +7,16 @@
 /* Charakteristiky */
 #define CGM_MEASUREMENT_CHARACTERISTIC_UUID "aa2c4908-64d5-4c89-8ae7-37932f15eadf"
 #define CGM_TIME_CHARACTERISTIC_UUID "4f992bbe-675e-4950-9d6c-79acb1cdfa93"
+#define CGM_ROLLUP_CHARACTERISTIC_UUID "6a51812b-2f8f-4149-9a3b-3e3097cd267e"
+#define CGM_ACK_CHARACTERISTIC_UUID "a6114e76-5c26-4dfa-adad-7ceedfad54c6"
+#define CGM_AGP_CHARACTERISTIC_UUID "6fa35e0e-9e9f-4b0f-a141-2ed483ecf0ac"
+#define CGM_FORMAT_CHARACTERISTIC_UUID "e70c5d8b-3eae-4881-bab7-bc77a63991e5"
+#define CGM_BACKFILL_CHARACTERISTIC_UUID "f2f72c42-da41-49fc-9cf2-225554c6e6e7"
+#define CGM_METRICS_CHARACTERISTIC_UUID "3ad13554-31be-43dc-876c-7dc8fd8a474a"
+#define CGM_RACP_CHARACTERISTIC_UUID "497c92df-c2ab-4900-b436-a34b6732460b"
+#define CGM_CHART_CHARACTERISTIC_UUID "e1832bf9-7dfe-4cfd-8e9b-f3d49968bb37"
+#define CGM_STATUS_CHARACTERISTIC_UUID "82b500ee-239f-4fde-992c-711a05409587"
+#define CGM_STATS_CHARACTERISTIC_UUID "5d0c7f3a-8e41-4b2a-9c6d-1f27b3e8a940"
 
 
 /* SLUZBA ZABEZPECENI SENZORU */
@@ -0,0 +1,182 @@
+#ifndef FAKE_ARDUINO_H
+#define FAKE_ARDUINO_H
+
+/**
+ * Napodobenina Arduina a FreeRTOS pro preklad main.cpp na PC. Vse bezi v jednom
+ * vlakne - cas se posouva jen cekanim (delay, xQueueReceive s timeoutem) a ulohy
+ * se nespousti, test jejich praci dela sam. Napodobeniny, ktere maji bezet na pozadi
+ * (stack BLE), se zaregistruji jako tiker a bezi po kazde milisekunde cekani.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+#include <deque>
+#include <string>
+#include <vector>
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+
+
+/* CAS A VYVODY */
+
+// cas od startu v ms
+inline uint32_t &fake_clock() {
+  static uint32_t now = 0;
+  return now;
+}
+
+// prace na pozadi, ktera bezi pri kazdem posunu casu o 1 ms
+typedef void (*FakeTicker)();
+
+inline FakeTicker &fake_ticker() {
+  static FakeTicker ticker = NULL;
+  return ticker;
+}
+
+inline void fake_tick() {
+  fake_clock()++;
+  if (fake_ticker() != NULL) {
+    fake_ticker()();
+  }
+}
+
+inline unsigned long millis() {
+  return fake_clock();
+}
+
+inline unsigned long micros() {
+  return fake_clock() * 1000ul;
+}
+
+inline void delay(unsigned long ms) {
+  for (unsigned long i = 0; i < ms; ++i) {
+    fake_tick();
+  }
+}
+
+inline void pinMode(int pin, int mode) {
+}
+
+inline void digitalWrite(int pin, int value) {
+}
+
+inline int analogRead(int pin) {
+  return 0;
+}
+
+inline long map(long x, long inMin, long inMax, long outMin, long outMax) {
+  return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+
+/* SERIOVA LINKA */
+
+class String {
+  public:
+    String() {}
+    String(const char *text): text(text) {}
+    const char *c_str() const { return text.c_str(); }
+
+  private:
+    std::string text;
+};
+
+// vystup se zahazuje, simulator pacienta nic neposila
+class HardwareSerial {
+  public:
+    void begin(unsigned long baud) {}
+    size_t println(const char *text = "") { return 0; }
+    size_t printf(const char *format, ...) { return 0; }
+    String readStringUntil(char terminator) { return String(); }
+};
+
+static HardwareSerial Serial;
+
+
+/* FREERTOS */
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define portMAX_DELAY 0xFFFFFFFF
+
+struct FakeQueue {
+  size_t itemSize;
+  size_t length;
+  std::deque<std::vector<uint8_t> > items;
+};
+
+typedef FakeQueue *QueueHandle_t;
+
+inline QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+  FakeQueue *queue = new FakeQueue();
+  queue->itemSize = itemSize;
+  queue->length = length;
+  return queue;
+}
+
+// plna fronta by v jednom vlakne cekala navzdy, odeslani proto rovnou selze
+inline BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t wait) {
+  if (queue->items.size() >= queue->length) {
+    return pdFALSE;
+  }
+  const uint8_t *bytes = (const uint8_t *)item;
+  queue->items.push_back(std::vector<uint8_t>(bytes, bytes + queue->itemSize));
+  return pdTRUE;
+}
+
+// prazdna fronta posouva cas, dokud do ni prace na pozadi neco neposle, nejvyse o cely timeout
+inline BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t wait) {
+  for (TickType_t waited = 0; queue->items.empty() && wait != portMAX_DELAY && waited < wait; ++waited) {
+    fake_tick();
+  }
+  if (queue->items.empty()) {
+    return pdFALSE;
+  }
+  memcpy(item, queue->items.front().data(), queue->itemSize);
+  queue->items.pop_front();
+  return pdTRUE;
+}
+
+inline UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queue) {
+  return queue->length - queue->items.size();
+}
+
+inline TickType_t xTaskGetTickCount() {
+  return fake_clock();
+}
+
+inline void vTaskDelayUntil(TickType_t *previous, TickType_t increment) {
+  *previous += increment;
+  while (fake_clock() < *previous) {
+    fake_tick();
+  }
+}
+
+inline BaseType_t xPortGetCoreID() {
+  return 1;
+}
+
+// uloha se nespusti
+inline BaseType_t xTaskCreatePinnedToCore(void (*task)(void *), const char *name, uint32_t stack, void *parameter, UBaseType_t priority, void *handle, BaseType_t core) {
+  return pdTRUE;
+}
+
+typedef int portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED 0
+#define portENTER_CRITICAL(mux) ((void)(mux))
+#define portEXIT_CRITICAL(mux) ((void)(mux))
+
+#endif
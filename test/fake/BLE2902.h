@@ -0,0 +1,13 @@
+#ifndef FAKE_BLE2902_H
+#define FAKE_BLE2902_H
+
+#include <BLEDevice.h>
+
+/**
+ * Napodobenina deskriptoru CCCD - zapisy odberu eviduje aplikace ve vlastnim handleru GATTS.
+ */
+
+class BLE2902: public BLEDescriptor {
+};
+
+#endif
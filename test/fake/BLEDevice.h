@@ -0,0 +1,424 @@
+#ifndef FAKE_BLEDEVICE_H
+#define FAKE_BLEDEVICE_H
+
+/**
+ * Napodobenina knihovny BLE pro ESP32 a stacku pod ni. Server, charakteristiky
+ * a deskriptory se chovaji jako v knihovne (callbacky dostanou parametry udalosti,
+ * vlastni handlery GATTS a GAP se volaji po knihovne), odeslane notifikace se jen
+ * zaznamenaji. Akce protistrany vyvolava test funkcemi fake_*, ty bezi hned -
+ * v realnem zarizeni by bezely v uloze BT.
+ * 
+ * Spojeni bez modelu (fake_link) dorucuje notifikace okamzite. Spojeni s modelem
+ * je radi do fronty stacku a dorucuje je v udalostech spojeni podle virtualnich
+ * hodin - nejvyse budget paketu za interval, ztraceny paket se opakuje v dalsi
+ * udalosti a spojeni, ktere po dobu supervision timeoutu nic neprenese, se odpoji.
+ */
+
+#include <Arduino.h>
+#include <map>
+#include "esp_gatts_api.h"
+#include "esp_gap_ble_api.h"
+
+#define FAKE_GATTS_IF 3
+#define FAKE_DEFAULT_MTU 23
+
+// fronta notifikaci stacku na jedno spojeni, plna fronta hlasi zahlceni
+#define FAKE_TX_QUEUE_LENGTH 10
+
+class BLECharacteristic;
+class BLEServer;
+
+// notifikace prijata protistranou a cas jejiho doruceni (ms)
+struct FakeNotification {
+  uint16_t connId;
+  uint16_t handle;
+  std::vector<uint8_t> value;
+  uint32_t time;
+};
+
+// model spojeni - interval v us, paketu za udalost, ztracene pakety v promile
+// a supervision timeout v ms (0 = spojeni nevyprsi)
+struct FakeLink {
+  uint32_t interval;
+  uint8_t budget;
+  uint16_t lossPermille;
+  uint32_t supervisionTimeout;
+  uint64_t nextEvent;
+  uint32_t lastReceived;
+  bool congested;
+  uint32_t retransmitted;
+  std::deque<FakeNotification> queue;
+};
+
+// stav stacku - handly, MTU a modely spojeni a prijate notifikace; rejectSends odmitne
+// tolik nasledujicich notifikaci, jako by byla plna fronta stacku
+struct FakeStack {
+  uint16_t nextHandle;
+  std::map<uint16_t, BLECharacteristic *> characteristics;
+  std::map<uint16_t, uint16_t> mtu;
+  std::map<uint16_t, FakeLink> links;
+  std::vector<FakeNotification> notifications;
+  uint32_t rejectSends;
+  uint32_t lossSeed;
+  bool advertising;
+  BLEServer *server;
+  void (*gapHandler)(esp_gap_ble_cb_event_t, esp_ble_gap_cb_param_t *);
+  void (*gattsHandler)(esp_gatts_cb_event_t, esp_gatt_if_t, esp_ble_gatts_cb_param_t *);
+};
+
+inline FakeStack &fake_stack() {
+  static FakeStack stack = {1};
+  return stack;
+}
+
+
+/* KNIHOVNA BLE */
+
+class BLEUUID {
+  public:
+    BLEUUID(const char *uuid) {}
+};
+
+class BLEDescriptor {
+  public:
+    BLEDescriptor(): handle(fake_stack().nextHandle++) {}
+    virtual ~BLEDescriptor() {}
+    uint16_t getHandle() { return handle; }
+
+  private:
+    uint16_t handle;
+};
+
+class BLECharacteristicCallbacks {
+  public:
+    virtual ~BLECharacteristicCallbacks() {}
+    virtual void onRead(BLECharacteristic *characteristic) {}
+    virtual void onRead(BLECharacteristic *characteristic, esp_ble_gatts_cb_param_t *param) { onRead(characteristic); }
+    virtual void onWrite(BLECharacteristic *characteristic) {}
+    virtual void onWrite(BLECharacteristic *characteristic, esp_ble_gatts_cb_param_t *param) { onWrite(characteristic); }
+};
+
+class BLECharacteristic {
+  public:
+    static const uint32_t PROPERTY_READ = 1 << 0;
+    static const uint32_t PROPERTY_WRITE = 1 << 1;
+    static const uint32_t PROPERTY_NOTIFY = 1 << 2;
+    static const uint32_t PROPERTY_INDICATE = 1 << 3;
+
+    BLECharacteristic(const char *uuid, uint32_t properties = 0): handle(fake_stack().nextHandle++), callbacks(NULL) {
+      fake_stack().characteristics[handle] = this;
+    }
+
+    void setCallbacks(BLECharacteristicCallbacks *characteristicCallbacks) { callbacks = characteristicCallbacks; }
+    BLECharacteristicCallbacks *getCallbacks() { return callbacks; }
+    void addDescriptor(BLEDescriptor *descriptor) {}
+    void setValue(const char *text) { value = text; }
+    void setValue(const std::string &text) { value = text; }
+    void setValue(const uint8_t *data, size_t len) { value.assign((const char *)data, len); }
+    std::string getValue() { return value; }
+    uint16_t getHandle() { return handle; }
+
+  private:
+    uint16_t handle;
+    BLECharacteristicCallbacks *callbacks;
+    std::string value;
+};
+
+class BLEService {
+  public:
+    void addCharacteristic(BLECharacteristic *characteristic) {}
+    void start() {}
+};
+
+class BLEAdvertisementData {
+  public:
+    void setManufacturerData(const std::string &data) { manufacturerData = data; }
+
+    std::string manufacturerData;
+};
+
+class BLEAdvertising {
+  public:
+    void start() { fake_stack().advertising = true; }
+    void stop() { fake_stack().advertising = false; }
+    void setScanResponseData(BLEAdvertisementData &data) { scanResponse = data; }
+
+    BLEAdvertisementData scanResponse;
+};
+
+class BLEServerCallbacks {
+  public:
+    virtual ~BLEServerCallbacks() {}
+    virtual void onConnect(BLEServer *server) {}
+    virtual void onConnect(BLEServer *server, esp_ble_gatts_cb_param_t *param) {}
+    virtual void onDisconnect(BLEServer *server) {}
+    virtual void onDisconnect(BLEServer *server, esp_ble_gatts_cb_param_t *param) {}
+};
+
+class BLEServer {
+  public:
+    BLEServer(): callbacks(NULL) {}
+
+    BLEService *createService(BLEUUID uuid, uint32_t handles = 15, uint8_t instance = 0) { return new BLEService(); }
+    void setCallbacks(BLEServerCallbacks *serverCallbacks) { callbacks = serverCallbacks; }
+    BLEServerCallbacks *getCallbacks() { return callbacks; }
+    BLEAdvertising *getAdvertising() { return &advertising; }
+    esp_gatt_if_t getGattsIf() { return FAKE_GATTS_IF; }
+
+    uint16_t getPeerMTU(uint16_t connId) {
+      std::map<uint16_t, uint16_t>::iterator found = fake_stack().mtu.find(connId);
+      return (found != fake_stack().mtu.end()) ? found->second : 0;
+    }
+
+  private:
+    BLEServerCallbacks *callbacks;
+    BLEAdvertising advertising;
+};
+
+class BLEDevice {
+  public:
+    static void init(const std::string &name) {}
+    static void setMTU(uint16_t mtu) {}
+
+    static BLEServer *createServer() {
+      fake_stack().server = new BLEServer();
+      return fake_stack().server;
+    }
+
+    static void setCustomGapHandler(void (*handler)(esp_gap_ble_cb_event_t, esp_ble_gap_cb_param_t *)) {
+      fake_stack().gapHandler = handler;
+    }
+
+    static void setCustomGattsHandler(void (*handler)(esp_gatts_cb_event_t, esp_gatt_if_t, esp_ble_gatts_cb_param_t *)) {
+      fake_stack().gattsHandler = handler;
+    }
+};
+
+inline void fake_congest(uint16_t connId, bool congested);
+
+// spojeni s modelem radi notifikaci do fronty, zaplneni fronty ohlasi udalosti zahlceni
+inline esp_err_t esp_ble_gatts_send_indicate(esp_gatt_if_t gattsIf, uint16_t connId, uint16_t handle, uint16_t len, uint8_t *value, bool confirm) {
+  FakeStack &stack = fake_stack();
+
+  if (stack.rejectSends > 0) {
+    stack.rejectSends--;
+    return ESP_FAIL;
+  }
+  FakeNotification notification = {connId, handle, std::vector<uint8_t>(value, value + len), fake_clock()};
+  std::map<uint16_t, FakeLink>::iterator found = stack.links.find(connId);
+  if (found == stack.links.end()) {
+    stack.notifications.push_back(notification);
+    return ESP_OK;
+  }
+
+  FakeLink &link = found->second;
+  if (link.queue.size() >= FAKE_TX_QUEUE_LENGTH) {
+    return ESP_FAIL;
+  }
+  link.queue.push_back(notification);
+  if (link.queue.size() >= FAKE_TX_QUEUE_LENGTH && !link.congested) {
+    link.congested = true;
+    fake_congest(connId, true);
+  }
+  return ESP_OK;
+}
+
+
+/* AKCE PROTISTRANY */
+
+// udalost GATTS projde knihovnou a pote vlastnim handlerem aplikace
+inline void fake_gatts_event(esp_gatts_cb_event_t event, esp_ble_gatts_cb_param_t *param) {
+  FakeStack &stack = fake_stack();
+
+  if (stack.gattsHandler != NULL) {
+    stack.gattsHandler(event, FAKE_GATTS_IF, param);
+  }
+}
+
+inline void fake_connect(uint16_t connId, const uint8_t *address) {
+  FakeStack &stack = fake_stack();
+  esp_ble_gatts_cb_param_t param;
+
+  memset(&param, 0, sizeof(param));
+  param.connect.conn_id = connId;
+  memcpy(param.connect.remote_bda, address, sizeof(esp_bd_addr_t));
+  stack.mtu[connId] = FAKE_DEFAULT_MTU;
+  // po pripojeni se advertising zastavi, aplikace jej podle potreby spusti znovu
+  stack.advertising = false;
+  stack.server->getCallbacks()->onConnect(stack.server);
+  stack.server->getCallbacks()->onConnect(stack.server, &param);
+  fake_gatts_event(ESP_GATTS_CONNECT_EVT, &param);
+}
+
+// nedorucene notifikace ve fronte stacku se odpojenim zahodi
+inline void fake_disconnect(uint16_t connId) {
+  FakeStack &stack = fake_stack();
+  esp_ble_gatts_cb_param_t param;
+
+  memset(&param, 0, sizeof(param));
+  param.disconnect.conn_id = connId;
+  stack.mtu.erase(connId);
+  stack.links.erase(connId);
+  stack.server->getCallbacks()->onDisconnect(stack.server);
+  stack.server->getCallbacks()->onDisconnect(stack.server, &param);
+  fake_gatts_event(ESP_GATTS_DISCONNECT_EVT, &param);
+}
+
+inline void fake_exchange_mtu(uint16_t connId, uint16_t mtu) {
+  esp_ble_gatts_cb_param_t param;
+
+  memset(&param, 0, sizeof(param));
+  param.mtu.conn_id = connId;
+  param.mtu.mtu = mtu;
+  fake_stack().mtu[connId] = mtu;
+  fake_gatts_event(ESP_GATTS_MTU_EVT, &param);
+}
+
+// zapis hodnoty charakteristiky nebo deskriptoru
+inline void fake_write(uint16_t connId, uint16_t handle, const uint8_t *data, size_t len) {
+  std::vector<uint8_t> value(data, data + len);
+  esp_ble_gatts_cb_param_t param;
+
+  memset(&param, 0, sizeof(param));
+  param.write.conn_id = connId;
+  param.write.handle = handle;
+  param.write.len = len;
+  param.write.value = value.data();
+
+  std::map<uint16_t, BLECharacteristic *>::iterator found = fake_stack().characteristics.find(handle);
+  if (found != fake_stack().characteristics.end()) {
+    found->second->setValue(data, len);
+    if (found->second->getCallbacks() != NULL) {
+      found->second->getCallbacks()->onWrite(found->second, &param);
+    }
+  }
+  fake_gatts_event(ESP_GATTS_WRITE_EVT, &param);
+}
+
+inline void fake_write(uint16_t connId, uint16_t handle, const char *text) {
+  fake_write(connId, handle, (const uint8_t *)text, strlen(text));
+}
+
+inline std::string fake_read(uint16_t connId, uint16_t handle) {
+  esp_ble_gatts_cb_param_t param;
+
+  memset(&param, 0, sizeof(param));
+  param.read.conn_id = connId;
+  param.read.handle = handle;
+
+  BLECharacteristic *characteristic = fake_stack().characteristics[handle];
+  if (characteristic->getCallbacks() != NULL) {
+    characteristic->getCallbacks()->onRead(characteristic, &param);
+  }
+  fake_gatts_event(ESP_GATTS_READ_EVT, &param);
+  return characteristic->getValue();
+}
+
+inline void fake_congest(uint16_t connId, bool congested) {
+  esp_ble_gatts_cb_param_t param;
+
+  memset(&param, 0, sizeof(param));
+  param.congest.conn_id = connId;
+  param.congest.congested = congested;
+  fake_gatts_event(ESP_GATTS_CONGEST_EVT, &param);
+}
+
+// centralni zarizeni prijalo parametry spojeni s danou protistranou
+inline void fake_update_conn_params(const uint8_t *address, uint16_t interval, uint16_t latency, uint16_t timeout) {
+  esp_ble_gap_cb_param_t param;
+
+  memset(&param, 0, sizeof(param));
+  param.update_conn_params.status = ESP_BT_STATUS_SUCCESS;
+  memcpy(param.update_conn_params.bda, address, sizeof(esp_bd_addr_t));
+  param.update_conn_params.conn_int = interval;
+  param.update_conn_params.latency = latency;
+  param.update_conn_params.timeout = timeout;
+  if (fake_stack().gapHandler != NULL) {
+    fake_stack().gapHandler(ESP_GAP_BLE_UPDATE_CONN_PARAMS_EVT, &param);
+  }
+}
+
+
+/* MODEL SPOJENI */
+
+// ztrata paketu podle pevne posloupnosti (xorshift), aby byl beh testu opakovatelny
+inline bool fake_packet_lost(const FakeLink &link) {
+  uint32_t &seed = fake_stack().lossSeed;
+
+  if (link.lossPermille == 0) {
+    return false;
+  }
+  seed = (seed == 0) ? 2463534242u : seed;
+  seed ^= seed << 13;
+  seed ^= seed >> 17;
+  seed ^= seed << 5;
+  return seed % 1000 < link.lossPermille;
+}
+
+// udalost spojeni - i bez notifikaci se vymeni prazdny paket, ztraceny paket udalost
+// ukonci a notifikace zustane ve fronte
+inline void fake_connection_event(uint16_t connId, FakeLink &link) {
+  for (uint8_t i = 0; i < link.budget && (i == 0 || !link.queue.empty()); ++i) {
+    if (fake_packet_lost(link)) {
+      link.retransmitted += link.queue.empty() ? 0 : 1;
+      break;
+    }
+    link.lastReceived = fake_clock();
+    if (!link.queue.empty()) {
+      link.queue.front().time = fake_clock();
+      fake_stack().notifications.push_back(link.queue.front());
+      link.queue.pop_front();
+    }
+  }
+  if (link.congested && link.queue.size() <= FAKE_TX_QUEUE_LENGTH / 2) {
+    link.congested = false;
+    fake_congest(connId, false);
+  }
+}
+
+// tiker virtualnich hodin - probehnou udalosti vsech spojeni, ktere mezitim nastaly
+inline void fake_link_tick() {
+  FakeStack &stack = fake_stack();
+  uint64_t now = (uint64_t)fake_clock() * 1000;
+  std::vector<uint16_t> expired;
+
+  for (std::map<uint16_t, FakeLink>::iterator it = stack.links.begin(); it != stack.links.end(); ++it) {
+    FakeLink &link = it->second;
+    while (link.nextEvent <= now) {
+      link.nextEvent += link.interval;
+      fake_connection_event(it->first, link);
+    }
+    if (link.supervisionTimeout > 0 && fake_clock() - link.lastReceived >= link.supervisionTimeout) {
+      expired.push_back(it->first);
+    }
+  }
+  for (size_t i = 0; i < expired.size(); ++i) {
+    fake_disconnect(expired[i]);
+  }
+}
+
+/**
+ * @brief nastavi model pripojeneho spojeni, prvni udalost nastane po jednom intervalu
+ * 
+ * @param connId spojeni
+ * @param interval interval spojeni v jednotkach 1.25 ms
+ * @param budget nejvyssi pocet notifikaci za udalost spojeni
+ * @param lossPermille ztracene pakety v promile
+ * @param supervisionTimeout doba bez prenosu do odpojeni v ms, 0 = spojeni nevyprsi
+ */
+inline void fake_link(uint16_t connId, uint16_t interval, uint8_t budget, uint16_t lossPermille = 0, uint32_t supervisionTimeout = 0) {
+  FakeLink &link = fake_stack().links[connId];
+
+  link.interval = interval * 1250;
+  link.budget = budget;
+  link.lossPermille = lossPermille;
+  link.supervisionTimeout = supervisionTimeout;
+  link.nextEvent = (uint64_t)fake_clock() * 1000 + link.interval;
+  link.lastReceived = fake_clock();
+  link.congested = false;
+  link.retransmitted = 0;
+  link.queue.clear();
+  fake_ticker() = fake_link_tick;
+}
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef FAKE_SSD1306_H
+#define FAKE_SSD1306_H
+
+#include <stdint.h>
+
+/**
+ * Napodobenina displeje - kresleni nic nedela.
+ */
+
+#define ArialMT_Plain_10 0
+#define ArialMT_Plain_16 1
+#define TEXT_ALIGN_CENTER 0
+
+class SSD1306 {
+  public:
+    SSD1306(uint8_t address, int sda, int scl) {}
+    void init() {}
+    void flipScreenVertically() {}
+    void setFont(int font) {}
+    void setTextAlignment(int alignment) {}
+    void clear() {}
+    void drawString(int x, int y, const char *text) {}
+    void drawStringMaxWidth(int x, int y, int width, const char *text) {}
+    void drawHorizontalLine(int x, int y, int length) {}
+    void display() {}
+};
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef FAKE_ESP_GAP_BLE_API_H
+#define FAKE_ESP_GAP_BLE_API_H
+
+#include "esp_gatts_api.h"
+
+/**
+ * Napodobenina typu GAP z ESP-IDF - jen udalost zmeny parametru spojeni.
+ */
+
+#define ESP_BT_STATUS_SUCCESS 0
+
+typedef enum {
+  ESP_GAP_BLE_UPDATE_CONN_PARAMS_EVT
+} esp_gap_ble_cb_event_t;
+
+typedef union {
+  struct {
+    int status;
+    esp_bd_addr_t bda;
+    uint16_t min_int;
+    uint16_t max_int;
+    uint16_t latency;
+    uint16_t conn_int;
+    uint16_t timeout;
+  } update_conn_params;
+} esp_ble_gap_cb_param_t;
+
+typedef struct {
+  esp_bd_addr_t bda;
+  uint16_t min_int;
+  uint16_t max_int;
+  uint16_t latency;
+  uint16_t timeout;
+} esp_ble_conn_update_params_t;
+
+#endif
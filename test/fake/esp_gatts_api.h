@@ -0,0 +1,72 @@
+#ifndef FAKE_ESP_GATTS_API_H
+#define FAKE_ESP_GATTS_API_H
+
+#include <stdint.h>
+
+/**
+ * Napodobenina typu GATT serveru z ESP-IDF - jen udalosti a pole, ktera pouziva main.cpp.
+ */
+
+typedef int esp_err_t;
+
+#define ESP_OK 0
+#define ESP_FAIL -1
+
+typedef uint8_t esp_bd_addr_t[6];
+typedef uint8_t esp_gatt_if_t;
+
+typedef enum {
+  ESP_GATTS_READ_EVT,
+  ESP_GATTS_WRITE_EVT,
+  ESP_GATTS_MTU_EVT,
+  ESP_GATTS_CONNECT_EVT,
+  ESP_GATTS_DISCONNECT_EVT,
+  ESP_GATTS_CONGEST_EVT
+} esp_gatts_cb_event_t;
+
+typedef union {
+  struct {
+    uint16_t conn_id;
+    esp_bd_addr_t remote_bda;
+  } connect;
+
+  struct {
+    uint16_t conn_id;
+    esp_bd_addr_t remote_bda;
+    int reason;
+  } disconnect;
+
+  struct {
+    uint16_t conn_id;
+    uint32_t trans_id;
+    esp_bd_addr_t bda;
+    uint16_t handle;
+    uint16_t offset;
+    bool need_rsp;
+    bool is_prep;
+    uint16_t len;
+    uint8_t *value;
+  } write;
+
+  struct {
+    uint16_t conn_id;
+    uint32_t trans_id;
+    esp_bd_addr_t bda;
+    uint16_t handle;
+    uint16_t offset;
+    bool is_long;
+    bool need_rsp;
+  } read;
+
+  struct {
+    uint16_t conn_id;
+    uint16_t mtu;
+  } mtu;
+
+  struct {
+    uint16_t conn_id;
+    bool congested;
+  } congest;
+} esp_ble_gatts_cb_param_t;
+
+#endif
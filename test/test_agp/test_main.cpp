@@ -0,0 +1,153 @@
+#include <string.h>
+#include <unity.h>
+
+#include "agp.h"
+
+#define INTERVAL 300
+#define DAYS 30
+#define SAMPLES (DAYS * AGP_DAY / INTERVAL)
+
+// log drzi mereni 5 dni - mene nez okno profilu
+#define RETAINED (5 * AGP_DAY / INTERVAL)
+
+static CGMeasurement samples[SAMPLES + 1];
+static uint32_t pushed = 0;
+static uint32_t retainedFrom = 0;
+
+// zdroj mereni - jen mereni, ktera uz byla do profilu vlozena a log je neprepsal
+static bool findAfter(int32_t time, CGMeasurement *measurement) {
+  for (uint32_t i = retainedFrom; i < pushed; ++i) {
+    if (samples[i].timeOffset > time) {
+      *measurement = samples[i];
+      return true;
+    }
+  }
+  return false;
+}
+
+static uint32_t totalCount() {
+  uint32_t total = 0;
+  for (uint8_t bucket = 0; bucket < AGP_BUCKETS; ++bucket) {
+    total += agp_count(bucket);
+  }
+  return total;
+}
+
+void setUp() {
+  // hodnota zavisi na case dne i na dni - starsi dny maji jinou uroven
+  for (uint32_t i = 0; i <= SAMPLES; ++i) {
+    int32_t time = i * INTERVAL;
+    samples[i] = CGMeasurement{time, 400 + (time % AGP_DAY) / 200 + (time / AGP_DAY) * 20};
+  }
+  pushed = 0;
+  retainedFrom = 0;
+}
+
+void tearDown() {
+}
+
+// useky se vztahuji k casu dne zacatku relace
+void test_buckets_follow_origin() {
+  agp_init(findAfter, 3600);
+  samples[0] = CGMeasurement{0, 500};
+  pushed = 1;
+  agp_push(samples[0]);
+  TEST_ASSERT_EQUAL_UINT32(1, agp_count(3600 / AGP_BUCKET_WIDTH));
+  TEST_ASSERT_EQUAL_UINT32(1, totalCount());
+
+  agp_init(findAfter, AGP_DAY - AGP_BUCKET_WIDTH);
+  agp_rebuild(0);
+  TEST_ASSERT_EQUAL_UINT32(1, agp_count(AGP_BUCKETS - 1));
+}
+
+// profil obsahuje jen mereni poslednich 14 dni
+void test_window_ages_out() {
+  agp_init(findAfter, 0);
+  for (; pushed < SAMPLES; ) {
+    agp_push(samples[pushed++]);
+  }
+  TEST_ASSERT_EQUAL_UINT32(AGP_WINDOW / INTERVAL, totalCount());
+  for (uint8_t bucket = 0; bucket < AGP_BUCKETS; ++bucket) {
+    TEST_ASSERT_EQUAL_UINT32(AGP_WINDOW_DAYS * AGP_BUCKET_WIDTH / INTERVAL, agp_count(bucket));
+  }
+
+  // median useku odpovida poslednim 14 dnum, ne cele relaci
+  int32_t values[AGP_PERCENTILES];
+  TEST_ASSERT_TRUE(agp_percentiles(0, values));
+  int32_t expected = 400 + (DAYS - AGP_WINDOW_DAYS / 2) * 20;
+  TEST_ASSERT_INT32_WITHIN(AGP_BIN_WIDTH, expected, values[2]);
+}
+
+// prepocet ze zdroje (po restartu) da stejny profil jako prubezne vkladani
+void test_rebuild_matches_incremental() {
+  uint8_t incremental[AGP_PACKED_SIZE];
+  uint8_t rebuilt[AGP_PACKED_SIZE];
+
+  agp_init(findAfter, 5400);
+  for (; pushed < SAMPLES; ) {
+    agp_push(samples[pushed++]);
+  }
+  TEST_ASSERT_EQUAL_size_t(AGP_PACKED_SIZE, agp_pack(incremental, sizeof(incremental)));
+
+  agp_init(findAfter, 5400);
+  agp_rebuild(samples[SAMPLES - 1].timeOffset);
+  TEST_ASSERT_EQUAL_size_t(AGP_PACKED_SIZE, agp_pack(rebuilt, sizeof(rebuilt)));
+  TEST_ASSERT_EQUAL_MEMORY(incremental, rebuilt, AGP_PACKED_SIZE);
+
+  // po prepoctu okno dale odecita nejstarsi mereni
+  samples[SAMPLES] = CGMeasurement{samples[SAMPLES - 1].timeOffset + INTERVAL, 500};
+  agp_push(samples[pushed++]);
+  TEST_ASSERT_EQUAL_UINT32(AGP_WINDOW / INTERVAL, totalCount());
+}
+
+// log drzi mene nez okno - prepsana mereni se odectou a histogram neroste nad obsah logu
+void test_source_shorter_than_window() {
+  uint8_t incremental[AGP_PACKED_SIZE];
+  uint8_t rebuilt[AGP_PACKED_SIZE];
+
+  agp_init(findAfter, 0);
+  for (; pushed < SAMPLES; ) {
+    agp_push(samples[pushed++]);
+    if (pushed - retainedFrom > RETAINED) {
+      agp_drop(samples[retainedFrom++]);
+    }
+  }
+  TEST_ASSERT_EQUAL_UINT32(RETAINED, totalCount());
+  for (uint8_t bucket = 0; bucket < AGP_BUCKETS; ++bucket) {
+    TEST_ASSERT_EQUAL_UINT32(RETAINED / AGP_BUCKETS, agp_count(bucket));
+  }
+
+  // median useku odpovida poslednim 5 dnum
+  int32_t values[AGP_PERCENTILES];
+  TEST_ASSERT_TRUE(agp_percentiles(0, values));
+  TEST_ASSERT_INT32_WITHIN(AGP_BIN_WIDTH, 400 + (DAYS - 3) * 20, values[2]);
+
+  // prepocet po restartu vidi jen obsah logu a shoduje se s prubeznym stavem
+  agp_pack(incremental, sizeof(incremental));
+  agp_rebuild(samples[SAMPLES - 1].timeOffset);
+  agp_pack(rebuilt, sizeof(rebuilt));
+  TEST_ASSERT_EQUAL_MEMORY(incremental, rebuilt, AGP_PACKED_SIZE);
+}
+
+// bez odecitani se cetnost tridy zastavi na maximu a nepretece
+void test_bins_saturate() {
+  agp_init(NULL, 0);
+  for (int32_t i = 0; i < UINT16_MAX + 10; ++i) {
+    agp_push(CGMeasurement{i % AGP_BUCKET_WIDTH, 500});
+  }
+  TEST_ASSERT_EQUAL_UINT32(UINT16_MAX, agp_count(0));
+
+  int32_t values[AGP_PERCENTILES];
+  TEST_ASSERT_TRUE(agp_percentiles(0, values));
+  TEST_ASSERT_INT32_WITHIN(AGP_BIN_WIDTH, 500, values[2]);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_buckets_follow_origin);
+  RUN_TEST(test_window_ages_out);
+  RUN_TEST(test_rebuild_matches_incremental);
+  RUN_TEST(test_source_shorter_than_window);
+  RUN_TEST(test_bins_saturate);
+  return UNITY_END();
+}
@@ -0,0 +1,139 @@
+#include <stdlib.h>
+#include <unity.h>
+
+#include "backfill.h"
+#include "simple8b.h"
+
+#define RECORDS 3000
+
+static CGMeasurement records[RECORDS];
+static CGMeasurement decoded[RECORDS + BACKFILL_COMPRESSED_MAX_RECORDS];
+
+// zdroj mereni pro skladani paketu - prvni mereni novejsi nez time
+static bool findAfter(int32_t time, CGMeasurement *measurement) {
+  for (uint32_t i = 0; i < RECORDS; ++i) {
+    if (records[i].timeOffset > time) {
+      *measurement = records[i];
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief slozi a rozbali cely prenos od zacatku historie
+ * 
+ * @param encoding kodovani paketu
+ * @param capacity velikost paketu (MTU - 3)
+ * @return pocet rozbalenych mereni
+ */
+static size_t transfer(uint8_t encoding, size_t capacity) {
+  uint8_t packet[512];
+  int32_t time = INT32_MIN;
+  size_t total = 0;
+
+  while (true) {
+    int32_t previous = time;
+    size_t len = (encoding == BACKFILL_ENCODING_SIMPLE8B) ? backfill_pack_compressed(&time, packet, capacity) : backfill_pack(&time, packet, capacity);
+    TEST_ASSERT_LESS_OR_EQUAL(capacity, len);
+    if (packet[0] == 0) {
+      TEST_ASSERT_EQUAL_INT32(previous, time);
+      return total;
+    }
+
+    size_t count = (encoding == BACKFILL_ENCODING_SIMPLE8B) ? backfill_unpack_compressed(packet, len, decoded + total, BACKFILL_COMPRESSED_MAX_RECORDS) : backfill_unpack(packet, len, decoded + total, BACKFILL_COMPRESSED_MAX_RECORDS);
+    TEST_ASSERT_EQUAL_size_t(packet[0], count);
+    total += count;
+    // kurzor se posune na posledni zabalene mereni
+    TEST_ASSERT_EQUAL_INT32(decoded[total - 1].timeOffset, time);
+  }
+}
+
+static void assertDecoded(size_t count) {
+  TEST_ASSERT_EQUAL_size_t(RECORDS, count);
+  for (uint32_t i = 0; i < RECORDS; ++i) {
+    TEST_ASSERT_EQUAL_INT32(records[i].timeOffset, decoded[i].timeOffset);
+    TEST_ASSERT_EQUAL_INT32(records[i].glucoseValue, decoded[i].glucoseValue);
+  }
+}
+
+void setUp() {
+  // interval 5 minut s odchylkou, obcasnymi vypadky a skoky hodnot
+  int32_t time = -1000;
+  int32_t value = 600;
+  for (uint32_t i = 0; i < RECORDS; ++i) {
+    time += 300 + rand() % 5 - 2;
+    if (rand() % 50 == 0) {
+      time += 300 * (1 + rand() % 100);
+    }
+    value += rand() % 31 - 15;
+    if (rand() % 200 == 0) {
+      value = rand() % 65536;
+    }
+    value = (value < 0) ? 0 : (value > UINT16_MAX) ? UINT16_MAX : value;
+    records[i] = CGMeasurement{time, value};
+  }
+  backfill_init(findAfter);
+}
+
+void tearDown() {
+}
+
+void test_simple8b_round_trip() {
+  uint64_t values[1000];
+  uint64_t result[1000];
+  uint8_t words[8 * 1000];
+
+  for (int round = 0; round < 200; ++round) {
+    size_t count = 1 + rand() % 1000;
+    for (size_t i = 0; i < count; ++i) {
+      // useky nul (selektory 0 a 1) i hodnoty az do 60 bitu
+      uint8_t bits = (round % 4 == 0) ? 0 : rand() % 61;
+      values[i] = (bits == 0) ? 0 : (((uint64_t)rand() << 31) ^ (uint64_t)rand() ^ ((uint64_t)rand() << 45)) & (((uint64_t)1 << bits) - 1);
+    }
+    size_t len = simple8b_encode(values, count, words, sizeof(words));
+    TEST_ASSERT_EQUAL_size_t(simple8b_words(values, count) * SIMPLE8B_WORD_SIZE, len);
+    TEST_ASSERT_EQUAL_size_t(count, simple8b_decode(words, len, result, count));
+    TEST_ASSERT_EQUAL_MEMORY(values, result, count * sizeof(uint64_t));
+  }
+}
+
+void test_simple8b_rejects_wide_values() {
+  uint64_t values[2] = {1, (uint64_t)1 << 60};
+  uint8_t words[16];
+  TEST_ASSERT_EQUAL_size_t(0, simple8b_words(values, 2));
+  TEST_ASSERT_EQUAL_size_t(0, simple8b_encode(values, 2, words, sizeof(words)));
+}
+
+void test_raw_round_trip() {
+  assertDecoded(transfer(BACKFILL_ENCODING_RAW, 20));
+  assertDecoded(transfer(BACKFILL_ENCODING_RAW, 244));
+  assertDecoded(transfer(BACKFILL_ENCODING_RAW, 509));
+}
+
+void test_compressed_round_trip() {
+  assertDecoded(transfer(BACKFILL_ENCODING_SIMPLE8B, 20));
+  assertDecoded(transfer(BACKFILL_ENCODING_SIMPLE8B, 244));
+  assertDecoded(transfer(BACKFILL_ENCODING_SIMPLE8B, 509));
+}
+
+// poskozeny nebo zkraceny paket se nerozbali
+void test_truncated_packet() {
+  uint8_t packet[244];
+  int32_t time = INT32_MIN;
+  size_t len = backfill_pack_compressed(&time, packet, sizeof(packet));
+  TEST_ASSERT_EQUAL_size_t(0, backfill_unpack_compressed(packet, len - SIMPLE8B_WORD_SIZE, decoded, RECORDS));
+  time = INT32_MIN;
+  len = backfill_pack(&time, packet, sizeof(packet));
+  TEST_ASSERT_EQUAL_size_t(0, backfill_unpack(packet, len - 1, decoded, RECORDS));
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_simple8b_round_trip);
+  RUN_TEST(test_simple8b_rejects_wide_values);
+  RUN_TEST(test_raw_round_trip);
+  RUN_TEST(test_compressed_round_trip);
+  RUN_TEST(test_truncated_packet);
+  return UNITY_END();
+}
@@ -0,0 +1,123 @@
+#include <stdio.h>
+#include <string.h>
+#include <unity.h>
+
+#include "beacon.h"
+#include "bytes.h"
+#include "session.h"
+
+#define SHARED_KEY 0x1234567
+
+static BeaconKeys keys;
+static uint8_t payload[BEACON_PAYLOAD_SIZE];
+
+static const CGMeasurement measurement = {3600, 745};
+static const CGMeasurement previous = {3540, 721};
+
+void setUp() {
+  beacon_derive(SHARED_KEY, &keys);
+  remove(SESSION_EMULATOR_FILE);
+}
+
+void tearDown() {
+}
+
+void test_seal_open_round_trip() {
+  CGMeasurement opened;
+  int8_t trend;
+
+  TEST_ASSERT_EQUAL_size_t(BEACON_PAYLOAD_SIZE, beacon_seal(&keys, 7, measurement, &previous, payload));
+  TEST_ASSERT_TRUE(beacon_open(&keys, payload, sizeof(payload), UINT32_MAX, &opened, &trend));
+  TEST_ASSERT_EQUAL_INT32(measurement.timeOffset, opened.timeOffset);
+  TEST_ASSERT_EQUAL_INT32(measurement.glucoseValue, opened.glucoseValue);
+  TEST_ASSERT_EQUAL_INT(24, trend);
+
+  // bez predchoziho mereni neni trend k dispozici
+  beacon_seal(&keys, 8, measurement, NULL, payload);
+  TEST_ASSERT_TRUE(beacon_open(&keys, payload, sizeof(payload), 7, &opened, &trend));
+  TEST_ASSERT_EQUAL_INT(0, trend);
+
+  // mereni neni v datech citelne a stejne mereni s jinym citacem se sifruje jinak
+  uint8_t other[BEACON_PAYLOAD_SIZE];
+  beacon_seal(&keys, 9, measurement, NULL, other);
+  TEST_ASSERT_FALSE(memcmp(payload + BEACON_DATA_OFFSET, other + BEACON_DATA_OFFSET, BEACON_DATA_SIZE) == 0);
+}
+
+// zmena libovolneho bitu citace, sifrovaneho bloku nebo znacky se odmitne
+void test_tampered_payload_rejected() {
+  CGMeasurement opened;
+  int8_t trend;
+  BeaconKeys otherKeys;
+
+  beacon_seal(&keys, 100, measurement, &previous, payload);
+  for (size_t i = 0; i < BEACON_PAYLOAD_SIZE; ++i) {
+    for (uint8_t bit = 0; bit < 8; ++bit) {
+      payload[i] ^= 1 << bit;
+      TEST_ASSERT_FALSE(beacon_open(&keys, payload, sizeof(payload), 50, &opened, &trend));
+      payload[i] ^= 1 << bit;
+    }
+  }
+  TEST_ASSERT_TRUE(beacon_open(&keys, payload, sizeof(payload), 50, &opened, &trend));
+
+  // zkracena data a klice z jineho sdileneho klice
+  TEST_ASSERT_FALSE(beacon_open(&keys, payload, sizeof(payload) - 1, 50, &opened, &trend));
+  beacon_derive(SHARED_KEY + 1, &otherKeys);
+  TEST_ASSERT_FALSE(beacon_open(&otherKeys, payload, sizeof(payload), 50, &opened, &trend));
+}
+
+// prijemce odmita opakovane i starsi hodnoty citace
+void test_replayed_counter_rejected() {
+  CGMeasurement opened;
+  int8_t trend;
+
+  beacon_seal(&keys, 41, measurement, &previous, payload);
+  TEST_ASSERT_TRUE(beacon_open(&keys, payload, sizeof(payload), 40, &opened, &trend));
+  TEST_ASSERT_FALSE(beacon_open(&keys, payload, sizeof(payload), 41, &opened, &trend));
+  TEST_ASSERT_FALSE(beacon_open(&keys, payload, sizeof(payload), 42, &opened, &trend));
+
+  // prvni prijem a citac 0
+  beacon_seal(&keys, 0, measurement, &previous, payload);
+  TEST_ASSERT_TRUE(beacon_open(&keys, payload, sizeof(payload), UINT32_MAX, &opened, &trend));
+  TEST_ASSERT_FALSE(beacon_open(&keys, payload, sizeof(payload), 0, &opened, &trend));
+}
+
+/**
+ * @brief restart vysilace - citac pokracuje za ulozenym rezervovanym blokem, prijemce,
+ * ktery videl posledni hodnotu pred restartem, dalsi data prijme
+ *
+ */
+void test_persisted_counter_survives_reload() {
+  PersistedSession session = {SESSION_MAGIC, SHARED_KEY, 0, -1, 0, 0};
+  PersistedSession loaded;
+  CGMeasurement opened;
+  int8_t trend;
+  uint32_t counter = 0;
+  uint32_t received = UINT32_MAX;
+
+  // vysilani rezervuje bloky stejne jako aplikace - blok se ulozi pred prvnim pouzitim
+  for (int i = 0; i < BEACON_COUNTER_BLOCK + 10; ++i) {
+    if (counter >= session.beaconReserved) {
+      session.beaconReserved = counter + BEACON_COUNTER_BLOCK;
+      TEST_ASSERT_TRUE(session_save(&session));
+    }
+    beacon_seal(&keys, counter++, measurement, &previous, payload);
+    TEST_ASSERT_TRUE(beacon_open(&keys, payload, sizeof(payload), received, &opened, &trend));
+    received = getLE(payload + BEACON_COUNTER_OFFSET, 4);
+  }
+
+  TEST_ASSERT_TRUE(session_load(&loaded));
+  TEST_ASSERT_EQUAL_UINT32(2 * BEACON_COUNTER_BLOCK, loaded.beaconReserved);
+  TEST_ASSERT_GREATER_THAN(received, loaded.beaconReserved);
+
+  beacon_seal(&keys, loaded.beaconReserved, measurement, &previous, payload);
+  TEST_ASSERT_TRUE(beacon_open(&keys, payload, sizeof(payload), received, &opened, &trend));
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_seal_open_round_trip);
+  RUN_TEST(test_tampered_payload_rejected);
+  RUN_TEST(test_replayed_counter_rejected);
+  RUN_TEST(test_persisted_counter_survives_reload);
+  return UNITY_END();
+}
@@ -0,0 +1,278 @@
+#include <algorithm>
+#include <chrono>
+#include <stdint.h>
+#include <stdio.h>
+#include <unity.h>
+
+#include <CircularBuffer.h>
+#include "measurement.h"
+
+#define BENCH_CAPACITY 1024
+#define BENCH_ROUNDS 400
+
+/**
+ * Pristup puvodni sablony CircularBuffer 1.3.3 - ukazatele na zacatek a konec a operator[]
+ * vracejici kopii prvku s modulem pri kazdem pristupu. Slouzi jen jako srovnani.
+ */
+template<typename T, size_t S> struct UpstreamBuffer {
+  T buffer[S];
+  T *head = buffer;
+  T *tail = buffer;
+  uint16_t count = 0;
+
+  bool push(T value) {
+    if (count == 0) {
+      *tail = value;
+      count++;
+      return true;
+    }
+    if (++tail == buffer + S) {
+      tail = buffer;
+    }
+    *tail = value;
+    if (count == S) {
+      if (++head == buffer + S) {
+        head = buffer;
+      }
+      return false;
+    }
+    count++;
+    return true;
+  }
+
+  T operator[](uint16_t index) const {
+    if (index >= count) {
+      return *tail;
+    }
+    return *(buffer + ((head - buffer + index) % S));
+  }
+};
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+// obsah bufferu od nejstarsiho prvku
+template<typename B> static void assertContent(const B &buffer, const int *expected, size_t count) {
+  TEST_ASSERT_EQUAL_UINT32(count, buffer.size());
+  for (size_t i = 0; i < count; ++i) {
+    TEST_ASSERT_EQUAL_INT(expected[i], buffer[i]);
+  }
+}
+
+void test_push_n_wraps_and_overwrites() {
+  CircularBuffer<int, 8> buffer;
+  int values[12];
+
+  for (int i = 0; i < 12; ++i) {
+    values[i] = i;
+  }
+  TEST_ASSERT_TRUE(buffer.push_n(values, 5));
+  TEST_ASSERT_TRUE(buffer.push_n(values + 5, 3));
+  assertContent(buffer, values, 8);
+
+  // pretece pres konec uloziste a prepise nejstarsi prvky
+  TEST_ASSERT_FALSE(buffer.push_n(values + 8, 3));
+  assertContent(buffer, values + 3, 8);
+
+  // vic prvku nez kapacita - zustane poslednich osm
+  buffer.clear();
+  TEST_ASSERT_FALSE(buffer.push_n(values, 12));
+  assertContent(buffer, values + 4, 8);
+}
+
+void test_shift_n_and_pop_n() {
+  CircularBuffer<int, 8> buffer;
+  int values[8] = {10, 11, 12, 13, 14, 15, 16, 17};
+  int dest[8];
+
+  // zacatek obsahu posunuty k okraji uloziste
+  for (int i = 0; i < 6; ++i) {
+    buffer.push(0);
+  }
+  TEST_ASSERT_EQUAL_UINT32(6, buffer.shift_n(dest, 6));
+  buffer.push_n(values, 8);
+
+  TEST_ASSERT_EQUAL_UINT32(3, buffer.shift_n(dest, 3));
+  TEST_ASSERT_EQUAL_INT_ARRAY(values, dest, 3);
+  TEST_ASSERT_EQUAL_UINT32(2, buffer.pop_n(dest, 2));
+  TEST_ASSERT_EQUAL_INT_ARRAY(values + 6, dest, 2);
+  assertContent(buffer, values + 3, 3);
+
+  // pozadavek nad obsah vrati jen ulozene prvky
+  TEST_ASSERT_EQUAL_UINT32(3, buffer.pop_n(dest, 8));
+  TEST_ASSERT_EQUAL_INT_ARRAY(values + 3, dest, 3);
+  TEST_ASSERT_TRUE(buffer.isEmpty());
+  TEST_ASSERT_EQUAL_UINT32(0, buffer.shift_n(dest, 1));
+}
+
+void test_spans_cover_content() {
+  CircularBuffer<int, 8> buffer;
+
+  TEST_ASSERT_EQUAL_UINT32(0, buffer.firstSpan().size);
+  TEST_ASSERT_EQUAL_UINT32(0, buffer.secondSpan().size);
+
+  // souvisly obsah ma jediny usek
+  for (int i = 0; i < 5; ++i) {
+    buffer.push(i);
+  }
+  TEST_ASSERT_EQUAL_UINT32(5, buffer.firstSpan().size);
+  TEST_ASSERT_EQUAL_UINT32(0, buffer.secondSpan().size);
+
+  // zalomeny obsah - usek do konce uloziste a zbytek od jeho zacatku
+  for (int i = 5; i < 11; ++i) {
+    buffer.push(i);
+  }
+  const CircularBuffer<int, 8> &view = buffer;
+  CircularBuffer<int, 8>::const_span first = view.firstSpan();
+  CircularBuffer<int, 8>::const_span second = view.secondSpan();
+  TEST_ASSERT_EQUAL_UINT32(8, first.size + second.size);
+  TEST_ASSERT_EQUAL_UINT32(5, first.size);
+  for (size_t i = 0; i < first.size; ++i) {
+    TEST_ASSERT_EQUAL_INT(3 + i, first.data[i]);
+    TEST_ASSERT_EQUAL_PTR(&buffer.at(i), &first.data[i]);
+  }
+  for (size_t i = 0; i < second.size; ++i) {
+    TEST_ASSERT_EQUAL_INT(3 + first.size + i, second.data[i]);
+  }
+
+  // zapis pres usek je zapis do bufferu
+  buffer.firstSpan().data[0] = 100;
+  TEST_ASSERT_EQUAL_INT(100, buffer.first());
+}
+
+// kapacita, ktera neni mocninou dvou, indexuje modulem
+void test_modulo_capacity() {
+  CircularBuffer<int, 6> buffer;
+  int values[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+  int dest[6];
+
+  buffer.push_n(values, 4);
+  buffer.shift_n(dest, 3);
+  TEST_ASSERT_TRUE(buffer.push_n(values + 4, 5));
+  assertContent(buffer, values + 3, 6);
+  TEST_ASSERT_EQUAL_UINT32(6, buffer.firstSpan().size + buffer.secondSpan().size);
+  TEST_ASSERT_EQUAL_INT(8, *std::upper_bound(buffer.begin(), buffer.end(), 7));
+}
+
+#define BENCH_REPEATS 5
+
+// nejkratsi z nekolika opakovani v ns na operaci - potlaci vliv ostatnich procesu
+template<typename F> static double bestOf(F run, uint32_t operations) {
+  double best = 0;
+
+  for (int repeat = 0; repeat < BENCH_REPEATS; ++repeat) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    run();
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / operations;
+    best = (repeat == 0 || ns < best) ? ns : best;
+  }
+  return best;
+}
+
+/**
+ * @brief srovnani s puvodni sablonou - pruchod indexy, odkazy a useky, upper_bound a
+ * hromadne vlozeni; vysledky se musi shodovat, casy se jen vypisi
+ *
+ */
+void test_benchmark_against_upstream() {
+  static UpstreamBuffer<CGMeasurement, BENCH_CAPACITY> upstream;
+  static CircularBuffer<CGMeasurement, BENCH_CAPACITY> fork;
+  static CGMeasurement batch[BENCH_CAPACITY / 4];
+  int64_t upstreamSum = 0;
+  int64_t indexedSum = 0;
+  int64_t spanSum = 0;
+  int64_t found = 0;
+
+  // obsah zalomeny pres konec uloziste
+  for (int32_t time = 0; time < BENCH_CAPACITY + BENCH_CAPACITY / 3; ++time) {
+    upstream.push(CGMeasurement{time, 500 + time % 250});
+    fork.push(CGMeasurement{time, 500 + time % 250});
+  }
+
+  double upstreamScan = bestOf([&]() {
+    for (int round = 0; round < BENCH_ROUNDS; ++round) {
+      for (uint16_t i = 0; i < BENCH_CAPACITY; ++i) {
+        upstreamSum += upstream[i].glucoseValue;
+      }
+    }
+  }, BENCH_ROUNDS * BENCH_CAPACITY);
+
+  double indexedScan = bestOf([&]() {
+    for (int round = 0; round < BENCH_ROUNDS; ++round) {
+      for (uint16_t i = 0; i < BENCH_CAPACITY; ++i) {
+        indexedSum += fork[i].glucoseValue;
+      }
+    }
+  }, BENCH_ROUNDS * BENCH_CAPACITY);
+
+  int64_t atSum = 0;
+  double atScan = bestOf([&]() {
+    for (int round = 0; round < BENCH_ROUNDS; ++round) {
+      for (uint16_t i = 0; i < BENCH_CAPACITY; ++i) {
+        atSum += fork.at(i).glucoseValue;
+      }
+    }
+  }, BENCH_ROUNDS * BENCH_CAPACITY);
+
+  double spanScan = bestOf([&]() {
+    for (int round = 0; round < BENCH_ROUNDS; ++round) {
+      CircularBuffer<CGMeasurement, BENCH_CAPACITY>::span spans[2] = {fork.firstSpan(), fork.secondSpan()};
+      for (int s = 0; s < 2; ++s) {
+        for (uint16_t i = 0; i < spans[s].size; ++i) {
+          spanSum += spans[s].data[i].glucoseValue;
+        }
+      }
+    }
+  }, BENCH_ROUNDS * BENCH_CAPACITY);
+
+  double lookup = bestOf([&]() {
+    for (int round = 0; round < BENCH_ROUNDS; ++round) {
+      CGMeasurement key = {(int32_t)(BENCH_CAPACITY / 3 + round % BENCH_CAPACITY), 0};
+      found += std::upper_bound(fork.begin(), fork.end(), key, [](const CGMeasurement &a, const CGMeasurement &b) {
+        return a.timeOffset < b.timeOffset;
+      })->timeOffset;
+    }
+  }, BENCH_ROUNDS);
+
+  TEST_ASSERT_EQUAL_INT64(upstreamSum, indexedSum);
+  TEST_ASSERT_EQUAL_INT64(upstreamSum, atSum);
+  TEST_ASSERT_EQUAL_INT64(upstreamSum, spanSum);
+  TEST_ASSERT_GREATER_THAN(0, found);
+
+  for (size_t i = 0; i < BENCH_CAPACITY / 4; ++i) {
+    batch[i] = CGMeasurement{(int32_t)i, (int32_t)i};
+  }
+  double upstreamPush = bestOf([&]() {
+    for (int round = 0; round < BENCH_ROUNDS; ++round) {
+      for (size_t i = 0; i < BENCH_CAPACITY / 4; ++i) {
+        upstream.push(batch[i]);
+      }
+    }
+  }, BENCH_ROUNDS * BENCH_CAPACITY / 4);
+
+  double bulkPush = bestOf([&]() {
+    for (int round = 0; round < BENCH_ROUNDS; ++round) {
+      fork.push_n(batch, BENCH_CAPACITY / 4);
+    }
+  }, BENCH_ROUNDS * BENCH_CAPACITY / 4);
+
+  printf("ns per element - scan: upstream %.2f, indexed %.2f, at %.2f, spans %.2f; push: upstream %.2f, push_n %.2f; upper_bound %.1f ns\n",
+    upstreamScan, indexedScan, atScan, spanScan, upstreamPush, bulkPush, lookup);
+  for (uint16_t i = 0; i < BENCH_CAPACITY; ++i) {
+    TEST_ASSERT_EQUAL_INT32(upstream[i].timeOffset, fork[i].timeOffset);
+    TEST_ASSERT_EQUAL_INT32(upstream[i].glucoseValue, fork[i].glucoseValue);
+  }
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_push_n_wraps_and_overwrites);
+  RUN_TEST(test_shift_n_and_pop_n);
+  RUN_TEST(test_spans_cover_content);
+  RUN_TEST(test_modulo_capacity);
+  RUN_TEST(test_benchmark_against_upstream);
+  return UNITY_END();
+}
@@ -0,0 +1,156 @@
+#include <unity.h>
+#include <math.h>
+
+#include "bytes.h"
+#include "format.h"
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+// exponent SFLOAT se znamenkem
+static int32_t sfloatExponent(uint16_t value) {
+  int32_t exponent = value >> 12;
+  return (exponent >= 0x8) ? exponent - 0x10 : exponent;
+}
+
+// dekodovani SFLOAT - mantisa a exponent se znamenkem
+static double decodeSfloat(uint16_t value) {
+  int32_t mantissa = value & 0x0FFF;
+
+  if (mantissa >= 0x0800) {
+    mantissa -= 0x1000;
+  }
+  return mantissa * pow(10.0, sfloatExponent(value));
+}
+
+// hodnota v rozsahu se zakoduje presne, zaporny exponent a mantisa ve dvojkovem doplnku
+void test_sfloat_exact() {
+  TEST_ASSERT_EQUAL_HEX16(0xF0B4, format_sfloat(180, -1));
+  TEST_ASSERT_EQUAL_HEX16(0xFFFF, format_sfloat(-1, -1));
+  TEST_ASSERT_EQUAL_HEX16(0x0000, format_sfloat(0, 0));
+  TEST_ASSERT_EQUAL_HEX16(0x07FD, format_sfloat(2045, 0));
+  TEST_ASSERT_EQUAL_HEX16(0xE803, format_sfloat(-2045, -2));
+  TEST_ASSERT_EQUAL_HEX16(0x8001, format_sfloat(1, -8));
+  TEST_ASSERT_EQUAL_HEX16(0x77FD, format_sfloat(2045, 7));
+}
+
+// pretekla mantisa se zaokrouhli od nuly, a to jen jednou z puvodni hodnoty
+void test_sfloat_rounding() {
+  TEST_ASSERT_EQUAL_HEX16(0x10CD, format_sfloat(2046, 0));
+  TEST_ASSERT_EQUAL_HEX16(0x07FD, format_sfloat(20454, -1));
+  TEST_ASSERT_EQUAL_HEX16(0x10CD, format_sfloat(20455, -1));
+  TEST_ASSERT_EQUAL_HEX16(0x1F33, format_sfloat(-20455, -1));
+  TEST_ASSERT_EQUAL_HEX16(0x1F33, format_sfloat(-2046, 0));
+
+  // 2045.49 - dvojim zaokrouhlenim by vyslo 2046 a o rad mene presnosti
+  TEST_ASSERT_EQUAL_HEX16(0x07FD, format_sfloat(204549, -2));
+  TEST_ASSERT_EQUAL_HEX16(0x0803, format_sfloat(-204549, -2));
+
+  TEST_ASSERT_EQUAL_HEX16(0xF0D7, format_sfloat(INT32_MAX, -8));
+}
+
+// hodnota mimo rozsah i s nejvyssim exponentem je +-INF, ne orezana mantisa
+void test_sfloat_saturation() {
+  TEST_ASSERT_EQUAL_HEX16(FORMAT_SFLOAT_POSITIVE_INFINITY, format_sfloat(2046, 7));
+  TEST_ASSERT_EQUAL_HEX16(FORMAT_SFLOAT_POSITIVE_INFINITY, format_sfloat(20460, 6));
+  TEST_ASSERT_EQUAL_HEX16(FORMAT_SFLOAT_POSITIVE_INFINITY, format_sfloat(INT32_MAX, 7));
+  TEST_ASSERT_EQUAL_HEX16(FORMAT_SFLOAT_NEGATIVE_INFINITY, format_sfloat(-2046, 7));
+  TEST_ASSERT_EQUAL_HEX16(FORMAT_SFLOAT_NEGATIVE_INFINITY, format_sfloat(INT32_MIN, 7));
+  // posledni rad se jeste vejde
+  TEST_ASSERT_EQUAL_HEX16(0x77FD, format_sfloat(20454, 6));
+}
+
+// vyhrazene hodnoty (NaN, NRes, +-INF) vzniknou jen pri saturaci, dekodovana hodnota
+// se od vstupu lisi nejvyse o polovinu posledniho radu
+void test_sfloat_sweep() {
+  for (int8_t exponent = -8; exponent <= 3; ++exponent) {
+    for (int32_t mantissa = -3000000; mantissa <= 3000000; mantissa += 997) {
+      uint16_t value = format_sfloat(mantissa, exponent);
+      uint16_t reserved = value & 0x0FFF;
+
+      TEST_ASSERT_NOT_EQUAL(FORMAT_SFLOAT_NAN, reserved);
+      TEST_ASSERT_NOT_EQUAL(FORMAT_SFLOAT_NRES, reserved);
+      TEST_ASSERT_NOT_EQUAL(FORMAT_SFLOAT_RESERVED, reserved);
+      TEST_ASSERT_NOT_EQUAL(FORMAT_SFLOAT_POSITIVE_INFINITY, reserved);
+      TEST_ASSERT_NOT_EQUAL(FORMAT_SFLOAT_NEGATIVE_INFINITY, reserved);
+
+      double input = mantissa * pow(10.0, exponent);
+      double step = pow(10.0, sfloatExponent(value));
+      TEST_ASSERT_TRUE(fabs(decodeSfloat(value) - input) <= step / 2 * (1 + 1e-9));
+    }
+  }
+}
+
+// zaznam bez trendu - velikost, priznaky, glukoza v desetinach mg/dl a cas little-endian
+void test_binary_record() {
+  uint8_t dest[FORMAT_BINARY_MAX_SIZE];
+  const uint8_t expected[FORMAT_BINARY_SIZE] = {8, 0, 0xB4, 0xF0, 0x78, 0x56, 0x34, 0x12};
+
+  TEST_ASSERT_EQUAL_size_t(FORMAT_BINARY_SIZE, format_binary(CGMeasurement{0x12345678, 100}, NULL, dest));
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, dest, FORMAT_BINARY_SIZE);
+
+  // 5.55 mmol/l = 99.99 mg/dl se zaokrouhli na desetiny
+  format_binary(CGMeasurement{1, 555}, NULL, dest);
+  TEST_ASSERT_EQUAL_HEX16(0xF3E8, getLE(dest + 2, 2));
+  // 12 mmol/l = 216.19 mg/dl se do desetin nevejde, prejde na cele mg/dl
+  format_binary(CGMeasurement{1, 1200}, NULL, dest);
+  TEST_ASSERT_EQUAL_HEX16(0x00D8, getLE(dest + 2, 2));
+  format_binary(CGMeasurement{1, 0}, NULL, dest);
+  TEST_ASSERT_EQUAL_HEX16(0xF000, getLE(dest + 2, 2));
+
+  // predchozi mereni ve stejnem nebo pozdejsim case trend nema
+  CGMeasurement same = {1, 500};
+  CGMeasurement later = {2, 500};
+  TEST_ASSERT_EQUAL_size_t(FORMAT_BINARY_SIZE, format_binary(CGMeasurement{1, 520}, &same, dest));
+  TEST_ASSERT_EQUAL_HEX8(0, dest[1]);
+  TEST_ASSERT_EQUAL_size_t(FORMAT_BINARY_SIZE, format_binary(CGMeasurement{1, 520}, &later, dest));
+  TEST_ASSERT_EQUAL_HEX8(0, dest[1]);
+}
+
+// trend v setinach mg/dl za minutu, znamenko podle smeru a zaokrouhleni od nuly
+void test_binary_trend() {
+  uint8_t dest[FORMAT_BINARY_MAX_SIZE];
+  CGMeasurement previous = {1000, 500};
+
+  // +0.2 mmol/l za 5 minut = 0.72 mg/dl/min
+  TEST_ASSERT_EQUAL_size_t(FORMAT_BINARY_MAX_SIZE, format_binary(CGMeasurement{1300, 520}, &previous, dest));
+  TEST_ASSERT_EQUAL_HEX8(FORMAT_BINARY_MAX_SIZE, dest[0]);
+  TEST_ASSERT_EQUAL_HEX8(FORMAT_FLAG_TREND, dest[1]);
+  TEST_ASSERT_EQUAL_HEX16(0xE048, getLE(dest + 8, 2));
+
+  // -0.2 mmol/l za minutu = -3.60 mg/dl/min
+  format_binary(CGMeasurement{1060, 480}, &previous, dest);
+  TEST_ASSERT_EQUAL_HEX16(0xEE98, getLE(dest + 8, 2));
+
+  // 0.2 mg/dl za 17 s = 0.7059 mg/dl/min, oseknutim by vyslo 0.70
+  format_binary(CGMeasurement{1017, 501}, &previous, dest);
+  TEST_ASSERT_EQUAL_HEX16(0xE047, getLE(dest + 8, 2));
+  format_binary(CGMeasurement{1017, 499}, &previous, dest);
+  TEST_ASSERT_EQUAL_HEX16(0xEFB9, getLE(dest + 8, 2));
+
+  // prudka zmena ztrati presnost, ale ne znamenko ani rad
+  format_binary(CGMeasurement{1001, 4500}, &previous, dest);
+  TEST_ASSERT_EQUAL_HEX16(0x21B0, getLE(dest + 8, 2));
+}
+
+void test_ascii_record() {
+  char dest[FORMAT_ASCII_SIZE + 1];
+
+  TEST_ASSERT_EQUAL_size_t(FORMAT_ASCII_SIZE, format_ascii(CGMeasurement{5, 500}, dest));
+  TEST_ASSERT_EQUAL_STRING("         5| 500", dest);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_sfloat_exact);
+  RUN_TEST(test_sfloat_rounding);
+  RUN_TEST(test_sfloat_saturation);
+  RUN_TEST(test_sfloat_sweep);
+  RUN_TEST(test_binary_record);
+  RUN_TEST(test_binary_trend);
+  RUN_TEST(test_ascii_record);
+  return UNITY_END();
+}
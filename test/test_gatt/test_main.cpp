@@ -0,0 +1,1001 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unity.h>
+
+// cela aplikace vcetne callbacku BLE - prelozena proti napodobeninam v test/fake
+#include "main.cpp"
+#include "bytes.h"
+
+#define FIRST_MEASUREMENT 1
+#define MEASUREMENTS 300
+
+// klient se skriptovanym chovanim - spojeni, adresa a prijate notifikace
+struct ScriptedClient {
+  uint16_t connId;
+  uint8_t address[6];
+};
+
+static const ScriptedClient alice = {0, {0xA1, 0x01, 0x02, 0x03, 0x04, 0x05}};
+static const ScriptedClient bob = {1, {0xB0, 0x01, 0x02, 0x03, 0x04, 0x05}};
+
+static const uint8_t subscribe[2] = {0x01, 0x00};
+static const uint8_t unsubscribe[2] = {0x00, 0x00};
+
+/**
+ * @brief spusti aplikaci nad prazdnym logem a relaci a nasnima mereni - jednou pro
+ * vsechny testy, uloha snimani se nespousti a jeji praci dela test
+ *
+ */
+static void boot() {
+  static bool booted = false;
+
+  if (booted) {
+    return;
+  }
+  booted = true;
+  remove(SESSION_EMULATOR_FILE);
+  flash_emulator_fail_after(-1);
+  TEST_ASSERT_TRUE(flash_init());
+  for (uint32_t i = 0; i < flash_size() / FLASH_SECTOR_SIZE; ++i) {
+    flash_erase_sector(i);
+  }
+
+  setup();
+  for (int32_t time = FIRST_MEASUREMENT; time <= MEASUREMENTS; ++time) {
+    acquired.push(CGMeasurement{time, 500 + time % 250});
+    postEvent(EVENT_MEASUREMENT, 0, time, 0);
+    loop();
+  }
+}
+
+void setUp() {
+  boot();
+  fake_stack().rejectSends = 0;
+}
+
+static void run(int passes) {
+  for (int i = 0; i < passes; ++i) {
+    loop();
+  }
+}
+
+// spojeni, ktera neuspesny test nechal otevrena, se odpoji
+void tearDown() {
+  for (uint8_t i = 0; i < CLIENT_MAX_CONNECTIONS; ++i) {
+    Client *client = client_at(i);
+    if (client != NULL) {
+      fake_disconnect(client->connId);
+    }
+  }
+  run(1);
+}
+
+// notifikace charakteristiky prijate spojenim od dane pozice zaznamu
+static std::vector<FakeNotification> received(const ScriptedClient &client, BLECharacteristic *characteristic, size_t from = 0) {
+  std::vector<FakeNotification> result;
+  std::vector<FakeNotification> &all = fake_stack().notifications;
+
+  for (size_t i = from; i < all.size(); ++i) {
+    if (all[i].connId == client.connId && all[i].handle == characteristic->getHandle()) {
+      result.push_back(all[i]);
+    }
+  }
+  return result;
+}
+
+// verejny klic klienta a odpoved na vystavenou zpravu - zprava plus sdileny klic,
+// jak si jej klient spocital; vrati akci, kterou server nastavil
+static std::string pair(const ScriptedClient &client, uint32_t key) {
+  char check[16];
+
+  fake_write(client.connId, securityValueCharacteristic->getHandle(), "1");
+  fake_write(client.connId, securityActionCharacteristic->getHandle(), "1");
+  run(1);
+  TEST_ASSERT_EQUAL_STRING("2", fake_read(client.connId, securityActionCharacteristic->getHandle()).c_str());
+
+  uint32_t challenge = strtoul(fake_read(client.connId, securityValueCharacteristic->getHandle()).c_str(), NULL, 10);
+  sprintf(check, "%u", challenge + key);
+  fake_write(client.connId, securityValueCharacteristic->getHandle(), check);
+  fake_write(client.connId, securityActionCharacteristic->getHandle(), "3");
+  run(1);
+  return fake_read(client.connId, securityActionCharacteristic->getHandle());
+}
+
+/**
+ * @brief pripojeni, parovani a autentizace - klient voli soukromy klic 18, jeho verejny
+ * klic 2^18 mod 19 je 1 a sdileny klic je tak 1 bez ohledu na klic serveru
+ *
+ */
+static void connectAndPair(const ScriptedClient &client) {
+  fake_connect(client.connId, client.address);
+  run(1);
+  TEST_ASSERT_NOT_NULL(client_find(client.connId));
+  TEST_ASSERT_EQUAL_STRING("4", pair(client, 1).c_str());
+}
+
+static void disconnect(const ScriptedClient &client) {
+  fake_disconnect(client.connId);
+  run(1);
+  TEST_ASSERT_NULL(client_find(client.connId));
+  TEST_ASSERT_TRUE(fake_stack().advertising);
+}
+
+/**
+ * @brief hromadny prenos cele historie - zahlceni spojeni a odmitnuta notifikace
+ * prenos jen pozdrzi, potvrzeni prezije odpojeni v ulozene relaci
+ *
+ */
+void test_backfill_ack_disconnect() {
+  CGMeasurement decoded[MEASUREMENTS + BACKFILL_COMPRESSED_MAX_RECORDS];
+  PersistedSession session;
+  size_t total = 0;
+
+  connectAndPair(alice);
+  fake_exchange_mtu(alice.connId, 185);
+  fake_write(alice.connId, cgmBackfillNotifications->getHandle(), subscribe, sizeof(subscribe));
+  fake_write(alice.connId, cgmBackfillCharacteristic->getHandle(), "-1");
+  size_t start = fake_stack().notifications.size();
+  run(1);
+  TEST_ASSERT_EQUAL_size_t(BACKFILL_BURST, received(alice, cgmBackfillCharacteristic, start).size());
+
+  // behem zahlceni server nic neposila
+  fake_congest(alice.connId, true);
+  size_t paused = fake_stack().notifications.size();
+  run(3);
+  TEST_ASSERT_EQUAL_size_t(paused, fake_stack().notifications.size());
+  fake_congest(alice.connId, false);
+
+  // odmitnutou notifikaci server zopakuje, kurzor prenosu se neposune
+  fake_stack().rejectSends = 1;
+  for (int i = 0; i < 50 && client_find(alice.connId)->backfillActive; ++i) {
+    run(1);
+  }
+  TEST_ASSERT_FALSE(client_find(alice.connId)->backfillActive);
+
+  std::vector<FakeNotification> packets = received(alice, cgmBackfillCharacteristic, start);
+  for (size_t i = 0; i < packets.size(); ++i) {
+    TEST_ASSERT_LESS_OR_EQUAL(185 - ATT_HEADER_SIZE, packets[i].value.size());
+    total += backfill_unpack(packets[i].value.data(), packets[i].value.size(), decoded + total, BACKFILL_COMPRESSED_MAX_RECORDS);
+  }
+  TEST_ASSERT_EQUAL_UINT8(0, packets.back().value[0]);
+  TEST_ASSERT_EQUAL_size_t(MEASUREMENTS, total);
+  for (size_t i = 0; i < total; ++i) {
+    TEST_ASSERT_EQUAL_INT32(FIRST_MEASUREMENT + (int32_t)i, decoded[i].timeOffset);
+    TEST_ASSERT_EQUAL_INT32(500 + decoded[i].timeOffset % 250, decoded[i].glucoseValue);
+  }
+
+  fake_write(alice.connId, cgmAckCharacteristic->getHandle(), "300");
+  run(1);
+  TEST_ASSERT_EQUAL_STRING("300|0", fake_read(alice.connId, cgmAckCharacteristic->getHandle()).c_str());
+
+  disconnect(alice);
+  TEST_ASSERT_TRUE(session_load(&session));
+  TEST_ASSERT_EQUAL_INT32(300, session.acknowledged);
+}
+
+/**
+ * @brief bez odberu notifikaci se hromadny prenos nespusti a odhlaseni jej ukonci
+ *
+ */
+void test_backfill_requires_subscription() {
+  connectAndPair(alice);
+  size_t start = fake_stack().notifications.size();
+
+  fake_write(alice.connId, cgmBackfillCharacteristic->getHandle(), "-1");
+  run(2);
+  TEST_ASSERT_EQUAL_size_t(0, received(alice, cgmBackfillCharacteristic, start).size());
+
+  fake_write(alice.connId, cgmBackfillNotifications->getHandle(), subscribe, sizeof(subscribe));
+  fake_write(alice.connId, cgmBackfillCharacteristic->getHandle(), "-1");
+  run(1);
+  size_t sent = received(alice, cgmBackfillCharacteristic, start).size();
+  TEST_ASSERT_EQUAL_size_t(BACKFILL_BURST, sent);
+
+  fake_write(alice.connId, cgmBackfillNotifications->getHandle(), unsubscribe, sizeof(unsubscribe));
+  run(2);
+  TEST_ASSERT_FALSE(client_find(alice.connId)->backfillActive);
+  TEST_ASSERT_EQUAL_size_t(sent, received(alice, cgmBackfillCharacteristic, start).size());
+
+  disconnect(alice);
+}
+
+/**
+ * @brief parametry spojeni prijate centralnim zarizenim patri jen spojeni se stejnou adresou
+ *
+ */
+void test_link_params_follow_peer() {
+  char expected[64];
+
+  connectAndPair(alice);
+  connectAndPair(bob);
+  fake_update_conn_params(bob.address, 24, 0, 400);
+  run(1);
+
+  // "faze;faze;faze;zahozene udalosti;doby startu" a parametry spojeni v poradi tabulky relaci
+  std::string metrics = fake_read(alice.connId, cgmMetricsCharacteristic->getHandle());
+  sprintf(expected, ";%u;%lu|%lu|%lu;0|0|0;24|0|400", (unsigned)droppedEvents.load(), bootToAdvertising, bootToNotification, bootRebuild);
+  TEST_ASSERT_TRUE(metrics.size() > strlen(expected));
+  TEST_ASSERT_EQUAL_STRING(expected, metrics.c_str() + metrics.size() - strlen(expected));
+
+  disconnect(bob);
+  metrics = fake_read(alice.connId, cgmMetricsCharacteristic->getHandle());
+  sprintf(expected, ";%u;%lu|%lu|%lu;0|0|0", (unsigned)droppedEvents.load(), bootToAdvertising, bootToNotification, bootRebuild);
+  TEST_ASSERT_EQUAL_STRING(expected, metrics.c_str() + metrics.size() - strlen(expected));
+  disconnect(alice);
+}
+
+/**
+ * @brief klient nastavi jen PAIR_1 a AUTH_1 - zapsany stav READY ani neznama akce relaci
+ * neautentizuje a spatna odpoved na zpravu autentizaci neukonci
+ *
+ */
+void test_security_rejects_forged_actions() {
+  char check[16];
+
+  // sdileny klic z predchozich parovani - relace rovnou dostane zpravu (AUTH_0)
+  fake_connect(alice.connId, alice.address);
+  run(1);
+  uint16_t value = securityValueCharacteristic->getHandle();
+  uint16_t action = securityActionCharacteristic->getHandle();
+
+  fake_write(alice.connId, action, "4");
+  fake_write(alice.connId, action, "9");
+  run(1);
+  TEST_ASSERT_EQUAL_STRING("2", fake_read(alice.connId, action).c_str());
+  TEST_ASSERT_EQUAL(SECURITY, client_find(alice.connId)->state);
+
+  uint32_t challenge = strtoul(fake_read(alice.connId, value).c_str(), NULL, 10);
+  sprintf(check, "%u", challenge + 2);
+  fake_write(alice.connId, value, check);
+  fake_write(alice.connId, action, "3");
+  run(1);
+  TEST_ASSERT_EQUAL_STRING("3", fake_read(alice.connId, action).c_str());
+  TEST_ASSERT_EQUAL(SECURITY, client_find(alice.connId)->state);
+
+  sprintf(check, "%u", challenge + 1);
+  fake_write(alice.connId, value, check);
+  fake_write(alice.connId, action, "3");
+  run(1);
+  TEST_ASSERT_EQUAL_STRING("4", fake_read(alice.connId, action).c_str());
+  TEST_ASSERT_EQUAL(READ, client_find(alice.connId)->state);
+  disconnect(alice);
+}
+
+// soucet dob fazi (ms) z prehledu metrik "doba|propustnost|strida;..."
+static uint32_t phaseDuration(const std::string &metrics) {
+  uint32_t total = 0;
+  const char *field = metrics.c_str();
+
+  for (int i = 0; i < LINK_PHASES; ++i) {
+    total += strtoul(field, NULL, 10);
+    field = strchr(field, ';') + 1;
+  }
+  return total;
+}
+
+/**
+ * @brief prehled metrik zahrnuje i fazi, ktera dosud neskoncila
+ *
+ */
+void test_metrics_include_open_phase() {
+  connectAndPair(alice);
+  connectAndPair(bob);
+  uint32_t before = phaseDuration(fake_read(alice.connId, cgmMetricsCharacteristic->getHandle()));
+
+  // obe spojeni jsou necinna a faze se nemeni, smycka ceka vzdy cely LOOP_PERIOD
+  run(3);
+  uint32_t after = phaseDuration(fake_read(alice.connId, cgmMetricsCharacteristic->getHandle()));
+  TEST_ASSERT_EQUAL_UINT32(2 * 3 * LOOP_PERIOD, after - before);
+
+  disconnect(bob);
+  disconnect(alice);
+}
+
+/**
+ * @brief stav se pri vychozim MTU precte jednim pozadavkem, souhrn 24 hodin ma
+ * vlastni charakteristiku dostupnou az po autentizaci
+ *
+ */
+void test_status_fits_default_mtu() {
+  fake_connect(alice.connId, alice.address);
+  run(1);
+  std::string status = fake_read(alice.connId, cgmStatusCharacteristic->getHandle());
+  TEST_ASSERT_LESS_OR_EQUAL(BLE_DEFAULT_MTU - ATT_HEADER_SIZE, status.size());
+  TEST_ASSERT_EQUAL_size_t(0, fake_read(alice.connId, cgmStatsCharacteristic->getHandle()).size());
+  disconnect(alice);
+
+  connectAndPair(alice);
+  status = fake_read(alice.connId, cgmStatusCharacteristic->getHandle());
+  TEST_ASSERT_EQUAL_size_t(STATUS_SIZE, status.size());
+  TEST_ASSERT_EQUAL_HEX8(READ | (READY << 4), (uint8_t)status[0]);
+  TEST_ASSERT_EQUAL_UINT16(500 + MEASUREMENTS % 250, (uint8_t)status[10] | ((uint8_t)status[11] << 8));
+
+  std::string day = fake_read(alice.connId, cgmStatsCharacteristic->getHandle());
+  TEST_ASSERT_EQUAL_size_t(STATUS_STATS_SIZE, day.size());
+  TEST_ASSERT_EQUAL_UINT16(500, (uint8_t)day[2] | ((uint8_t)day[3] << 8));
+  TEST_ASSERT_EQUAL_UINT16(749, (uint8_t)day[4] | ((uint8_t)day[5] << 8));
+  disconnect(alice);
+}
+
+/**
+ * @brief zmena relace se do NVS neulozi hned - az po periode ukladani nebo pri odpojeni
+ *
+ */
+void test_session_persist_deferred() {
+  PersistedSession session;
+
+  connectAndPair(alice);
+  fake_write(alice.connId, cgmAgpCharacteristic->getHandle(), "3600");
+  disconnect(alice);
+  TEST_ASSERT_TRUE(session_load(&session));
+  TEST_ASSERT_EQUAL_INT32(3600, session.agpOrigin);
+
+  connectAndPair(alice);
+  fake_write(alice.connId, cgmAgpCharacteristic->getHandle(), "7200");
+  run(2);
+  TEST_ASSERT_EQUAL_INT32(7200, agpOrigin);
+  TEST_ASSERT_TRUE(session_load(&session));
+  TEST_ASSERT_EQUAL_INT32(3600, session.agpOrigin);
+
+  delay(SESSION_PERSIST_PERIOD);
+  run(1);
+  TEST_ASSERT_TRUE(session_load(&session));
+  TEST_ASSERT_EQUAL_INT32(7200, session.agpOrigin);
+
+  fake_write(alice.connId, cgmAgpCharacteristic->getHandle(), "0");
+  disconnect(alice);
+  TEST_ASSERT_TRUE(session_load(&session));
+  TEST_ASSERT_EQUAL_INT32(0, session.agpOrigin);
+}
+
+/**
+ * @brief restart zarizeni - mereni v RAM se ztrati, log ve flash zustane a aplikace
+ * z nej obnovi odvozene urovne jako pri startu
+ *
+ */
+static void restart() {
+  TEST_ASSERT_TRUE(mlog_flush());
+  buffer.clear();
+  history_clear();
+  rollup_clear();
+  stats_init(findMeasurementAfter);
+  restoreMeasurements();
+  run(1);
+}
+
+// vsechny stranky agregovanych intervalu urovne od zacatku relace
+static std::vector<uint8_t> queryRollup(const ScriptedClient &client, uint8_t level) {
+  std::vector<uint8_t> intervals;
+  char request[16];
+
+  sprintf(request, "%u|0", level);
+  size_t start = fake_stack().notifications.size();
+  fake_write(client.connId, cgmRollupCharacteristic->getHandle(), request);
+  for (int i = 0; i < 50 && (i == 0 || client_find(client.connId)->rollupActive); ++i) {
+    run(1);
+  }
+  std::vector<FakeNotification> pages = received(client, cgmRollupCharacteristic, start);
+  for (size_t i = 0; i < pages.size(); ++i) {
+    TEST_ASSERT_EQUAL_UINT8(level, pages[i].value[0]);
+    intervals.insert(intervals.end(), pages[i].value.begin() + ROLLUP_HEADER_SIZE, pages[i].value.end());
+  }
+  return intervals;
+}
+
+/**
+ * @brief restart - RAM urovne se ztrati, statistiky a urovne agregace se obnovi z logu
+ *
+ */
+void test_restart_restores_aggregates() {
+  RollupBucket before[ROLLUP_CAPACITY_15_MIN];
+  RollupBucket after[ROLLUP_CAPACITY_15_MIN];
+
+  connectAndPair(alice);
+  std::string day = fake_read(alice.connId, cgmStatsCharacteristic->getHandle());
+  uint32_t buckets = rollup_query(ROLLUP_15_MIN, INT32_MIN, before, ROLLUP_CAPACITY_15_MIN);
+  TEST_ASSERT_EQUAL_size_t(STATUS_STATS_SIZE, day.size());
+  TEST_ASSERT_GREATER_THAN(0, buckets);
+  disconnect(alice);
+
+  restart();
+
+  connectAndPair(alice);
+  TEST_ASSERT_TRUE(day == fake_read(alice.connId, cgmStatsCharacteristic->getHandle()));
+  TEST_ASSERT_EQUAL_UINT32(buckets, rollup_query(ROLLUP_15_MIN, INT32_MIN, after, ROLLUP_CAPACITY_15_MIN));
+  TEST_ASSERT_EQUAL_MEMORY(before, after, buckets * sizeof(RollupBucket));
+  disconnect(alice);
+}
+
+/**
+ * @brief dotaz na agregovane intervaly vrati po restartu totez co pred nim
+ *
+ */
+void test_rollup_survives_restart() {
+  connectAndPair(alice);
+  fake_write(alice.connId, cgmRollupNotifications->getHandle(), subscribe, sizeof(subscribe));
+  std::vector<uint8_t> before = queryRollup(alice, ROLLUP_15_MIN);
+  TEST_ASSERT_EQUAL_size_t(((MEASUREMENTS + 899) / 900) * ROLLUP_PACKED_SIZE, before.size());
+  disconnect(alice);
+
+  restart();
+
+  connectAndPair(alice);
+  fake_write(alice.connId, cgmRollupNotifications->getHandle(), subscribe, sizeof(subscribe));
+  TEST_ASSERT_TRUE(before == queryRollup(alice, ROLLUP_15_MIN));
+  disconnect(alice);
+}
+
+/**
+ * @brief graf nad obdobim, ktere log uz nedrzi - body starsi nez nejstarsi presne
+ * mereni prijdou z ztratove historie, novejsi z logu
+ *
+ */
+void test_chart_falls_back_to_lossy_history() {
+  const int32_t exactFrom = 100;
+  LttbQuery query;
+  CGMeasurement point;
+  CGMeasurement exact;
+  uint32_t older = 0;
+
+  // ztratova historie s jinym prubehem nez log, log jako by drzel az od exactFrom
+  sdt_clear();
+  for (int32_t time = 0; time < exactFrom; ++time) {
+    sdt_push(CGMeasurement{time, 900});
+  }
+  chartExactFrom = exactFrom;
+
+  TEST_ASSERT_TRUE(findChartPointAfter(INT32_MIN, &point));
+  TEST_ASSERT_EQUAL_INT32(0, point.timeOffset);
+  TEST_ASSERT_EQUAL_INT32(900, point.glucoseValue);
+  TEST_ASSERT_TRUE(findChartPointAfter(exactFrom - 1, &point));
+  TEST_ASSERT_TRUE(findMeasurementAfter(exactFrom - 1, &exact));
+  TEST_ASSERT_EQUAL_INT32(exact.timeOffset, point.timeOffset);
+  TEST_ASSERT_EQUAL_INT32(exact.glucoseValue, point.glucoseValue);
+
+  TEST_ASSERT_TRUE(lttb_start(&query, 0, MEASUREMENTS, 20));
+  while (lttb_next(&query, &point)) {
+    if (point.timeOffset < exactFrom) {
+      TEST_ASSERT_EQUAL_INT32(900, point.glucoseValue);
+      older++;
+    }
+    else {
+      TEST_ASSERT_EQUAL_INT32(500 + point.timeOffset % 250, point.glucoseValue);
+    }
+  }
+  TEST_ASSERT_GREATER_THAN(0, older);
+
+  // restart obnovi ztratovou historii z logu
+  restart();
+  connectAndPair(alice);
+  fake_write(alice.connId, cgmChartNotifications->getHandle(), subscribe, sizeof(subscribe));
+  size_t start = fake_stack().notifications.size();
+  fake_write(alice.connId, cgmChartCharacteristic->getHandle(), "0|300|20");
+  run(10);
+  std::vector<FakeNotification> pages = received(alice, cgmChartCharacteristic, start);
+  TEST_ASSERT_GREATER_THAN(1, pages.size());
+  TEST_ASSERT_EQUAL_UINT8(0, pages.back().value[0]);
+  for (size_t i = 0; i < pages.size(); ++i) {
+    for (size_t j = BACKFILL_HEADER_SIZE; j < pages[i].value.size(); j += BACKFILL_RECORD_SIZE) {
+      int32_t time = (int32_t)(pages[i].value[j] | (pages[i].value[j + 1] << 8) | (pages[i].value[j + 2] << 16) | ((uint32_t)pages[i].value[j + 3] << 24));
+      uint16_t value = pages[i].value[j + 4] | (pages[i].value[j + 5] << 8);
+      TEST_ASSERT_GREATER_OR_EQUAL(FIRST_MEASUREMENT, time);
+      TEST_ASSERT_EQUAL_UINT16(500 + time % 250, value);
+    }
+  }
+  disconnect(alice);
+}
+
+// pocet ztracenych mereni z hodnoty "potvrzeny cas|pocet ztracenych mereni"
+static uint32_t lostMeasurements(const ScriptedClient &client) {
+  std::string ack = fake_read(client.connId, cgmAckCharacteristic->getHandle());
+  return strtoul(ack.substr(ack.find('|') + 1).c_str(), NULL, 10);
+}
+
+/**
+ * @brief zaseknuta hlavni smycka - mereni, ktere se nevejde do fronty, se zahodi
+ * a zapocita mezi ztracena, udalost pro nej neprijde
+ *
+ */
+void test_acquisition_overflow_counted() {
+  CGMeasurement last;
+
+  connectAndPair(alice);
+  uint32_t lost = lostMeasurements(alice);
+  TEST_ASSERT_TRUE(lastRecord(&last));
+  int32_t time = last.timeOffset;
+  UBaseType_t spaces = uxQueueSpacesAvailable(events);
+
+  for (int i = 0; i < 17; ++i) {
+    time++;
+    acquireMeasurement(CGMeasurement{time, 500 + time % 250});
+  }
+  TEST_ASSERT_EQUAL_UINT32(1, droppedMeasurements.load());
+  TEST_ASSERT_EQUAL_UINT32(spaces - 16, uxQueueSpacesAvailable(events));
+
+  run(1);
+  TEST_ASSERT_TRUE(lastRecord(&last));
+  TEST_ASSERT_EQUAL_INT32(time - 1, last.timeOffset);
+  TEST_ASSERT_EQUAL_UINT32(lost + 1, lostMeasurements(alice));
+  disconnect(alice);
+}
+
+/**
+ * @brief mereni s hodnotou mimo rozsah bufferu se nezaradi do zadne urovne a zapocita
+ * se mezi ztracena, nasledujici mereni se zpracuji normalne
+ *
+ */
+void test_out_of_range_measurement_dropped() {
+  CGMeasurement last;
+  CGMeasurement found;
+
+  connectAndPair(alice);
+  uint32_t lost = lostMeasurements(alice);
+  uint32_t dropped = droppedMeasurements.load();
+  TEST_ASSERT_TRUE(lastRecord(&last));
+  int32_t time = last.timeOffset;
+
+  acquireMeasurement(CGMeasurement{time + 1, 5000});
+  acquireMeasurement(CGMeasurement{time + 2, 500 + (time + 2) % 250});
+  run(1);
+  TEST_ASSERT_EQUAL_UINT32(dropped + 1, droppedMeasurements.load());
+  TEST_ASSERT_EQUAL_UINT32(lost + 1, lostMeasurements(alice));
+  TEST_ASSERT_TRUE(findMeasurementAfter(time, &found));
+  TEST_ASSERT_EQUAL_INT32(time + 2, found.timeOffset);
+  TEST_ASSERT_TRUE(mlog_find_after(time, &found));
+  TEST_ASSERT_EQUAL_INT32(time + 2, found.timeOffset);
+  disconnect(alice);
+}
+
+// citac vysilani z dat vyrobce v scan response, data musi byt autenticka a nova
+static uint32_t openBeacon(const BeaconKeys *keys, uint32_t lastCounter) {
+  std::string data = cgmServer->getAdvertising()->scanResponse.manufacturerData;
+  CGMeasurement measurement;
+  int8_t trend;
+
+  TEST_ASSERT_TRUE(beacon_open(keys, (const uint8_t *)data.data(), data.size(), lastCounter, &measurement, &trend));
+  TEST_ASSERT_EQUAL_INT32(lastMeasurement.timeOffset, measurement.timeOffset);
+  return getLE((const uint8_t *)data.data() + BEACON_COUNTER_OFFSET, 4);
+}
+
+/**
+ * @brief vysilani mereni po restartu pokracuje za ulozenym blokem citace - prijemce,
+ * ktery videl posledni hodnotu pred restartem, data dal prijima
+ *
+ */
+void test_beacon_counter_survives_restart() {
+  BeaconKeys keys;
+  uint32_t counter = UINT32_MAX;
+
+  connectAndPair(alice);
+  disconnect(alice);
+  beacon_derive(1, &keys);
+  for (int i = 0; i < 3; ++i) {
+    updateBeacon();
+    counter = openBeacon(&keys, counter);
+  }
+
+  restart();
+  restoreBeaconCounter();
+  updateBeacon();
+  uint32_t resumed = openBeacon(&keys, counter);
+  // pokracuje se za celym rezervovanym blokem
+  TEST_ASSERT_EQUAL_UINT32((counter / BEACON_COUNTER_BLOCK + 1) * BEACON_COUNTER_BLOCK, resumed);
+}
+
+// pozadavek kontrolniho bodu s casovym operandem (jeden cas, nebo dva u RACP_WITHIN)
+static void writeRacp(const ScriptedClient &client, uint8_t opcode, uint8_t op, int32_t from = 0, int32_t to = 0) {
+  uint8_t request[RACP_MAX_SIZE] = {opcode, op, RACP_FILTER_TIME_OFFSET};
+  size_t len = 2;
+
+  if (op == RACP_LESS_OR_EQUAL || op == RACP_GREATER_OR_EQUAL || op == RACP_WITHIN) {
+    putLE(request + 3, (uint32_t)from, 4);
+    len = 7;
+  }
+  if (op == RACP_WITHIN) {
+    putLE(request + 7, (uint32_t)to, 4);
+    len = 11;
+  }
+  fake_write(client.connId, cgmRacpCharacteristic->getHandle(), request, len);
+}
+
+// odpoved kontrolniho bodu na posledni pozadavek, smycka bezi nejvyse passes pruchodu
+static std::vector<uint8_t> racpResponse(const ScriptedClient &client, size_t from, int passes = 1) {
+  for (int i = 0; i < passes && received(client, cgmRacpCharacteristic, from).empty(); ++i) {
+    run(1);
+  }
+  std::vector<FakeNotification> responses = received(client, cgmRacpCharacteristic, from);
+  TEST_ASSERT_EQUAL_size_t(1, responses.size());
+  return responses[0].value;
+}
+
+static void assertRacpResponse(const std::vector<uint8_t> &response, uint8_t opcode, uint8_t code) {
+  TEST_ASSERT_EQUAL_size_t(RACP_RESPONSE_SIZE, response.size());
+  TEST_ASSERT_EQUAL_UINT8(RACP_RESPONSE, response[0]);
+  TEST_ASSERT_EQUAL_UINT8(opcode, response[2]);
+  TEST_ASSERT_EQUAL_UINT8(code, response[3]);
+}
+
+static uint16_t racpCount(const ScriptedClient &client, uint8_t op, int32_t time = 0) {
+  size_t start = fake_stack().notifications.size();
+
+  writeRacp(client, RACP_REPORT_COUNT, op, time);
+  std::vector<uint8_t> response = racpResponse(client, start);
+  TEST_ASSERT_EQUAL_size_t(RACP_COUNT_RESPONSE_SIZE, response.size());
+  TEST_ASSERT_EQUAL_UINT8(RACP_COUNT_RESPONSE, response[0]);
+  return (uint16_t)getLE(response.data() + 2, 2);
+}
+
+// cas zaznamu mereni v kodovani ASCII
+static int32_t recordTime(const FakeNotification &notification) {
+  return atoi(std::string(notification.value.begin(), notification.value.end()).c_str());
+}
+
+/**
+ * @brief report, pocet a mazani zaznamu kontrolnim bodem; streamovani, ktere klient
+ * zahaji spolu s reportem, se zaznamy reportu neproklada a pokracuje po nem
+ *
+ */
+void test_racp_report_count_delete() {
+  const uint8_t unsupported[1] = {0x7F};
+
+  connectAndPair(alice);
+  fake_write(alice.connId, cgmMeasurementNotifications->getHandle(), subscribe, sizeof(subscribe));
+  fake_write(alice.connId, cgmRacpNotifications->getHandle(), subscribe, sizeof(subscribe));
+
+  TEST_ASSERT_EQUAL_UINT16(50, racpCount(alice, RACP_LESS_OR_EQUAL, 50));
+  TEST_ASSERT_EQUAL_UINT16(1, racpCount(alice, RACP_FIRST));
+  TEST_ASSERT_EQUAL_UINT16(0, racpCount(alice, RACP_GREATER_OR_EQUAL, 100000));
+
+  // streamovani od zacatku a report jedenacti zaznamu ve stejnem pruchodu smycky
+  size_t start = fake_stack().notifications.size();
+  fake_write(alice.connId, cgmTimeCharacteristic->getHandle(), "0");
+  writeRacp(alice, RACP_REPORT, RACP_WITHIN, 100, 110);
+  assertRacpResponse(racpResponse(alice, start, 10), RACP_REPORT, RACP_SUCCESS);
+  std::vector<FakeNotification> records = received(alice, cgmMeasurementCharacteristic, start);
+  TEST_ASSERT_EQUAL_size_t(11, records.size());
+  for (size_t i = 0; i < records.size(); ++i) {
+    TEST_ASSERT_EQUAL_INT32(100 + (int32_t)i, recordTime(records[i]));
+  }
+  size_t reported = fake_stack().notifications.size();
+  run(1);
+  records = received(alice, cgmMeasurementCharacteristic, reported);
+  TEST_ASSERT_GREATER_THAN(0, records.size());
+  TEST_ASSERT_EQUAL_INT32(FIRST_MEASUREMENT, recordTime(records[0]));
+
+  // report bez zaznamu a nepodporovany operacni kod bez operatoru
+  start = fake_stack().notifications.size();
+  writeRacp(alice, RACP_REPORT, RACP_GREATER_OR_EQUAL, 100000);
+  assertRacpResponse(racpResponse(alice, start), RACP_REPORT, RACP_NO_RECORDS);
+  start = fake_stack().notifications.size();
+  fake_write(alice.connId, cgmRacpCharacteristic->getHandle(), unsupported, sizeof(unsupported));
+  assertRacpResponse(racpResponse(alice, start), 0x7F, RACP_OPCODE_NOT_SUPPORTED);
+
+  // mazat lze jen od nejstarsiho zaznamu
+  start = fake_stack().notifications.size();
+  writeRacp(alice, RACP_DELETE, RACP_GREATER_OR_EQUAL, 100);
+  assertRacpResponse(racpResponse(alice, start), RACP_DELETE, RACP_OPERATOR_NOT_SUPPORTED);
+  start = fake_stack().notifications.size();
+  writeRacp(alice, RACP_DELETE, RACP_LESS_OR_EQUAL, 20);
+  assertRacpResponse(racpResponse(alice, start), RACP_DELETE, RACP_SUCCESS);
+  TEST_ASSERT_EQUAL_UINT16(30, racpCount(alice, RACP_LESS_OR_EQUAL, 50));
+  TEST_ASSERT_EQUAL_UINT16(1, racpCount(alice, RACP_FIRST));
+  start = fake_stack().notifications.size();
+  writeRacp(alice, RACP_REPORT, RACP_FIRST);
+  assertRacpResponse(racpResponse(alice, start, 10), RACP_REPORT, RACP_SUCCESS);
+  records = received(alice, cgmMeasurementCharacteristic, start);
+  TEST_ASSERT_EQUAL_INT32(21, recordTime(records[0]));
+  disconnect(alice);
+}
+
+// zaznamy, ktere by server poslal od daneho casu
+static std::vector<CGMeasurement> recordsAfter(int32_t time) {
+  std::vector<CGMeasurement> records;
+  CGMeasurement measurement;
+
+  while (findRecordAfter(time, &measurement)) {
+    records.push_back(measurement);
+    time = measurement.timeOffset;
+  }
+  return records;
+}
+
+static void assertRecords(const std::vector<CGMeasurement> &expected, const std::vector<CGMeasurement> &actual) {
+  TEST_ASSERT_EQUAL_size_t(expected.size(), actual.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    TEST_ASSERT_EQUAL_INT32(expected[i].timeOffset, actual[i].timeOffset);
+    TEST_ASSERT_EQUAL_INT32(expected[i].glucoseValue, actual[i].glucoseValue);
+  }
+}
+
+/**
+ * @brief hromadny prenos cele historie pres model spojeni
+ *
+ * @param records dekodovane zaznamy
+ * @return doba od pozadavku do doruceni posledni notifikace (ms)
+ */
+static uint32_t backfillOverLink(const ScriptedClient &client, std::vector<CGMeasurement> &records) {
+  CGMeasurement decoded[BACKFILL_COMPRESSED_MAX_RECORDS];
+  std::vector<FakeNotification> packets;
+  uint32_t started = millis();
+  size_t start = fake_stack().notifications.size();
+
+  fake_write(client.connId, cgmBackfillCharacteristic->getHandle(), INVALID_TIME_STR);
+  for (int i = 0; i < 1000 && (packets.empty() || packets.back().value[0] > 0); ++i) {
+    run(1);
+    packets = received(client, cgmBackfillCharacteristic, start);
+  }
+  TEST_ASSERT_FALSE(packets.empty());
+  TEST_ASSERT_EQUAL_UINT8(0, packets.back().value[0]);
+  for (size_t i = 0; i < packets.size(); ++i) {
+    size_t count = backfill_unpack(packets[i].value.data(), packets[i].value.size(), decoded, BACKFILL_COMPRESSED_MAX_RECORDS);
+    records.insert(records.end(), decoded, decoded + count);
+  }
+  return packets.back().time - started;
+}
+
+/**
+ * @brief propustnost hromadneho prenosu - spojeni 30 ms se ctyrmi pakety za udalost
+ * a MTU 185; ztracene pakety prenos zpomali, ale zadny zaznam nechybi
+ *
+ */
+void test_backfill_throughput() {
+  std::vector<CGMeasurement> expected = recordsAfter(INVALID_TIME);
+  std::vector<CGMeasurement> ideal;
+  std::vector<CGMeasurement> lossy;
+
+  connectAndPair(alice);
+  fake_exchange_mtu(alice.connId, 185);
+  fake_write(alice.connId, cgmBackfillNotifications->getHandle(), subscribe, sizeof(subscribe));
+
+  fake_link(alice.connId, 24, 4);
+  uint32_t idealTime = backfillOverLink(alice, ideal);
+  assertRecords(expected, ideal);
+
+  fake_link(alice.connId, 24, 4, 200);
+  uint32_t lossyTime = backfillOverLink(alice, lossy);
+  uint32_t retransmitted = fake_stack().links[alice.connId].retransmitted;
+  assertRecords(expected, lossy);
+  TEST_ASSERT_GREATER_THAN(0, retransmitted);
+  TEST_ASSERT_GREATER_THAN(idealTime, lossyTime);
+
+  // linka unese 4 pakety po 30 zaznamech za 30 ms, smycka ji musi vytizit alespon z poloviny
+  uint32_t packets = (expected.size() + 29) / 30 + 1;
+  uint32_t linkTime = (packets + 3) / 4 * 30;
+  TEST_ASSERT_LESS_OR_EQUAL(2 * linkTime, idealTime);
+  printf("backfill of %u records: %u ms (%u records/s), with 20 %% loss %u ms (%u records/s, %u retransmitted)\n",
+         (unsigned)expected.size(), idealTime, (unsigned)(expected.size() * 1000 / idealTime),
+         lossyTime, (unsigned)(expected.size() * 1000 / lossyTime), retransmitted);
+  disconnect(alice);
+}
+
+// zaznamy mereni v kodovani ASCII prijate spojenim od dane pozice
+static std::vector<int32_t> streamedTimes(const ScriptedClient &client, size_t from) {
+  std::vector<FakeNotification> records = received(client, cgmMeasurementCharacteristic, from);
+  std::vector<int32_t> times;
+
+  for (size_t i = 0; i < records.size(); ++i) {
+    times.push_back(recordTime(records[i]));
+  }
+  return times;
+}
+
+// smycka bezi, dokud klient nedostane zaznam s danym casem; vrati cas jeho doruceni
+static uint32_t streamUntil(const ScriptedClient &client, size_t from, int32_t time) {
+  for (int i = 0; i < 1000; ++i) {
+    std::vector<FakeNotification> records = received(client, cgmMeasurementCharacteristic, from);
+    if (!records.empty() && recordTime(records.back()) >= time) {
+      return records.back().time;
+    }
+    run(1);
+  }
+  TEST_FAIL_MESSAGE("stream did not catch up");
+  return 0;
+}
+
+/**
+ * @brief streamovani - klient zada kurzor jednou, server dozene zaznamy po davkach
+ * pres zahlcene spojeni a dalsi mereni posila sam; odhlaseni streamovani ukonci
+ *
+ */
+void test_stream_follows_new_measurements() {
+  CGMeasurement last;
+  char cursor[16];
+
+  connectAndPair(alice);
+  fake_write(alice.connId, cgmMeasurementNotifications->getHandle(), subscribe, sizeof(subscribe));
+  fake_link(alice.connId, 24, 4);
+  TEST_ASSERT_TRUE(lastRecord(&last));
+  int32_t from = last.timeOffset - 60;
+  std::vector<CGMeasurement> expected = recordsAfter(from);
+
+  size_t start = fake_stack().notifications.size();
+  sprintf(cursor, "%d", from);
+  fake_write(alice.connId, cgmTimeCharacteristic->getHandle(), cursor);
+  streamUntil(alice, start, last.timeOffset);
+  TEST_ASSERT_EQUAL(STREAM, client_find(alice.connId)->state);
+
+  // mereni po dohnani prijdou bez dalsiho zapisu kurzoru
+  for (int32_t time = last.timeOffset + 1; time <= last.timeOffset + 3; ++time) {
+    acquireMeasurement(CGMeasurement{time, 500 + time % 250});
+    expected.push_back(CGMeasurement{time, 500 + time % 250});
+    run(1);
+  }
+  streamUntil(alice, start, last.timeOffset + 3);
+  std::vector<int32_t> times = streamedTimes(alice, start);
+  TEST_ASSERT_EQUAL_size_t(expected.size(), times.size());
+  for (size_t i = 0; i < times.size(); ++i) {
+    TEST_ASSERT_EQUAL_INT32(expected[i].timeOffset, times[i]);
+  }
+
+  fake_write(alice.connId, cgmMeasurementNotifications->getHandle(), unsubscribe, sizeof(unsubscribe));
+  run(1);
+  TEST_ASSERT_EQUAL(READ, client_find(alice.connId)->state);
+  size_t stopped = fake_stack().notifications.size();
+  acquireMeasurement(CGMeasurement{last.timeOffset + 4, 500});
+  run(2);
+  TEST_ASSERT_EQUAL_size_t(0, received(alice, cgmMeasurementCharacteristic, stopped).size());
+  disconnect(alice);
+}
+
+/**
+ * @brief vypadek spojeni behem streamovani - spojeni vyprsi, notifikace ve fronte
+ * stacku se ztrati; klient po opetovnem pripojeni navaze od posledniho prijateho
+ * zaznamu a dozene i mereni z doby odpojeni
+ *
+ */
+void test_reconnect_catch_up() {
+  CGMeasurement last;
+  char cursor[16];
+
+  connectAndPair(alice);
+  fake_write(alice.connId, cgmMeasurementNotifications->getHandle(), subscribe, sizeof(subscribe));
+  fake_link(alice.connId, 24, 4);
+  TEST_ASSERT_TRUE(lastRecord(&last));
+  int32_t from = last.timeOffset - 100;
+  std::vector<CGMeasurement> expected = recordsAfter(from);
+
+  size_t start = fake_stack().notifications.size();
+  sprintf(cursor, "%d", from);
+  fake_write(alice.connId, cgmTimeCharacteristic->getHandle(), cursor);
+  streamUntil(alice, start, from + 20);
+
+  // protistrana prestane odpovidat, spojeni vyprsi po supervision timeoutu
+  fake_stack().links[alice.connId].lossPermille = 1000;
+  fake_stack().links[alice.connId].supervisionTimeout = 4000;
+  for (int i = 0; i < 1000 && client_find(alice.connId) != NULL; ++i) {
+    run(1);
+  }
+  TEST_ASSERT_NULL(client_find(alice.connId));
+  TEST_ASSERT_TRUE(fake_stack().advertising);
+  std::vector<int32_t> before = streamedTimes(alice, start);
+  TEST_ASSERT_TRUE(before.size() < expected.size());
+
+  // mereni behem odpojeni
+  for (int32_t time = last.timeOffset + 1; time <= last.timeOffset + 30; ++time) {
+    acquireMeasurement(CGMeasurement{time, 500 + time % 250});
+    expected.push_back(CGMeasurement{time, 500 + time % 250});
+    run(1);
+  }
+
+  uint32_t reconnected = millis();
+  size_t resumed = fake_stack().notifications.size();
+  connectAndPair(alice);
+  fake_link(alice.connId, 24, 4);
+  fake_write(alice.connId, cgmMeasurementNotifications->getHandle(), subscribe, sizeof(subscribe));
+  sprintf(cursor, "%d", before.back());
+  fake_write(alice.connId, cgmTimeCharacteristic->getHandle(), cursor);
+  uint32_t caughtUp = streamUntil(alice, resumed, last.timeOffset + 30);
+
+  std::vector<int32_t> after = streamedTimes(alice, resumed);
+  before.insert(before.end(), after.begin(), after.end());
+  TEST_ASSERT_EQUAL_size_t(expected.size(), before.size());
+  for (size_t i = 0; i < before.size(); ++i) {
+    TEST_ASSERT_EQUAL_INT32(expected[i].timeOffset, before[i]);
+  }
+  printf("reconnect to caught up: %u ms for %u records\n", caughtUp - reconnected, (unsigned)after.size());
+  TEST_ASSERT_LESS_OR_EQUAL(2000, caughtUp - reconnected);
+  disconnect(alice);
+}
+
+/**
+ * @brief neuspesne parovani - klient odpovi na zpravu spatnym klicem, relace zustane
+ * v zabezpeceni a nedostane zadna data; dalsi pokus se spravnym klicem uspeje
+ *
+ */
+void test_pairing_check_fails() {
+  fake_connect(alice.connId, alice.address);
+  run(1);
+  TEST_ASSERT_EQUAL_STRING("3", pair(alice, 2).c_str());
+  TEST_ASSERT_EQUAL(SECURITY, client_find(alice.connId)->state);
+
+  size_t start = fake_stack().notifications.size();
+  fake_write(alice.connId, cgmMeasurementNotifications->getHandle(), subscribe, sizeof(subscribe));
+  fake_write(alice.connId, cgmBackfillNotifications->getHandle(), subscribe, sizeof(subscribe));
+  fake_write(alice.connId, cgmTimeCharacteristic->getHandle(), "0");
+  fake_write(alice.connId, cgmBackfillCharacteristic->getHandle(), INVALID_TIME_STR);
+  writeRacp(alice, RACP_REPORT, RACP_ALL);
+  run(3);
+  TEST_ASSERT_EQUAL_size_t(start, fake_stack().notifications.size());
+  TEST_ASSERT_EQUAL(SECURITY, client_find(alice.connId)->state);
+
+  TEST_ASSERT_EQUAL_STRING("4", pair(alice, 1).c_str());
+  TEST_ASSERT_EQUAL(READ, client_find(alice.connId)->state);
+  disconnect(alice);
+}
+
+/**
+ * @brief dva klienti zaroven - hromadny prenos pres ztratove spojeni neblokuje
+ * streamovani druheho klienta a notifikace se mezi spojeni nepomichaji
+ *
+ */
+void test_concurrent_clients() {
+  std::vector<CGMeasurement> expected = recordsAfter(INVALID_TIME);
+  CGMeasurement decoded[BACKFILL_COMPRESSED_MAX_RECORDS];
+  std::vector<CGMeasurement> backfilled;
+  char cursor[16];
+
+  connectAndPair(alice);
+  connectAndPair(bob);
+  fake_exchange_mtu(alice.connId, 185);
+  fake_write(alice.connId, cgmBackfillNotifications->getHandle(), subscribe, sizeof(subscribe));
+  fake_write(bob.connId, cgmMeasurementNotifications->getHandle(), subscribe, sizeof(subscribe));
+  fake_link(alice.connId, 24, 2, 300);
+  fake_link(bob.connId, 6, 2);
+
+  size_t start = fake_stack().notifications.size();
+  int32_t from = expected[expected.size() - 80].timeOffset;
+  sprintf(cursor, "%d", from);
+  fake_write(alice.connId, cgmBackfillCharacteristic->getHandle(), INVALID_TIME_STR);
+  fake_write(bob.connId, cgmTimeCharacteristic->getHandle(), cursor);
+  streamUntil(bob, start, expected.back().timeOffset);
+  for (int i = 0; i < 1000 && client_find(alice.connId)->backfillActive; ++i) {
+    run(1);
+  }
+  run(5);
+
+  std::vector<FakeNotification> packets = received(alice, cgmBackfillCharacteristic, start);
+  TEST_ASSERT_EQUAL_UINT8(0, packets.back().value[0]);
+  for (size_t i = 0; i < packets.size(); ++i) {
+    size_t count = backfill_unpack(packets[i].value.data(), packets[i].value.size(), decoded, BACKFILL_COMPRESSED_MAX_RECORDS);
+    backfilled.insert(backfilled.end(), decoded, decoded + count);
+  }
+  assertRecords(expected, backfilled);
+  // obe spojeni se obsluhuji soubezne, bob nececka na konec prenosu alice
+  std::vector<FakeNotification> streamed = received(bob, cgmMeasurementCharacteristic, start);
+  TEST_ASSERT_LESS_THAN(packets.back().time, streamed.front().time);
+
+  std::vector<int32_t> times = streamedTimes(bob, start);
+  TEST_ASSERT_EQUAL_size_t(79, times.size());
+  for (size_t i = 0; i < times.size(); ++i) {
+    TEST_ASSERT_EQUAL_INT32(expected[expected.size() - 79 + i].timeOffset, times[i]);
+  }
+  TEST_ASSERT_EQUAL_size_t(0, received(bob, cgmBackfillCharacteristic, start).size());
+  TEST_ASSERT_EQUAL_size_t(0, received(alice, cgmMeasurementCharacteristic, start).size());
+  disconnect(bob);
+  disconnect(alice);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_backfill_ack_disconnect);
+  RUN_TEST(test_backfill_requires_subscription);
+  RUN_TEST(test_link_params_follow_peer);
+  RUN_TEST(test_metrics_include_open_phase);
+  RUN_TEST(test_security_rejects_forged_actions);
+  RUN_TEST(test_status_fits_default_mtu);
+  RUN_TEST(test_session_persist_deferred);
+  RUN_TEST(test_restart_restores_aggregates);
+  RUN_TEST(test_rollup_survives_restart);
+  RUN_TEST(test_chart_falls_back_to_lossy_history);
+  RUN_TEST(test_acquisition_overflow_counted);
+  RUN_TEST(test_out_of_range_measurement_dropped);
+  RUN_TEST(test_beacon_counter_survives_restart);
+  RUN_TEST(test_backfill_throughput);
+  RUN_TEST(test_stream_follows_new_measurements);
+  RUN_TEST(test_reconnect_catch_up);
+  RUN_TEST(test_pairing_check_fails);
+  RUN_TEST(test_concurrent_clients);
+  RUN_TEST(test_racp_report_count_delete);
+  return UNITY_END();
+}
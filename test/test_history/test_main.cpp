@@ -0,0 +1,133 @@
+#include <stdlib.h>
+#include <unity.h>
+#include <vector>
+
+#include "history.h"
+
+// mereni v jednom bloku pri stalem kroku a malych zmenach - prvni v hlavicce, dalsi po bajtu;
+// v prvnim bloku historie nese druhe mereni i zmenu kroku z nuly a zabere dva bajty
+#define BLOCK_MEASUREMENTS (1 + HISTORY_DATA_SIZE)
+#define FIRST_BLOCK_MEASUREMENTS (BLOCK_MEASUREMENTS - 1)
+
+static std::vector<CGMeasurement> pushed;
+
+static void push(int32_t time, int32_t value) {
+  history_push(CGMeasurement{time, value});
+  pushed.push_back(CGMeasurement{time, value});
+}
+
+// cela historie sekvencnim ctenim odpovida vlozenym merenim od from
+static void assertReadsBack(size_t from) {
+  HistoryReader reader;
+  CGMeasurement measurement;
+
+  history_reader_seek(&reader, INT32_MIN);
+  for (size_t i = from; i < pushed.size(); ++i) {
+    TEST_ASSERT_TRUE(history_reader_next(&reader, &measurement));
+    TEST_ASSERT_EQUAL_INT32(pushed[i].timeOffset, measurement.timeOffset);
+    TEST_ASSERT_EQUAL_INT32(pushed[i].glucoseValue, measurement.glucoseValue);
+  }
+  TEST_ASSERT_FALSE(history_reader_next(&reader, &measurement));
+  TEST_ASSERT_EQUAL_UINT32(pushed.size() - from, history_size());
+}
+
+void setUp() {
+  history_clear();
+  pushed.clear();
+  srand(3);
+}
+
+void tearDown() {
+}
+
+// zmeny hodnoty a kroku na hranicich jednobajtoveho varintu i pres cely rozsah int32
+void test_delta_zigzag_varint_round_trip() {
+  static const int32_t valueSteps[] = {0, 1, -1, 31, -32, 32, -33, 8191, -8192, 8192, 100000, -100000, INT32_MAX / 2, -(INT32_MAX / 2)};
+  static const int32_t timeSteps[] = {1, 1, 2, 60, 60, 63, 64, 65, 1000, 40000, 1, 1};
+  int32_t time = -1000;
+  int32_t value = 0;
+
+  push(time, value);
+  for (size_t i = 0; i < 400; ++i) {
+    time += timeSteps[i % (sizeof(timeSteps) / sizeof(timeSteps[0]))];
+    value += valueSteps[(i * 7) % (sizeof(valueSteps) / sizeof(valueSteps[0]))];
+    push(time, value);
+  }
+  assertReadsBack(0);
+}
+
+// krok delsi nez rozsah int16 v hlavicce noveho bloku
+void test_long_gap_at_block_start() {
+  int32_t time = 0;
+
+  for (int i = 0; i < FIRST_BLOCK_MEASUREMENTS; ++i) {
+    push(time++, 500);
+  }
+  time += 100000;
+  push(time, 520);
+  push(time + 1, 521);
+  push(time + 100001, 400);
+  push(time + 100002, 401);
+  assertReadsBack(0);
+}
+
+// hledani prvniho novejsiho mereni pro kazdy cas, vcetne prvnich mereni bloku
+void test_upper_bound_lookup() {
+  CGMeasurement measurement;
+  HistoryReader reader;
+
+  for (int32_t time = 10; time < 10 + 5 * BLOCK_MEASUREMENTS; time += 2) {
+    push(time, 500 + rand() % 20);
+  }
+  TEST_ASSERT_EQUAL_INT32(10, history_first_time());
+
+  for (int32_t time = 0; time < pushed.back().timeOffset; ++time) {
+    TEST_ASSERT_TRUE(history_find_after(time, &measurement));
+    int32_t expected = (time < 10) ? 10 : time + 2 - (time % 2);
+    TEST_ASSERT_EQUAL_INT32(expected, measurement.timeOffset);
+    TEST_ASSERT_EQUAL_INT32(pushed[(expected - 10) / 2].glucoseValue, measurement.glucoseValue);
+  }
+  TEST_ASSERT_FALSE(history_find_after(pushed.back().timeOffset, &measurement));
+  TEST_ASSERT_FALSE(history_find_after(INT32_MAX, &measurement));
+
+  // ctenar nastaveny na hranici bloku pokracuje do dalsiho bloku
+  int32_t boundary = pushed[FIRST_BLOCK_MEASUREMENTS].timeOffset;
+  history_reader_seek(&reader, boundary - 1);
+  for (size_t i = FIRST_BLOCK_MEASUREMENTS; i < pushed.size(); ++i) {
+    TEST_ASSERT_TRUE(history_reader_next(&reader, &measurement));
+    TEST_ASSERT_EQUAL_INT32(pushed[i].timeOffset, measurement.timeOffset);
+  }
+  TEST_ASSERT_FALSE(history_reader_next(&reader, &measurement));
+}
+
+// zaplnena historie prepisuje nejstarsi bloky po celych blocich
+void test_oldest_blocks_overwritten() {
+  CGMeasurement measurement;
+  int32_t time = 0;
+
+  // o tri bloky vic, nez se vejde
+  for (int i = 0; i < FIRST_BLOCK_MEASUREMENTS + (HISTORY_BLOCKS + 2) * BLOCK_MEASUREMENTS; ++i) {
+    push(time++, 500);
+  }
+  int32_t first = FIRST_BLOCK_MEASUREMENTS + 2 * BLOCK_MEASUREMENTS;
+  TEST_ASSERT_EQUAL_INT32(first, history_first_time());
+  assertReadsBack(first);
+
+  // cas pred zacatkem historie vrati nejstarsi mereni
+  TEST_ASSERT_TRUE(history_find_after(0, &measurement));
+  TEST_ASSERT_EQUAL_INT32(first, measurement.timeOffset);
+
+  history_clear();
+  TEST_ASSERT_EQUAL_UINT32(0, history_size());
+  TEST_ASSERT_EQUAL_INT32(INT32_MAX, history_first_time());
+  TEST_ASSERT_FALSE(history_find_after(INT32_MIN, &measurement));
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_delta_zigzag_varint_round_trip);
+  RUN_TEST(test_long_gap_at_block_start);
+  RUN_TEST(test_upper_bound_lookup);
+  RUN_TEST(test_oldest_blocks_overwritten);
+  return UNITY_END();
+}
@@ -0,0 +1,195 @@
+#include <algorithm>
+#include <stdlib.h>
+#include <unity.h>
+#include <vector>
+
+#include "lttb.h"
+
+#define RECORDS 5000
+
+static CGMeasurement records[RECORDS];
+static uint32_t reads;
+
+static bool earlier(int32_t time, const CGMeasurement &measurement) {
+  return time < measurement.timeOffset;
+}
+
+// zdroj mereni pro dotaz - prvni mereni novejsi nez time
+static bool recordAfter(int32_t time, CGMeasurement *measurement) {
+  const CGMeasurement *found = std::upper_bound(records, records + RECORDS, time, earlier);
+
+  reads++;
+  if (found == records + RECORDS) {
+    return false;
+  }
+  *measurement = *found;
+  return true;
+}
+
+/**
+ * @brief referencni LTTB nad polem - prvni a posledni mereni zustanou, vnitrni mereni
+ * se rozdeli do intervalu stejne jako v dotazu (casove od prvniho mereni) a z kazdeho
+ * se hrubou silou vybere mereni s nejvetsi plochou trojuhelniku; stejna celociselna
+ * aritmetika, pri shode vyhrava starsi mereni
+ *
+ * @param middle pocet vybranych vnitrnich bodu, ktere nejsou prvnim, poslednim,
+ * nejnizsim ani nejvyssim mereni intervalu (predvyber M4 by je minul)
+ */
+static std::vector<CGMeasurement> referenceLttb(int32_t from, int32_t to, uint16_t points, uint32_t *middle) {
+  std::vector<CGMeasurement> window;
+  std::vector<CGMeasurement> result;
+
+  for (size_t i = 0; i < RECORDS; ++i) {
+    if (records[i].timeOffset >= from && records[i].timeOffset <= to) {
+      window.push_back(records[i]);
+    }
+  }
+  *middle = 0;
+  if (window.size() <= 2) {
+    return window;
+  }
+
+  // hranice intervalu vnitrnich mereni
+  int64_t span = (int64_t)to - window[0].timeOffset + 1;
+  std::vector<size_t> starts;
+  int64_t index = -1;
+  for (size_t i = 1; i + 1 < window.size(); ++i) {
+    int64_t bucket = ((int64_t)window[i].timeOffset - window[0].timeOffset) * (points - 2) / span;
+    if (bucket != index) {
+      starts.push_back(i);
+      index = bucket;
+    }
+  }
+  starts.push_back(window.size() - 1);
+
+  CGMeasurement a = window[0];
+  result.push_back(a);
+  for (size_t j = 0; j + 1 < starts.size(); ++j) {
+    int64_t cTime = window.back().timeOffset;
+    int64_t cValue = window.back().glucoseValue;
+    if (j + 2 < starts.size()) {
+      int64_t sumTime = 0;
+      int64_t sumValue = 0;
+      for (size_t i = starts[j + 1]; i < starts[j + 2]; ++i) {
+        sumTime += window[i].timeOffset;
+        sumValue += window[i].glucoseValue;
+      }
+      cTime = sumTime / (int64_t)(starts[j + 2] - starts[j + 1]);
+      cValue = sumValue / (int64_t)(starts[j + 2] - starts[j + 1]);
+    }
+
+    size_t best = starts[j];
+    int64_t bestArea = -1;
+    int32_t low = window[starts[j]].glucoseValue;
+    int32_t high = low;
+    for (size_t i = starts[j]; i < starts[j + 1]; ++i) {
+      const CGMeasurement &b = window[i];
+      int64_t area = llabs((int64_t)(b.timeOffset - a.timeOffset) * (cValue - a.glucoseValue) - (int64_t)(b.glucoseValue - a.glucoseValue) * (cTime - a.timeOffset));
+      if (area > bestArea) {
+        bestArea = area;
+        best = i;
+      }
+      low = std::min(low, b.glucoseValue);
+      high = std::max(high, b.glucoseValue);
+    }
+    if (best != starts[j] && best != starts[j + 1] - 1 && window[best].glucoseValue != low && window[best].glucoseValue != high) {
+      (*middle)++;
+    }
+    a = window[best];
+    result.push_back(a);
+  }
+  result.push_back(window.back());
+  return result;
+}
+
+static std::vector<CGMeasurement> query(int32_t from, int32_t to, uint16_t points) {
+  std::vector<CGMeasurement> result;
+  LttbQuery query;
+  CGMeasurement point;
+
+  TEST_ASSERT_TRUE(lttb_start(&query, from, to, points));
+  while (lttb_next(&query, &point)) {
+    result.push_back(point);
+  }
+  return result;
+}
+
+static void assertSame(const std::vector<CGMeasurement> &expected, const std::vector<CGMeasurement> &actual) {
+  TEST_ASSERT_EQUAL_size_t(expected.size(), actual.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    TEST_ASSERT_EQUAL_INT32(expected[i].timeOffset, actual[i].timeOffset);
+    TEST_ASSERT_EQUAL_INT32(expected[i].glucoseValue, actual[i].glucoseValue);
+  }
+}
+
+// sumny prubeh s jidly a nepravidelnymi mezerami mezi merenimi
+void setUp() {
+  int32_t time = 0;
+
+  srand(7);
+  for (size_t i = 0; i < RECORDS; ++i) {
+    time += (rand() % 20 == 0) ? 30 + rand() % 300 : 1 + rand() % 10;
+    int32_t meal = (int32_t)(time % 7200);
+    int32_t value = 550 + ((meal < 2400) ? meal / 8 : 300 - (meal - 2400) / 16);
+    records[i] = CGMeasurement{time, std::max(value, 400) + rand() % 41 - 20};
+  }
+  lttb_init(recordAfter);
+  reads = 0;
+}
+
+void tearDown() {
+}
+
+// vybrane body jsou presne ty z referencni implementace, vcetne bodu mimo predvyber M4
+void test_matches_reference() {
+  static const uint16_t pointCounts[] = {3, 4, 10, 57, 200, 1000};
+  int32_t last = records[RECORDS - 1].timeOffset;
+  uint32_t middle;
+  uint32_t totalMiddle = 0;
+
+  for (size_t i = 0; i < sizeof(pointCounts) / sizeof(pointCounts[0]); ++i) {
+    std::vector<CGMeasurement> expected = referenceLttb(INT32_MIN / 2, last, pointCounts[i], &middle);
+    assertSame(expected, query(INT32_MIN / 2, last, pointCounts[i]));
+    TEST_ASSERT_LESS_OR_EQUAL(pointCounts[i], expected.size());
+    totalMiddle += middle;
+
+    // podinterval zacinajici a koncici mezi merenimi a konec dotazu za poslednim merenim
+    expected = referenceLttb(records[100].timeOffset + 1, records[4000].timeOffset - 1, pointCounts[i], &middle);
+    assertSame(expected, query(records[100].timeOffset + 1, records[4000].timeOffset - 1, pointCounts[i]));
+    totalMiddle += middle;
+    expected = referenceLttb(records[2500].timeOffset, last + 10000, pointCounts[i], &middle);
+    assertSame(expected, query(records[2500].timeOffset, last + 10000, pointCounts[i]));
+    totalMiddle += middle;
+  }
+  TEST_ASSERT_GREATER_THAN(0, totalMiddle);
+}
+
+// kazde mereni se cte jednou pri zarazeni a jednou pri vyberu bodu intervalu
+void test_reads_bounded() {
+  int32_t last = records[RECORDS - 1].timeOffset;
+
+  query(0, last, 200);
+  TEST_ASSERT_LESS_OR_EQUAL(2 * RECORDS + 200 + 2, reads);
+}
+
+void test_short_ranges() {
+  uint32_t middle;
+
+  TEST_ASSERT_EQUAL_size_t(0, query(-100, 0, 10).size());
+  assertSame(referenceLttb(records[0].timeOffset, records[0].timeOffset, 10, &middle), query(records[0].timeOffset, records[0].timeOffset, 10));
+  assertSame(referenceLttb(records[0].timeOffset, records[1].timeOffset, 10, &middle), query(records[0].timeOffset, records[1].timeOffset, 10));
+  assertSame(referenceLttb(records[0].timeOffset, records[2].timeOffset, 10, &middle), query(records[0].timeOffset, records[2].timeOffset, 10));
+
+  LttbQuery invalid;
+  TEST_ASSERT_FALSE(lttb_start(&invalid, 10, 0, 10));
+  TEST_ASSERT_FALSE(lttb_start(&invalid, 0, 10, 2));
+  TEST_ASSERT_FALSE(lttb_start(&invalid, 0, 10, LTTB_MAX_POINTS + 1));
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_matches_reference);
+  RUN_TEST(test_reads_bounded);
+  RUN_TEST(test_short_ranges);
+  return UNITY_END();
+}
@@ -0,0 +1,361 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unity.h>
+
+#include "flash.h"
+#include "mlog.h"
+
+// mereni n ma cas 3 * n a hodnotu n - z kazdeho zaznamu lze overit jeho poradi
+static CGMeasurement sample(int32_t n) {
+  return CGMeasurement{3 * n, n};
+}
+
+static void eraseFlash() {
+  flash_emulator_fail_after(-1);
+  TEST_ASSERT_TRUE(flash_init());
+  for (uint32_t i = 0; i < flash_size() / FLASH_SECTOR_SIZE; ++i) {
+    flash_erase_sector(i);
+  }
+}
+
+static uint32_t checkpointSectors() {
+  return flash_size() / FLASH_SECTOR_SIZE - MLOG_CHECKPOINT_SECTORS;
+}
+
+static void appendRange(int32_t from, int32_t to) {
+  for (int32_t n = from; n <= to; ++n) {
+    TEST_ASSERT_TRUE(mlog_append(sample(n)));
+  }
+  TEST_ASSERT_TRUE(mlog_flush());
+}
+
+// adresa zaznamu mereni n ve flash
+static uint32_t recordOffset(int32_t n) {
+  LogRecord record;
+  for (uint32_t offset = 0; offset < checkpointSectors() * FLASH_SECTOR_SIZE; offset += sizeof(LogRecord)) {
+    if (flash_read(offset, &record, sizeof(record)) && record.timeOffset == 3 * n && record.glucoseValue == n) {
+      return offset;
+    }
+  }
+  TEST_FAIL_MESSAGE("zaznam neni ve flash");
+  return 0;
+}
+
+// vynuluje bajty na adrese - NOR flash muze bity pouze nulovat
+static void clearBytes(uint32_t offset, size_t len) {
+  uint8_t zeros[FLASH_PAGE_SIZE];
+  memset(zeros, 0, len);
+  TEST_ASSERT_TRUE(flash_write(offset, zeros, len));
+}
+
+/**
+ * @brief projde log od nejstarsiho zaznamu a overi, ze zaznamy navazuji
+ * 
+ * @param first prvni zaznam logu, 0 pro prazdny log
+ * @param count pocet zaznamu
+ * @return posledni zaznam logu, 0 pro prazdny log
+ */
+static int32_t walkLog(int32_t *first, uint32_t *count) {
+  CGMeasurement measurement;
+  int32_t time = INT32_MIN;
+  int32_t previous = 0;
+
+  *first = 0;
+  *count = 0;
+  while (mlog_find_after(time, &measurement)) {
+    TEST_ASSERT_EQUAL_INT32(3 * measurement.glucoseValue, measurement.timeOffset);
+    if (previous != 0) {
+      TEST_ASSERT_EQUAL_INT32(previous + 1, measurement.glucoseValue);
+    }
+    else {
+      *first = measurement.glucoseValue;
+    }
+    previous = measurement.glucoseValue;
+    time = measurement.timeOffset;
+    (*count)++;
+  }
+  return previous;
+}
+
+void setUp() {
+  eraseFlash();
+}
+
+void tearDown() {
+  flash_emulator_fail_after(-1);
+}
+
+void test_append_survives_remount() {
+  int32_t first;
+  uint32_t count;
+  CGMeasurement last;
+
+  TEST_ASSERT_TRUE(mlog_init());
+  mlog_new_session();
+  for (int32_t n = 1; n <= 1000; ++n) {
+    TEST_ASSERT_TRUE(mlog_append(sample(n)));
+  }
+  TEST_ASSERT_TRUE(mlog_flush());
+
+  TEST_ASSERT_TRUE(mlog_init());
+  TEST_ASSERT_EQUAL_INT32(1000, walkLog(&first, &count));
+  TEST_ASSERT_EQUAL_INT32(1, first);
+  TEST_ASSERT_EQUAL_UINT32(1000, count);
+  TEST_ASSERT_TRUE(mlog_last(&last));
+  TEST_ASSERT_EQUAL_INT32(3000, last.timeOffset);
+}
+
+// zapis stranky selze - buffer v RAM se nepreplni a dalsi mereni se odmitnou
+void test_failed_page_write_refuses_append() {
+  int32_t first;
+  uint32_t count;
+  uint32_t accepted = 0;
+
+  TEST_ASSERT_TRUE(mlog_init());
+  mlog_new_session();
+  uint32_t lost = mlog_lost();
+
+  flash_emulator_fail_after(0);
+  for (int32_t n = 1; n <= 4 * (int32_t)MLOG_PAGE_RECORDS; ++n) {
+    if (mlog_append(sample(accepted + 1))) {
+      accepted++;
+    }
+  }
+  TEST_ASSERT_LESS_OR_EQUAL(MLOG_PAGE_RECORDS, accepted);
+  TEST_ASSERT_EQUAL_UINT32(4 * MLOG_PAGE_RECORDS - accepted, mlog_lost() - lost);
+
+  // po obnoveni zapisu se nejdrive zapise cekajici stranka a log pokracuje
+  flash_emulator_fail_after(-1);
+  for (int32_t n = accepted + 1; n <= (int32_t)accepted + 100; ++n) {
+    TEST_ASSERT_TRUE(mlog_append(sample(n)));
+  }
+  TEST_ASSERT_TRUE(mlog_flush());
+  TEST_ASSERT_EQUAL_INT32(accepted + 100, walkLog(&first, &count));
+  TEST_ASSERT_EQUAL_INT32(1, first);
+  TEST_ASSERT_EQUAL_UINT32(accepted + 100, count);
+}
+
+// cas, ktery se vratil, log do relace neprijme ani po restartu, nova relace ano
+void test_append_rejects_time_going_back() {
+  CGMeasurement last;
+
+  TEST_ASSERT_TRUE(mlog_init());
+  mlog_new_session();
+  uint32_t lost = mlog_lost();
+  appendRange(1, 10);
+  TEST_ASSERT_FALSE(mlog_append(sample(5)));
+  TEST_ASSERT_FALSE(mlog_append(sample(10)));
+
+  TEST_ASSERT_TRUE(mlog_init());
+  TEST_ASSERT_FALSE(mlog_append(sample(10)));
+  TEST_ASSERT_TRUE(mlog_append(sample(11)));
+  TEST_ASSERT_EQUAL_UINT32(lost, mlog_lost());
+
+  mlog_new_session();
+  TEST_ASSERT_TRUE(mlog_append(sample(1)));
+  TEST_ASSERT_TRUE(mlog_last(&last));
+  TEST_ASSERT_EQUAL_INT32(3, last.timeOffset);
+  TEST_ASSERT_EQUAL_UINT32(1, mlog_size());
+}
+
+// zaznam s chybnym CRC ukonci platnou cast logu, zapis pokracuje v dalsim sektoru
+// a zaznamy za poskozenym se uz nenajdou
+void test_corrupted_record_ends_log() {
+  int32_t first;
+  uint32_t count;
+  CGMeasurement measurement;
+
+  TEST_ASSERT_TRUE(mlog_init());
+  mlog_new_session();
+  appendRange(1, 100);
+  clearBytes(recordOffset(50) + offsetof(LogRecord, crc), sizeof(uint32_t));
+
+  TEST_ASSERT_TRUE(mlog_init());
+  TEST_ASSERT_EQUAL_INT32(49, walkLog(&first, &count));
+  TEST_ASSERT_TRUE(mlog_last(&measurement));
+  TEST_ASSERT_EQUAL_INT32(49, measurement.glucoseValue);
+  appendRange(101, 400);
+  TEST_ASSERT_TRUE(mlog_init());
+  TEST_ASSERT_TRUE(mlog_find_after(3 * 49, &measurement));
+  TEST_ASSERT_EQUAL_INT32(101, measurement.glucoseValue);
+  TEST_ASSERT_TRUE(mlog_last(&measurement));
+  TEST_ASSERT_EQUAL_INT32(400, measurement.glucoseValue);
+  TEST_ASSERT_EQUAL_UINT32(349, mlog_size());
+}
+
+// pocty zaznamu nezahrnuji opustene sloty sektoru s prerusenym zapisem
+void test_counts_skip_torn_sector() {
+  uint32_t count;
+
+  TEST_ASSERT_TRUE(mlog_init());
+  mlog_new_session();
+  appendRange(1, 100);
+  clearBytes(recordOffset(50) + offsetof(LogRecord, crc), sizeof(uint32_t));
+  TEST_ASSERT_TRUE(mlog_init());
+  appendRange(101, 400);
+  // posledni mereni zustavaji v RAM bufferu
+  for (int32_t n = 401; n <= 406; ++n) {
+    TEST_ASSERT_TRUE(mlog_append(sample(n)));
+  }
+
+  // platne jsou 1 - 49 a 101 - 406
+  TEST_ASSERT_EQUAL_UINT32(355, mlog_size());
+  TEST_ASSERT_TRUE(mlog_count_after(INT32_MIN, &count));
+  TEST_ASSERT_EQUAL_UINT32(355, count);
+  TEST_ASSERT_TRUE(mlog_count_after(3 * 20, &count));
+  TEST_ASSERT_EQUAL_UINT32(335, count);
+  TEST_ASSERT_TRUE(mlog_count_after(3 * 75, &count));
+  TEST_ASSERT_EQUAL_UINT32(306, count);
+  TEST_ASSERT_TRUE(mlog_count_after(3 * 300, &count));
+  TEST_ASSERT_EQUAL_UINT32(106, count);
+  TEST_ASSERT_TRUE(mlog_count_after(3 * 402, &count));
+  TEST_ASSERT_EQUAL_UINT32(4, count);
+  TEST_ASSERT_TRUE(mlog_count_after(3 * 406, &count));
+  TEST_ASSERT_EQUAL_UINT32(0, count);
+}
+
+// poskozeny posledni kontrolni bod - pouzije se predchozi a zaznamy se dohledaji
+void test_torn_checkpoint_uses_previous() {
+  Checkpoint checkpoint;
+  int32_t first;
+  uint32_t count;
+  uint32_t last = 0;
+
+  TEST_ASSERT_TRUE(mlog_init());
+  mlog_new_session();
+  appendRange(1, 5 * MLOG_RECORDS_PER_SECTOR + 10);
+  for (uint32_t slot = 0; slot < FLASH_SECTOR_SIZE / sizeof(Checkpoint); ++slot) {
+    uint32_t offset = checkpointSectors() * FLASH_SECTOR_SIZE + slot * sizeof(Checkpoint);
+    if (flash_read(offset, &checkpoint, sizeof(checkpoint)) && checkpoint.magic == MLOG_CHECKPOINT_MAGIC) {
+      last = offset;
+    }
+  }
+  clearBytes(last + offsetof(Checkpoint, crc), sizeof(uint32_t));
+
+  TEST_ASSERT_TRUE(mlog_init());
+  TEST_ASSERT_EQUAL_INT32(5 * MLOG_RECORDS_PER_SECTOR + 10, walkLog(&first, &count));
+  TEST_ASSERT_EQUAL_INT32(1, first);
+}
+
+// oddil bez kontrolnich bodu se obnovi z hlavicek sektoru
+void test_recovery_without_checkpoints() {
+  CGMeasurement measurement;
+  int32_t first;
+  uint32_t count;
+
+  TEST_ASSERT_TRUE(mlog_init());
+  mlog_new_session();
+  appendRange(1, 3 * MLOG_RECORDS_PER_SECTOR + 10);
+  for (uint32_t i = 0; i < MLOG_CHECKPOINT_SECTORS; ++i) {
+    TEST_ASSERT_TRUE(flash_erase_sector(checkpointSectors() + i));
+  }
+
+  TEST_ASSERT_TRUE(mlog_init());
+  TEST_ASSERT_EQUAL_INT32(3 * MLOG_RECORDS_PER_SECTOR + 10, walkLog(&first, &count));
+  TEST_ASSERT_EQUAL_INT32(1, first);
+  TEST_ASSERT_TRUE(mlog_last(&measurement));
+  TEST_ASSERT_EQUAL_INT32(3 * (3 * MLOG_RECORDS_PER_SECTOR + 10), measurement.timeOffset);
+}
+
+// pocet cteni flash pri pripojeni - z kontrolniho bodu nezavisi na delce logu
+void test_recovery_reads() {
+  TEST_ASSERT_TRUE(mlog_init());
+  mlog_new_session();
+  appendRange(1, 100 * MLOG_RECORDS_PER_SECTOR + MLOG_RECORDS_PER_SECTOR / 2);
+
+  TEST_ASSERT_TRUE(mlog_init());
+  uint32_t checkpointReads = mlog_recovery_reads();
+  for (uint32_t i = 0; i < MLOG_CHECKPOINT_SECTORS; ++i) {
+    TEST_ASSERT_TRUE(flash_erase_sector(checkpointSectors() + i));
+  }
+  TEST_ASSERT_TRUE(mlog_init());
+  uint32_t headerReads = mlog_recovery_reads();
+
+  printf("recovery reads: %u from checkpoint, %u from sector headers\n", checkpointReads, headerReads);
+  TEST_ASSERT_LESS_OR_EQUAL(40, checkpointReads);
+  TEST_ASSERT_GREATER_OR_EQUAL(checkpointSectors(), headerReads);
+}
+
+// vypadek napajeni v nahodnem miste zapisu - po pripojeni log konci poslednim
+// celym zaznamem a ztrati nejvyse stranku, ktera se prave zapisovala
+void test_power_cut_loses_at_most_one_page() {
+  int32_t next = 1;
+
+  srand(1);
+  TEST_ASSERT_TRUE(mlog_init());
+  mlog_new_session();
+  for (int round = 0; round < 50; ++round) {
+    int32_t appended = next - 1;
+    int32_t first;
+    uint32_t count;
+
+    flash_emulator_fail_after(rand() % 20000);
+    while (mlog_append(sample(next))) {
+      appended = next++;
+    }
+
+    flash_emulator_fail_after(-1);
+    TEST_ASSERT_TRUE(mlog_init());
+    int32_t last = walkLog(&first, &count);
+    TEST_ASSERT_EQUAL_INT32(1, first);
+    TEST_ASSERT_LESS_OR_EQUAL(appended, last);
+    TEST_ASSERT_LESS_OR_EQUAL((int32_t)MLOG_PAGE_RECORDS, appended - last);
+    TEST_ASSERT_EQUAL_UINT32(count, mlog_size());
+
+    uint32_t after;
+    int32_t n = rand() % (last + 1);
+    TEST_ASSERT_TRUE(mlog_count_after(3 * n, &after));
+    TEST_ASSERT_EQUAL_UINT32(last - n, after);
+    next = last + 1;
+  }
+}
+
+static int32_t evictedFirst = 0;
+static int32_t evictedLast = 0;
+
+static void countEvicted(CGMeasurement measurement) {
+  TEST_ASSERT_EQUAL_INT32(3 * measurement.glucoseValue, measurement.timeOffset);
+  if (evictedLast != 0) {
+    TEST_ASSERT_EQUAL_INT32(evictedLast + 1, measurement.glucoseValue);
+  }
+  else {
+    evictedFirst = measurement.glucoseValue;
+  }
+  evictedLast = measurement.glucoseValue;
+}
+
+// log pri zaplneni preda prepsana mereni obsluze od nejstarsiho, navazuji na zbytek logu
+void test_evicted_records_reported() {
+  int32_t first;
+  uint32_t count;
+  int32_t total = (checkpointSectors() + 3) * MLOG_RECORDS_PER_SECTOR;
+
+  evictedFirst = 0;
+  evictedLast = 0;
+  TEST_ASSERT_TRUE(mlog_init());
+  mlog_new_session();
+  mlog_on_evict(countEvicted);
+  appendRange(1, total);
+  mlog_on_evict(NULL);
+
+  TEST_ASSERT_EQUAL_INT32(total, walkLog(&first, &count));
+  TEST_ASSERT_EQUAL_INT32(1, evictedFirst);
+  TEST_ASSERT_EQUAL_INT32(first - 1, evictedLast);
+  TEST_ASSERT_EQUAL_UINT32(total, count + evictedLast);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_append_survives_remount);
+  RUN_TEST(test_failed_page_write_refuses_append);
+  RUN_TEST(test_append_rejects_time_going_back);
+  RUN_TEST(test_corrupted_record_ends_log);
+  RUN_TEST(test_counts_skip_torn_sector);
+  RUN_TEST(test_torn_checkpoint_uses_previous);
+  RUN_TEST(test_recovery_without_checkpoints);
+  RUN_TEST(test_recovery_reads);
+  RUN_TEST(test_power_cut_loses_at_most_one_page);
+  RUN_TEST(test_evicted_records_reported);
+  return UNITY_END();
+}
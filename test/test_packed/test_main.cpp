@@ -0,0 +1,131 @@
+#include <unity.h>
+
+#include "packed.h"
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+// hodnoty ruzne sirky prekracujici hranice slov - sousedni hodnoty zustanou
+void test_column_packing() {
+  PackedColumn<13, 40> narrow;
+  PackedColumn<20, 40> wide;
+  PackedColumn<32, 8> full;
+
+  for (uint32_t i = 0; i < 40; ++i) {
+    narrow.set(i, (i * 2654435761u) & narrow.mask);
+    wide.set(i, (i * 40503u + 7) & wide.mask);
+  }
+  for (uint32_t i = 0; i < 40; ++i) {
+    TEST_ASSERT_EQUAL_UINT32((i * 2654435761u) & narrow.mask, narrow.get(i));
+    TEST_ASSERT_EQUAL_UINT32((i * 40503u + 7) & wide.mask, wide.get(i));
+  }
+
+  // prepis jedne hodnoty a hodnota sirsi nez sloupec se orizne
+  narrow.set(5, 0xFFFFFFFF);
+  TEST_ASSERT_EQUAL_UINT32(narrow.mask, narrow.get(5));
+  TEST_ASSERT_EQUAL_UINT32((4 * 2654435761u) & narrow.mask, narrow.get(4));
+  TEST_ASSERT_EQUAL_UINT32((6 * 2654435761u) & narrow.mask, narrow.get(6));
+
+  full.set(3, 0xDEADBEEF);
+  full.set(7, 0x12345678);
+  TEST_ASSERT_EQUAL_HEX32(0xDEADBEEF, full.get(3));
+  TEST_ASSERT_EQUAL_HEX32(0x12345678, full.get(7));
+  TEST_ASSERT_EQUAL_HEX32(0, full.get(4));
+}
+
+// zaplneny buffer zahazuje nejstarsi mereni, hledani pracuje pres konec uloziste
+void test_series_wraparound() {
+  PackedSeries<8> series;
+
+  for (int32_t i = 0; i < 21; ++i) {
+    TEST_ASSERT_TRUE(series.push(CGMeasurement{100 + 10 * i, 500 + i}));
+  }
+  TEST_ASSERT_EQUAL_size_t(8, series.size());
+  for (size_t i = 0; i < 8; ++i) {
+    TEST_ASSERT_EQUAL_INT32(230 + 10 * (int32_t)i, series[i].timeOffset);
+    TEST_ASSERT_EQUAL_INT32(513 + (int32_t)i, series[i].glucoseValue);
+    TEST_ASSERT_EQUAL_INT32(series[i].timeOffset, series.timeAt(i));
+  }
+  TEST_ASSERT_EQUAL_INT32(230, series.first().timeOffset);
+  TEST_ASSERT_EQUAL_INT32(300, series.last().timeOffset);
+
+  TEST_ASSERT_EQUAL_size_t(0, series.upperBound(INT32_MIN));
+  TEST_ASSERT_EQUAL_size_t(0, series.upperBound(229));
+  TEST_ASSERT_EQUAL_size_t(1, series.upperBound(230));
+  TEST_ASSERT_EQUAL_size_t(4, series.upperBound(265));
+  TEST_ASSERT_EQUAL_size_t(8, series.upperBound(300));
+
+  series.dropFirst();
+  TEST_ASSERT_EQUAL_INT32(240, series.first().timeOffset);
+  series.clear();
+  TEST_ASSERT_TRUE(series.isEmpty());
+  TEST_ASSERT_EQUAL_size_t(0, series.upperBound(500));
+}
+
+// mereni mimo rozsah se odmitne samo, obsah bufferu zustane
+void test_out_of_range_rejected() {
+  PackedSeries<8, 8, 12> series;
+
+  TEST_ASSERT_TRUE(series.push(CGMeasurement{1000, 4095}));
+  TEST_ASSERT_TRUE(series.push(CGMeasurement{1010, 0}));
+  TEST_ASSERT_FALSE(series.push(CGMeasurement{1020, 4096}));
+  TEST_ASSERT_FALSE(series.push(CGMeasurement{1020, -1}));
+  TEST_ASSERT_FALSE(series.push(CGMeasurement{1005, 600}));
+  TEST_ASSERT_EQUAL_size_t(2, series.size());
+  TEST_ASSERT_EQUAL_INT32(4095, series.first().glucoseValue);
+  TEST_ASSERT_EQUAL_INT32(1010, series.last().timeOffset);
+
+  // stejny cas jako posledni mereni je platny
+  TEST_ASSERT_TRUE(series.push(CGMeasurement{1010, 601}));
+  TEST_ASSERT_EQUAL_size_t(3, series.size());
+}
+
+// casy se drzi relativne k nejstarsimu mereni, dlouha mezera zahodi jen mereni,
+// ktera se s novym casem do sloupce nevejdou
+void test_time_range() {
+  PackedSeries<8, 8, 12> series;
+
+  series.push(CGMeasurement{-100, 1});
+  series.push(CGMeasurement{0, 2});
+  series.push(CGMeasurement{100, 3});
+  TEST_ASSERT_TRUE(series.push(CGMeasurement{155, 4}));
+  TEST_ASSERT_EQUAL_size_t(4, series.size());
+  TEST_ASSERT_EQUAL_INT32(-100, series.first().timeOffset);
+
+  // 255 od -100 uz nestaci - zahodi se jen prvni mereni
+  TEST_ASSERT_TRUE(series.push(CGMeasurement{156, 5}));
+  TEST_ASSERT_EQUAL_size_t(4, series.size());
+  TEST_ASSERT_EQUAL_INT32(0, series.first().timeOffset);
+  TEST_ASSERT_EQUAL_INT32(156, series.last().timeOffset);
+  TEST_ASSERT_EQUAL_INT32(100, series[1].timeOffset);
+  TEST_ASSERT_EQUAL_size_t(2, series.upperBound(100));
+
+  // cas prave na hranici rozsahu
+  TEST_ASSERT_TRUE(series.push(CGMeasurement{255, 6}));
+  TEST_ASSERT_EQUAL_INT32(0, series.first().timeOffset);
+
+  // mezera delsi nez cely rozsah - zustane jen nove mereni
+  TEST_ASSERT_TRUE(series.push(CGMeasurement{100000, 7}));
+  TEST_ASSERT_EQUAL_size_t(1, series.size());
+  TEST_ASSERT_EQUAL_INT32(100000, series.first().timeOffset);
+  TEST_ASSERT_EQUAL_INT32(7, series.first().glucoseValue);
+
+  // krajni casy int32
+  series.clear();
+  TEST_ASSERT_TRUE(series.push(CGMeasurement{INT32_MIN, 1}));
+  TEST_ASSERT_TRUE(series.push(CGMeasurement{INT32_MAX, 2}));
+  TEST_ASSERT_EQUAL_size_t(1, series.size());
+  TEST_ASSERT_EQUAL_INT32(INT32_MAX, series.first().timeOffset);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_column_packing);
+  RUN_TEST(test_series_wraparound);
+  RUN_TEST(test_out_of_range_rejected);
+  RUN_TEST(test_time_range);
+  return UNITY_END();
+}
@@ -0,0 +1,104 @@
+#include <unity.h>
+
+#include "racp.h"
+
+static RacpRequest request;
+
+// pozadavek s jednim casem (operator <= nebo >=)
+static uint8_t parseOne(uint8_t opcode, uint8_t op, uint32_t time) {
+  uint8_t src[7] = {opcode, op, RACP_FILTER_TIME_OFFSET, (uint8_t)time, (uint8_t)(time >> 8), (uint8_t)(time >> 16), (uint8_t)(time >> 24)};
+  return racp_parse(src, sizeof(src), &request);
+}
+
+static uint8_t parseWithin(uint8_t opcode, uint32_t from, uint32_t to) {
+  uint8_t src[11] = {opcode, RACP_WITHIN, RACP_FILTER_TIME_OFFSET,
+    (uint8_t)from, (uint8_t)(from >> 8), (uint8_t)(from >> 16), (uint8_t)(from >> 24),
+    (uint8_t)to, (uint8_t)(to >> 8), (uint8_t)(to >> 16), (uint8_t)(to >> 24)};
+  return racp_parse(src, sizeof(src), &request);
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_operators_to_range() {
+  const uint8_t all[2] = {RACP_REPORT, RACP_ALL};
+
+  TEST_ASSERT_EQUAL_UINT8(RACP_SUCCESS, racp_parse(all, sizeof(all), &request));
+  TEST_ASSERT_EQUAL_UINT8(RACP_REPORT, request.opcode);
+  TEST_ASSERT_EQUAL_UINT8(RACP_ALL, request.op);
+  TEST_ASSERT_EQUAL_INT32(INT32_MIN, request.from);
+  TEST_ASSERT_EQUAL_INT32(INT32_MAX, request.to);
+
+  TEST_ASSERT_EQUAL_UINT8(RACP_SUCCESS, parseOne(RACP_DELETE, RACP_LESS_OR_EQUAL, 300));
+  TEST_ASSERT_EQUAL_INT32(INT32_MIN, request.from);
+  TEST_ASSERT_EQUAL_INT32(300, request.to);
+
+  TEST_ASSERT_EQUAL_UINT8(RACP_SUCCESS, parseOne(RACP_REPORT_COUNT, RACP_GREATER_OR_EQUAL, 0x01020304));
+  TEST_ASSERT_EQUAL_INT32(0x01020304, request.from);
+  TEST_ASSERT_EQUAL_INT32(INT32_MAX, request.to);
+
+  TEST_ASSERT_EQUAL_UINT8(RACP_SUCCESS, parseWithin(RACP_REPORT, 10, 20));
+  TEST_ASSERT_EQUAL_INT32(10, request.from);
+  TEST_ASSERT_EQUAL_INT32(20, request.to);
+
+  // cas nad rozsah int32 se omezi
+  TEST_ASSERT_EQUAL_UINT8(RACP_SUCCESS, parseOne(RACP_REPORT, RACP_GREATER_OR_EQUAL, 0xFFFFFFF0));
+  TEST_ASSERT_EQUAL_INT32(INT32_MAX, request.from);
+}
+
+void test_invalid_requests() {
+  const uint8_t empty[1] = {0};
+  const uint8_t opcodeOnly[1] = {RACP_REPORT};
+  const uint8_t unsupportedOnly[1] = {0x7F};
+  const uint8_t unsupported[2] = {0x7F, RACP_ALL};
+  const uint8_t abort[2] = {RACP_ABORT, RACP_NULL};
+  const uint8_t abortAll[2] = {RACP_ABORT, RACP_ALL};
+  const uint8_t nullOperator[2] = {RACP_REPORT, RACP_NULL};
+  const uint8_t unknownOperator[2] = {RACP_REPORT, 0x10};
+  const uint8_t allWithOperand[3] = {RACP_REPORT, RACP_ALL, RACP_FILTER_TIME_OFFSET};
+  const uint8_t missingFilter[2] = {RACP_REPORT, RACP_WITHIN};
+  const uint8_t otherFilter[7] = {RACP_REPORT, RACP_LESS_OR_EQUAL, 0x02, 0, 0, 0, 0};
+  const uint8_t shortOperand[5] = {RACP_REPORT, RACP_LESS_OR_EQUAL, RACP_FILTER_TIME_OFFSET, 0, 0};
+
+  // operacni kod se overuje pred delkou
+  TEST_ASSERT_EQUAL_UINT8(RACP_OPCODE_NOT_SUPPORTED, racp_parse(empty, 0, &request));
+  TEST_ASSERT_EQUAL_UINT8(RACP_OPCODE_NOT_SUPPORTED, racp_parse(unsupportedOnly, sizeof(unsupportedOnly), &request));
+  TEST_ASSERT_EQUAL_UINT8(0x7F, request.opcode);
+  TEST_ASSERT_EQUAL_UINT8(RACP_OPCODE_NOT_SUPPORTED, racp_parse(unsupported, sizeof(unsupported), &request));
+  TEST_ASSERT_EQUAL_UINT8(RACP_INVALID_OPERATOR, racp_parse(opcodeOnly, sizeof(opcodeOnly), &request));
+
+  TEST_ASSERT_EQUAL_UINT8(RACP_SUCCESS, racp_parse(abort, sizeof(abort), &request));
+  TEST_ASSERT_EQUAL_UINT8(RACP_INVALID_OPERATOR, racp_parse(abortAll, sizeof(abortAll), &request));
+  TEST_ASSERT_EQUAL_UINT8(RACP_INVALID_OPERATOR, racp_parse(nullOperator, sizeof(nullOperator), &request));
+  TEST_ASSERT_EQUAL_UINT8(RACP_OPERATOR_NOT_SUPPORTED, racp_parse(unknownOperator, sizeof(unknownOperator), &request));
+  TEST_ASSERT_EQUAL_UINT8(RACP_INVALID_OPERAND, racp_parse(allWithOperand, sizeof(allWithOperand), &request));
+  TEST_ASSERT_EQUAL_UINT8(RACP_INVALID_OPERAND, racp_parse(missingFilter, sizeof(missingFilter), &request));
+  TEST_ASSERT_EQUAL_UINT8(RACP_OPERAND_NOT_SUPPORTED, racp_parse(otherFilter, sizeof(otherFilter), &request));
+  TEST_ASSERT_EQUAL_UINT8(RACP_INVALID_OPERAND, racp_parse(shortOperand, sizeof(shortOperand), &request));
+  TEST_ASSERT_EQUAL_UINT8(RACP_INVALID_OPERAND, parseWithin(RACP_REPORT, 20, 10));
+}
+
+void test_responses() {
+  uint8_t dest[RACP_RESPONSE_SIZE];
+  const uint8_t response[RACP_RESPONSE_SIZE] = {RACP_RESPONSE, RACP_NULL, RACP_DELETE, RACP_NO_RECORDS};
+  const uint8_t count[RACP_COUNT_RESPONSE_SIZE] = {RACP_COUNT_RESPONSE, RACP_NULL, 0x34, 0x12};
+  const uint8_t saturated[RACP_COUNT_RESPONSE_SIZE] = {RACP_COUNT_RESPONSE, RACP_NULL, 0xFF, 0xFF};
+
+  TEST_ASSERT_EQUAL_size_t(RACP_RESPONSE_SIZE, racp_response(RACP_DELETE, RACP_NO_RECORDS, dest));
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(response, dest, RACP_RESPONSE_SIZE);
+  TEST_ASSERT_EQUAL_size_t(RACP_COUNT_RESPONSE_SIZE, racp_count_response(0x1234, dest));
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(count, dest, RACP_COUNT_RESPONSE_SIZE);
+  racp_count_response(100000, dest);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(saturated, dest, RACP_COUNT_RESPONSE_SIZE);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_operators_to_range);
+  RUN_TEST(test_invalid_requests);
+  RUN_TEST(test_responses);
+  return UNITY_END();
+}
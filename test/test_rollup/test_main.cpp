@@ -0,0 +1,86 @@
+#include <unity.h>
+
+#include "bytes.h"
+#include "rollup.h"
+
+#define INTERVAL 300
+#define WEEK (7 * 86400)
+
+// kazdy test zacina s vyprazdnenymi urovnemi naplnenymi tremi tydny mereni
+void setUp() {
+  rollup_clear();
+  for (int32_t time = 0; time < 3 * WEEK; time += INTERVAL) {
+    rollup_push(CGMeasurement{time, 500 + time / INTERVAL % 300});
+  }
+}
+
+void tearDown() {
+}
+
+/**
+ * @brief projde odpoved po strankach a overi, ze intervaly navazuji a kazdy prijde jednou
+ * 
+ * @param level uroven agregace
+ * @param len velikost stranky (MTU - 3)
+ * @param pages pocet stranek s intervaly
+ * @return pocet prijatych intervalu
+ */
+static uint32_t readPages(uint8_t level, size_t len, uint32_t *pages) {
+  static const int32_t widths[ROLLUP_LEVELS] = ROLLUP_WIDTHS;
+  uint8_t page[512];
+  int32_t from = INT32_MIN;
+  int32_t previous = INT32_MIN;
+  uint32_t received = 0;
+
+  *pages = 0;
+  while (true) {
+    size_t packed = rollup_pack(level, &from, page, len);
+    TEST_ASSERT_LESS_OR_EQUAL(len, packed);
+    TEST_ASSERT_EQUAL_UINT8(level, page[0]);
+    TEST_ASSERT_EQUAL_size_t(ROLLUP_HEADER_SIZE + page[1] * ROLLUP_PACKED_SIZE, packed);
+    if (page[1] == 0) {
+      return received;
+    }
+    for (uint8_t i = 0; i < page[1]; ++i) {
+      int32_t start = (int32_t)getLE(page + ROLLUP_HEADER_SIZE + i * ROLLUP_PACKED_SIZE, 4);
+      if (received > 0) {
+        TEST_ASSERT_EQUAL_INT32(previous + widths[level], start);
+      }
+      previous = start;
+      received++;
+    }
+    (*pages)++;
+  }
+}
+
+// tyden hodinovych intervalu se prenese po strankach podle MTU, zadny interval se neopakuje
+void test_week_in_pages() {
+  uint32_t pages;
+
+  TEST_ASSERT_EQUAL_UINT32(ROLLUP_CAPACITY_1_H, readPages(ROLLUP_1_H, 244, &pages));
+  TEST_ASSERT_EQUAL_UINT32((ROLLUP_CAPACITY_1_H + 19) / 20, pages);
+  TEST_ASSERT_EQUAL_UINT32(ROLLUP_CAPACITY_1_H, readPages(ROLLUP_1_H, 20, &pages));
+  TEST_ASSERT_EQUAL_UINT32(ROLLUP_CAPACITY_1_H, pages);
+  TEST_ASSERT_EQUAL_UINT32(ROLLUP_CAPACITY_15_MIN, readPages(ROLLUP_15_MIN, 509, &pages));
+  TEST_ASSERT_EQUAL_UINT32(ROLLUP_CAPACITY_1_DAY, readPages(ROLLUP_1_DAY, 509, &pages));
+  TEST_ASSERT_EQUAL_UINT32(1, pages);
+}
+
+// odpoved od zadaneho casu zacina intervalem, ktery tento cas obsahuje
+void test_page_from_time() {
+  uint8_t page[64];
+  int32_t from = 3 * WEEK - 3600 - 1;
+
+  TEST_ASSERT_EQUAL_size_t(ROLLUP_HEADER_SIZE + 2 * ROLLUP_PACKED_SIZE, rollup_pack(ROLLUP_1_H, &from, page, sizeof(page)));
+  TEST_ASSERT_EQUAL_INT32(3 * WEEK - 2 * 3600, (int32_t)getLE(page + ROLLUP_HEADER_SIZE, 4));
+  TEST_ASSERT_EQUAL_INT32(3 * WEEK, from);
+  TEST_ASSERT_EQUAL_size_t(ROLLUP_HEADER_SIZE, rollup_pack(ROLLUP_1_H, &from, page, sizeof(page)));
+  TEST_ASSERT_EQUAL_size_t(ROLLUP_HEADER_SIZE, rollup_pack(ROLLUP_LEVELS, &from, page, sizeof(page)));
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_week_in_pages);
+  RUN_TEST(test_page_from_time);
+  return UNITY_END();
+}
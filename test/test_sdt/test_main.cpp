@@ -0,0 +1,145 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unity.h>
+
+#include "sdt.h"
+
+#define DAY 86400
+
+/**
+ * @brief realisticky prubeh glykemie (mmol/l * 100) - denni kolisani, tri jidla
+ * denne s vzestupem a pomalym poklesem a sum senzoru
+ * 
+ * @param time cas v sekundach
+ * @param noise nejvetsi odchylka sumu
+ */
+static int32_t trace(int32_t time, int32_t noise) {
+  static const double meals[3] = { 7 * 3600.0, 12.5 * 3600.0, 19 * 3600.0 };
+  double timeOfDay = fmod((double)time, (double)DAY);
+  double value = 550 + 60 * sin(2 * M_PI * time / DAY);
+
+  for (int i = 0; i < 3; ++i) {
+    double since = timeOfDay - meals[i];
+    if (since > 0) {
+      value += 350 * (since / 2700) * exp(1 - since / 2700);
+    }
+  }
+  return (int32_t)lround(value) + ((noise > 0) ? rand() % (2 * noise + 1) - noise : 0);
+}
+
+void setUp() {
+  srand(1);
+  sdt_clear();
+  sdt_set_deviation(SDT_DEFAULT_DEVIATION);
+}
+
+void tearDown() {
+}
+
+/**
+ * @brief prubeh se zadanym intervalem a odchylkou - rekonstrukce je v kazdem mereni
+ * nejvyse o odchylku vedle a v uchovanych bodech presna
+ * 
+ * @return nejvetsi chyba rekonstrukce
+ */
+static int32_t checkTrace(int32_t interval, int32_t noise, int32_t deviation, uint32_t *kept) {
+  static CGMeasurement samples[2 * DAY];
+  uint32_t count = 0;
+  uint32_t received = sdt_received();
+  uint32_t before = sdt_kept();
+  int32_t maxError = 0;
+
+  sdt_clear();
+  sdt_set_deviation(deviation);
+  for (int32_t time = 0; time < 2 * DAY; time += interval) {
+    samples[count] = CGMeasurement{time, trace(time, noise)};
+    sdt_push(samples[count++]);
+  }
+  TEST_ASSERT_EQUAL_UINT32(count, sdt_received() - received);
+
+  for (uint32_t i = 0; i < count; ++i) {
+    int32_t value;
+    TEST_ASSERT_TRUE(sdt_value_at(samples[i].timeOffset, &value));
+    int32_t error = abs(value - samples[i].glucoseValue);
+    maxError = (error > maxError) ? error : maxError;
+  }
+
+  // body lomene cary jsou skutecna mereni a rekonstrukce v nich je presna
+  CGMeasurement point;
+  for (int32_t time = INT32_MIN; sdt_find_after(time, &point); time = point.timeOffset) {
+    int32_t value;
+    TEST_ASSERT_EQUAL_INT32(0, point.timeOffset % interval);
+    TEST_ASSERT_EQUAL_INT32(samples[point.timeOffset / interval].glucoseValue, point.glucoseValue);
+    TEST_ASSERT_TRUE(sdt_value_at(point.timeOffset, &value));
+    TEST_ASSERT_EQUAL_INT32(point.glucoseValue, value);
+  }
+  *kept = sdt_kept() - before;
+  printf("interval %d s, noise %d, deviation %d: %u of %u kept (%.2f %%), max error %d\n",
+    interval, noise, deviation, *kept, count, 100.0 * *kept / count, maxError);
+  TEST_ASSERT_LESS_OR_EQUAL(deviation, maxError);
+  return maxError;
+}
+
+// chyba je omezena odchylkou a pocet bodu za den nezavisi na intervalu mereni
+void test_error_bounded_on_trace() {
+  static const int32_t intervals[3] = { 1, 10, 300 };
+  uint32_t kept;
+
+  for (int i = 0; i < 3; ++i) {
+    checkTrace(intervals[i], 2, SDT_DEFAULT_DEVIATION, &kept);
+    TEST_ASSERT_LESS_OR_EQUAL(2 * 68, kept);
+  }
+  checkTrace(10, 2, 6, &kept);
+  checkTrace(10, 2, 17, &kept);
+}
+
+// kruh pokryje celou retenci, starsi body se zahodi
+void test_retention() {
+  int32_t value;
+  int32_t last = 0;
+
+  for (int32_t time = 0; time < SDT_RETENTION; time += 60) {
+    sdt_push(CGMeasurement{time, trace(time, 2)});
+    last = time;
+  }
+  TEST_ASSERT_TRUE(sdt_value_at(0, &value));
+  printf("%d days: %u points kept\n", SDT_RETENTION_DAYS, sdt_kept());
+
+  for (int32_t time = last + 60; time < SDT_RETENTION + 10 * DAY; time += 60) {
+    sdt_push(CGMeasurement{time, trace(time, 2)});
+    last = time;
+  }
+  TEST_ASSERT_FALSE(sdt_value_at(last - SDT_RETENTION - 3600, &value));
+  TEST_ASSERT_TRUE(sdt_value_at(last - SDT_RETENTION + 3600, &value));
+  TEST_ASSERT_TRUE(sdt_value_at(last, &value));
+}
+
+// zmena odchylky plati od posledniho mereni, vymazani historii vyprazdni
+void test_deviation_and_clear() {
+  CGMeasurement point;
+  int32_t value;
+
+  for (int32_t time = 0; time <= 1000; time += 10) {
+    sdt_push(CGMeasurement{time, 500 + time});
+  }
+  // primka se uchova dvema body
+  TEST_ASSERT_TRUE(sdt_find_after(0, &point));
+  TEST_ASSERT_EQUAL_INT32(1000, point.timeOffset);
+  sdt_set_deviation(-5);
+  TEST_ASSERT_EQUAL_INT32(0, sdt_deviation());
+  TEST_ASSERT_TRUE(sdt_value_at(505, &value));
+  TEST_ASSERT_EQUAL_INT32(1005, value);
+
+  sdt_clear();
+  TEST_ASSERT_FALSE(sdt_value_at(505, &value));
+  TEST_ASSERT_FALSE(sdt_find_after(INT32_MIN, &point));
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_error_bounded_on_trace);
+  RUN_TEST(test_retention);
+  RUN_TEST(test_deviation_and_clear);
+  return UNITY_END();
+}
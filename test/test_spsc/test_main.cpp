@@ -0,0 +1,171 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <thread>
+#include <unity.h>
+
+#include "spsc.h"
+
+// prvek nese poradove cislo i jeho kontrolni kopii - roztrzene cteni se pozna
+struct Item {
+  uint32_t seq;
+  uint32_t check;
+};
+
+#define STRESS_ITEMS 2000000
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_push_pop_order_and_capacity() {
+  SpscRing<uint32_t, 4> ring{};
+  uint32_t value;
+
+  TEST_ASSERT_FALSE(ring.pop(&value));
+  for (uint32_t i = 0; i < 4; ++i) {
+    TEST_ASSERT_TRUE(ring.push(i));
+  }
+  TEST_ASSERT_FALSE(ring.push(4));
+  TEST_ASSERT_EQUAL_UINT32(4, ring.size());
+  for (uint32_t i = 0; i < 4; ++i) {
+    TEST_ASSERT_TRUE(ring.pop(&value));
+    TEST_ASSERT_EQUAL_UINT32(i, value);
+  }
+  TEST_ASSERT_FALSE(ring.pop(&value));
+}
+
+// producent a konzument v samostatnych vlaknech - zadny prvek se neztrati,
+// nezdvoji ani neprecte roztrzeny a poradi se zachova
+void test_threads_keep_order() {
+  static SpscRing<Item, 16> ring;
+  uint32_t received = 0;
+  uint32_t torn = 0;
+  uint32_t outOfOrder = 0;
+
+  std::thread producer([]() {
+    for (uint32_t seq = 0; seq < STRESS_ITEMS; ++seq) {
+      Item item = {seq, ~seq};
+      while (!ring.push(item)) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  while (received < STRESS_ITEMS) {
+    Item item;
+    if (!ring.pop(&item)) {
+      std::this_thread::yield();
+      continue;
+    }
+    if (item.check != ~item.seq) {
+      torn++;
+    }
+    if (item.seq != received) {
+      outOfOrder++;
+    }
+    received++;
+  }
+  producer.join();
+
+  TEST_ASSERT_EQUAL_UINT32(0, torn);
+  TEST_ASSERT_EQUAL_UINT32(0, outOfOrder);
+  TEST_ASSERT_EQUAL_UINT32(0, ring.size());
+}
+
+void test_snapshot_keeps_queue() {
+  SpscRing<uint32_t, 8> ring{};
+  uint32_t copy[8];
+  uint32_t value;
+
+  TEST_ASSERT_EQUAL_size_t(0, ring.snapshot(copy, 8));
+  for (uint32_t i = 0; i < 6; ++i) {
+    ring.push(i);
+  }
+  ring.pop(&value);
+  TEST_ASSERT_EQUAL_size_t(5, ring.snapshot(copy, 8));
+  for (uint32_t i = 0; i < 5; ++i) {
+    TEST_ASSERT_EQUAL_UINT32(i + 1, copy[i]);
+  }
+  // omezena kopie vezme nejnovejsi prvky
+  TEST_ASSERT_EQUAL_size_t(2, ring.snapshot(copy, 2));
+  TEST_ASSERT_EQUAL_UINT32(4, copy[0]);
+  TEST_ASSERT_EQUAL_UINT32(5, copy[1]);
+  TEST_ASSERT_EQUAL_UINT32(5, ring.size());
+}
+
+// treti vlakno snima frontu, do ktere producent zapisuje a ze ktere konzument cte -
+// kazdy snimek je souvisla rada neroztrzenych prvku a jeho konec se neposouva zpet
+void test_concurrent_snapshots() {
+  static SpscRing<Item, 16> ring;
+  std::atomic<bool> done(false);
+  uint32_t snapshots = 0;
+  uint32_t nonEmpty = 0;
+  uint32_t torn = 0;
+  uint32_t gaps = 0;
+  uint32_t regressions = 0;
+
+  std::thread producer([]() {
+    for (uint32_t seq = 0; seq < STRESS_ITEMS; ++seq) {
+      Item item = {seq, ~seq};
+      while (!ring.push(item)) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  std::thread consumer([&done]() {
+    uint32_t received = 0;
+    while (received < STRESS_ITEMS) {
+      Item item;
+      // konzument ustupuje po kazdem prvku, aby ve fronte neco zustalo i na jednom jadre
+      if (ring.pop(&item)) {
+        received++;
+      }
+      std::this_thread::yield();
+    }
+    done = true;
+  });
+
+  uint32_t newest = 0;
+  while (!done) {
+    Item copy[16];
+    size_t count = ring.snapshot(copy, (snapshots % 2 == 0) ? 16 : 5);
+    snapshots++;
+    std::this_thread::yield();
+    if (count == 0) {
+      continue;
+    }
+    nonEmpty++;
+    for (size_t i = 0; i < count; ++i) {
+      if (copy[i].check != ~copy[i].seq) {
+        torn++;
+      }
+      if (i > 0 && copy[i].seq != copy[i - 1].seq + 1) {
+        gaps++;
+      }
+    }
+    if (copy[count - 1].seq < newest) {
+      regressions++;
+    }
+    newest = copy[count - 1].seq;
+  }
+  producer.join();
+  consumer.join();
+
+  printf("%u snapshots, %u non-empty\n", snapshots, nonEmpty);
+  TEST_ASSERT_GREATER_THAN(0, nonEmpty);
+  TEST_ASSERT_EQUAL_UINT32(0, torn);
+  TEST_ASSERT_EQUAL_UINT32(0, gaps);
+  TEST_ASSERT_EQUAL_UINT32(0, regressions);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_push_pop_order_and_capacity);
+  RUN_TEST(test_threads_keep_order);
+  RUN_TEST(test_snapshot_keeps_queue);
+  RUN_TEST(test_concurrent_snapshots);
+  return UNITY_END();
+}
@@ -0,0 +1,131 @@
+#include <stdlib.h>
+#include <unity.h>
+
+#include "stats.h"
+#include "status.h"
+
+// vice mereni, nez pojme strom - nejstarsi listy se prepisuji
+#define SAMPLES (STATS_LEAVES * STATS_LEAF_SAMPLES + 1000)
+#define INTERVAL 300
+
+static CGMeasurement samples[SAMPLES];
+
+// zdroj mereni pro okrajove listy - prvni mereni novejsi nez time
+static bool findAfter(int32_t time, CGMeasurement *measurement) {
+  for (uint32_t i = 0; i < SAMPLES; ++i) {
+    if (samples[i].timeOffset > time) {
+      *measurement = samples[i];
+      return true;
+    }
+  }
+  return false;
+}
+
+// prvni mereni, ktere statistiky jeste pokryvaji
+static uint32_t firstCovered() {
+  uint32_t leaves = (SAMPLES + STATS_LEAF_SAMPLES - 1) / STATS_LEAF_SAMPLES;
+  return (leaves > STATS_LEAVES) ? (leaves - STATS_LEAVES) * STATS_LEAF_SAMPLES : 0;
+}
+
+static WindowStats bruteForce(int32_t from, int32_t to) {
+  WindowStats stats = {0, 0, 0, INT32_MAX, INT32_MIN};
+  for (uint32_t i = firstCovered(); i < SAMPLES; ++i) {
+    int32_t value = samples[i].glucoseValue;
+    if (samples[i].timeOffset < from || samples[i].timeOffset > to) {
+      continue;
+    }
+    stats.count++;
+    stats.sum += value;
+    stats.inRange += value >= STATS_RANGE_LOW && value <= STATS_RANGE_HIGH;
+    stats.min = (value < stats.min) ? value : stats.min;
+    stats.max = (value > stats.max) ? value : stats.max;
+  }
+  return stats;
+}
+
+void setUp() {
+  srand(7);
+  int32_t value = 700;
+  for (uint32_t i = 0; i < SAMPLES; ++i) {
+    value += rand() % 41 - 20;
+    value = (value < 200) ? 200 : (value > 2200) ? 2200 : value;
+    samples[i] = CGMeasurement{(int32_t)i * INTERVAL, value};
+  }
+  stats_init(findAfter);
+  for (uint32_t i = 0; i < SAMPLES; ++i) {
+    stats_push(samples[i]);
+  }
+}
+
+void tearDown() {
+}
+
+// nahodna okna vcetne okraju uvnitr listu a oken mimo pokryte obdobi
+void test_query_matches_brute_force() {
+  for (int i = 0; i < 2000; ++i) {
+    int32_t from = rand() % (SAMPLES * INTERVAL);
+    int32_t to = from + rand() % (3 * STATS_LEAF_SAMPLES * INTERVAL * (1 + i % 50));
+    WindowStats expected = bruteForce(from, to);
+    WindowStats actual;
+
+    TEST_ASSERT_EQUAL(expected.count > 0, stats_query(from, to, &actual));
+    TEST_ASSERT_EQUAL_UINT32(expected.count, actual.count);
+    if (expected.count > 0) {
+      TEST_ASSERT_EQUAL_UINT32(expected.inRange, actual.inRange);
+      TEST_ASSERT_EQUAL(expected.sum, actual.sum);
+      TEST_ASSERT_EQUAL_INT32(expected.min, actual.min);
+      TEST_ASSERT_EQUAL_INT32(expected.max, actual.max);
+    }
+  }
+}
+
+void test_empty_window() {
+  WindowStats stats;
+  TEST_ASSERT_FALSE(stats_query(10, 9, &stats));
+  TEST_ASSERT_FALSE(stats_query(SAMPLES * INTERVAL, SAMPLES * INTERVAL + 1000, &stats));
+  TEST_ASSERT_EQUAL_UINT32(0, stats.count);
+}
+
+// souhrn poslednich 24 hodin
+void test_status_day_summary() {
+  int32_t last = samples[SAMPLES - 1].timeOffset;
+  WindowStats expected = bruteForce(last - STATUS_STATS_WINDOW + 1, last);
+  WindowStats window;
+  DayStats day;
+  uint8_t packed[STATUS_STATS_SIZE];
+
+  TEST_ASSERT_TRUE(stats_query(last - STATUS_STATS_WINDOW + 1, last, &window));
+  TEST_ASSERT_EQUAL_UINT32(STATUS_STATS_WINDOW / INTERVAL, window.count);
+  status_set_stats(&day, &window);
+  TEST_ASSERT_EQUAL_UINT16(expected.sum / expected.count, day.mean);
+  TEST_ASSERT_EQUAL_UINT16(expected.min, day.min);
+  TEST_ASSERT_EQUAL_UINT16(expected.max, day.max);
+  TEST_ASSERT_EQUAL_UINT16(expected.inRange * 1000 / expected.count, day.inRange);
+
+  TEST_ASSERT_EQUAL_size_t(STATUS_STATS_SIZE, status_pack_stats(&day, packed));
+  TEST_ASSERT_EQUAL_UINT16(day.mean, packed[0] | (packed[1] << 8));
+  TEST_ASSERT_EQUAL_UINT16(day.inRange, packed[6] | (packed[7] << 8));
+}
+
+// stavovy snimek se vejde do jednoho cteni pri vychozim MTU 23
+void test_status_single_read() {
+  SensorStatus status = {4, 4, 10, 0xA1B2C3D4, 1000, 600, 1, 900};
+  uint8_t packed[STATUS_SIZE];
+
+  TEST_ASSERT_LESS_OR_EQUAL(23 - 3, STATUS_SIZE);
+  TEST_ASSERT_EQUAL_size_t(STATUS_SIZE, status_pack(&status, packed));
+  TEST_ASSERT_EQUAL_HEX8(0x44, packed[0]);
+  TEST_ASSERT_EQUAL_UINT8(10, packed[1]);
+  TEST_ASSERT_EQUAL_HEX8(0xD4, packed[2]);
+  TEST_ASSERT_EQUAL_UINT16(600, packed[10] | (packed[11] << 8));
+  TEST_ASSERT_EQUAL_UINT32(900, packed[16] | (packed[17] << 8) | (packed[18] << 16) | ((uint32_t)packed[19] << 24));
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_query_matches_brute_force);
+  RUN_TEST(test_empty_window);
+  RUN_TEST(test_status_day_summary);
+  RUN_TEST(test_status_single_read);
+  return UNITY_END();
+}